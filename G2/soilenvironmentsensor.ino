@@ -2,6 +2,7 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <DHT.h>
+#include <Preferences.h>
 
 // --- Macro Definitions ---
 #define DHT_PIN       4
@@ -17,6 +18,116 @@ const char* API_URL = "https://test-server-owq2.onrender.com/api/v1/plants/plant
 
 // --- Global Objects ---
 DHT dhtSensor(DHT_PIN, DHT_TYPE);
+Preferences prefs;
+
+// --- Cached Thresholds ---
+struct Thresholds {
+  float tempMin;
+  float tempMax;
+  float soilMin;
+  float soilMax;
+  float lightMin;
+  float lightMax;
+};
+
+Thresholds thresholds;
+bool haveThresholds = false;
+String thresholdsEtag = "";
+
+/**
+ * @brief Loads the last thresholds and their ETag from NVS.
+ */
+void loadThresholds()
+{
+  prefs.begin("thresholds", true);
+  haveThresholds = prefs.getBytes("plant", &thresholds, sizeof(thresholds)) == sizeof(thresholds);
+  thresholdsEtag = haveThresholds ? prefs.getString("etag", "") : "";
+  prefs.end();
+}
+
+/**
+ * @brief Stores the thresholds in NVS with the ETag they were served with.
+ */
+void saveThresholds()
+{
+  prefs.begin("thresholds", false);
+  prefs.putBytes("plant", &thresholds, sizeof(thresholds));
+  prefs.putString("etag", thresholdsEtag);
+  prefs.end();
+}
+
+/**
+ * @brief True if both bounds of the range are numbers and min is below max.
+ */
+bool validRange(JsonVariantConst range) {
+  return range["min"].is<float>() && range["max"].is<float>() &&
+         range["min"].as<float>() < range["max"].as<float>();
+}
+
+/**
+ * @brief Conditional GET of the plant thresholds.
+ *
+ * The cached ETag is sent as If-None-Match, so an unchanged plant costs a
+ * 304 and no parsing. On any failure the cached thresholds stay in use.
+ */
+void fetchThresholds()
+{
+  HTTPClient httpClient;
+  httpClient.begin(API_URL);
+
+  const char* headerKeys[] = {"ETag"};
+  httpClient.collectHeaders(headerKeys, 1);
+  if (haveThresholds && thresholdsEtag.length() > 0) {
+    httpClient.addHeader("If-None-Match", thresholdsEtag);
+  }
+
+  // HTTP/1.0 so the body arrives unchunked and can be parsed from the stream
+  httpClient.useHTTP10(true);
+  int httpResponseCode = httpClient.GET();
+
+  if (httpResponseCode == HTTP_CODE_NOT_MODIFIED) {
+    Serial.println("\nThresholds unchanged (304)");
+  } else if (httpResponseCode == HTTP_CODE_OK) {
+    // Only the thresholds are kept from the plant document
+    StaticJsonDocument<128> filter;
+    filter["thresholds"] = true;
+
+    StaticJsonDocument<512> jsonDoc;
+    DeserializationError jsonError = deserializeJson(jsonDoc, httpClient.getStream(), DeserializationOption::Filter(filter));
+
+    JsonVariantConst ranges = jsonDoc["thresholds"];
+    if (!jsonError && !(validRange(ranges["temperature"]) && validRange(ranges["moisture"]) && validRange(ranges["light"]))) {
+      // Missing fields would read as 0 and be cached as if they were real
+      Serial.println("\nIncomplete thresholds in response, keeping current ones");
+    } else if (!jsonError) {
+      // --- Extract thresholds from JSON ---
+      Thresholds fresh;
+      fresh.tempMin  = jsonDoc["thresholds"]["temperature"]["min"];
+      fresh.tempMax  = jsonDoc["thresholds"]["temperature"]["max"];
+      fresh.soilMin  = jsonDoc["thresholds"]["moisture"]["min"];
+      fresh.soilMax  = jsonDoc["thresholds"]["moisture"]["max"];
+      fresh.lightMin = jsonDoc["thresholds"]["light"]["min"];
+      fresh.lightMax = jsonDoc["thresholds"]["light"]["max"];
+
+      // NVS is only rewritten when something actually changed
+      String etag = httpClient.header("ETag");
+      if (!haveThresholds || memcmp(&fresh, &thresholds, sizeof(fresh)) != 0 || etag != thresholdsEtag) {
+        thresholds = fresh;
+        thresholdsEtag = etag;
+        haveThresholds = true;
+        saveThresholds();
+      }
+    } else {
+      Serial.print("JSON Parsing error: ");
+      Serial.println(jsonError.c_str());
+    }
+  } else {
+    Serial.print("HTTP Error: ");
+    Serial.println(httpResponseCode);
+  }
+
+  httpClient.end();
+}
 
 /**
  * @brief Setup function for initializing Serial, DHT, and WiFi.
@@ -25,6 +136,7 @@ void setup()
 {
   Serial.begin(9600);
   dhtSensor.begin();
+  loadThresholds();
 
   Serial.print("Connecting to WiFi");
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
@@ -40,85 +152,64 @@ void setup()
 }
 
 /**
- * @brief Main loop for fetching thresholds and reading sensor data.
+ * @brief Main loop for refreshing thresholds and reading sensor data.
  */
 void loop()
 {
   if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient httpClient;
-    httpClient.begin(API_URL);
-    int httpResponseCode = httpClient.GET();
-
-    if (httpResponseCode > 0) {
-      String payload = httpClient.getString();
-      Serial.println("\nReceived API response:");
-      Serial.println(payload);
-
-      StaticJsonDocument<2048> jsonDoc;
-      DeserializationError jsonError = deserializeJson(jsonDoc, payload);
-
-      if (!jsonError) {
-        // --- Extract thresholds from JSON ---
-        float tempMin  = jsonDoc["thresholds"]["temperature"]["min"];
-        float tempMax  = jsonDoc["thresholds"]["temperature"]["max"];
-        float soilMin  = jsonDoc["thresholds"]["moisture"]["min"];
-        float soilMax  = jsonDoc["thresholds"]["moisture"]["max"];
-        float lightMin = jsonDoc["thresholds"]["light"]["min"];
-        float lightMax = jsonDoc["thresholds"]["light"]["max"];
-
-        Serial.println("\n---- Thresholds from API ----");
-        Serial.printf("  Temperature: %.1f°C to %.1f°C\n", tempMin, tempMax);
-        Serial.printf("Soil Moisture: %.1f%% to %.1f%%\n", soilMin, soilMax);
-        Serial.printf(" Light Level: %.1f%% to %.1f%% (not measured)\n", lightMin, lightMax);
-        Serial.println("--------------------------------");
-
-        // --- Read sensor data ---
-        float temperature = dhtSensor.readTemperature();
-        float humidity    = dhtSensor.readHumidity();
-        int rawSoil       = analogRead(SOIL_PIN);  // Range: 0–4095 (ESP32 ADC)
-        float soilPercent = map(rawSoil, 0, 4095, 100, 0);  // Adjust based on calibration
-
-        Serial.println("\n---- Sensor Readings ----");
-        Serial.printf(" Temperature: %.1f°C\n", temperature);
-        Serial.printf("    Humidity: %.1f%%\n", humidity);
-        Serial.printf("Soil Moisture: %.1f%% (raw: %d)\n", soilPercent, rawSoil);
-        Serial.println("-----------------------------");
-
-        // --- Compare sensor readings with thresholds ---
-        Serial.println("\n---- Comparison ----");
-
-        if (temperature < tempMin) {
-          Serial.println("Temperature is too LOW!");
-        } else if (temperature > tempMax) {
-          Serial.println("Temperature is too HIGH!");
-        } else {
-          Serial.println("Temperature is OK.");
-        }
-
-        if (soilPercent < soilMin) {
-          Serial.println("Soil moisture is too LOW!");
-        } else if (soilPercent > soilMax) {
-          Serial.println("Soil moisture is too HIGH!");
-        } else {
-          Serial.println("Soil moisture is OK.");
-        }
-
-        Serial.println("-----------------------------\n");
-
-      } else {
-        Serial.print("JSON Parsing error: ");
-        Serial.println(jsonError.c_str());
-      }
+    fetchThresholds();
+  } else {
+    Serial.println("WiFi Disconnected!");
+  }
 
+  if (haveThresholds) {
+    float tempMin  = thresholds.tempMin;
+    float tempMax  = thresholds.tempMax;
+    float soilMin  = thresholds.soilMin;
+    float soilMax  = thresholds.soilMax;
+    float lightMin = thresholds.lightMin;
+    float lightMax = thresholds.lightMax;
+
+    Serial.println("\n---- Thresholds from API ----");
+    Serial.printf("  Temperature: %.1f°C to %.1f°C\n", tempMin, tempMax);
+    Serial.printf("Soil Moisture: %.1f%% to %.1f%%\n", soilMin, soilMax);
+    Serial.printf(" Light Level: %.1f%% to %.1f%% (not measured)\n", lightMin, lightMax);
+    Serial.println("--------------------------------");
+
+    // --- Read sensor data ---
+    float temperature = dhtSensor.readTemperature();
+    float humidity    = dhtSensor.readHumidity();
+    int rawSoil       = analogRead(SOIL_PIN);  // Range: 0–4095 (ESP32 ADC)
+    float soilPercent = map(rawSoil, 0, 4095, 100, 0);  // Adjust based on calibration
+
+    Serial.println("\n---- Sensor Readings ----");
+    Serial.printf(" Temperature: %.1f°C\n", temperature);
+    Serial.printf("    Humidity: %.1f%%\n", humidity);
+    Serial.printf("Soil Moisture: %.1f%% (raw: %d)\n", soilPercent, rawSoil);
+    Serial.println("-----------------------------");
+
+    // --- Compare sensor readings with thresholds ---
+    Serial.println("\n---- Comparison ----");
+
+    if (temperature < tempMin) {
+      Serial.println("Temperature is too LOW!");
+    } else if (temperature > tempMax) {
+      Serial.println("Temperature is too HIGH!");
     } else {
-      Serial.print("HTTP Error: ");
-      Serial.println(httpResponseCode);
+      Serial.println("Temperature is OK.");
     }
 
-    httpClient.end();
+    if (soilPercent < soilMin) {
+      Serial.println("Soil moisture is too LOW!");
+    } else if (soilPercent > soilMax) {
+      Serial.println("Soil moisture is too HIGH!");
+    } else {
+      Serial.println("Soil moisture is OK.");
+    }
 
+    Serial.println("-----------------------------\n");
   } else {
-    Serial.println("WiFi Disconnected!");
+    Serial.println("No thresholds available yet.");
   }
 
   delay(3600000);  // Wait 1 hour before next iteration
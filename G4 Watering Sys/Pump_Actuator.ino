@@ -2,6 +2,7 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <DHT.h>
+#include <Preferences.h>
 
 // --- Pin Definitions ---
 #define DHT_PIN      4
@@ -18,6 +19,96 @@ const char* API_URL = "https://test-server-owq2.onrender.com/api/v1/plants/plant
 
 // --- Global Objects ---
 DHT dht(DHT_PIN, DHT_TYPE);
+Preferences prefs;
+
+// --- Cached Thresholds ---
+// Last thresholds received, kept in NVS with the ETag they were served with.
+// The ETag goes back as If-None-Match, so an unchanged plant costs a 304.
+struct Thresholds {
+  float soilMin;
+  float soilMax;
+};
+
+Thresholds thresholds;
+bool haveThresholds = false;
+String thresholdsEtag = "";
+
+void loadThresholds() {
+  prefs.begin("thresholds", true);
+  haveThresholds = prefs.getBytes("soil", &thresholds, sizeof(thresholds)) == sizeof(thresholds);
+  thresholdsEtag = haveThresholds ? prefs.getString("etag", "") : "";
+  prefs.end();
+
+  if (haveThresholds) {
+    Serial.printf("Cached thresholds: soil %.1f%% to %.1f%%\n", thresholds.soilMin, thresholds.soilMax);
+  }
+}
+
+void saveThresholds() {
+  prefs.begin("thresholds", false);
+  prefs.putBytes("soil", &thresholds, sizeof(thresholds));
+  prefs.putString("etag", thresholdsEtag);
+  prefs.end();
+}
+
+// A range is usable only if both bounds are numbers and min is below max
+bool validRange(JsonVariantConst range) {
+  return range["min"].is<float>() && range["max"].is<float>() &&
+         range["min"].as<float>() < range["max"].as<float>();
+}
+
+// Refreshes thresholds from the API; keeps the cached ones if that fails
+void fetchThresholds() {
+  HTTPClient http;
+  http.begin(API_URL);
+
+  const char* headerKeys[] = {"ETag"};
+  http.collectHeaders(headerKeys, 1);
+  if (haveThresholds && thresholdsEtag.length() > 0) {
+    http.addHeader("If-None-Match", thresholdsEtag);
+  }
+
+  // HTTP/1.0 so the body arrives unchunked and can be parsed from the stream
+  http.useHTTP10(true);
+  int httpResponseCode = http.GET();
+
+  if (httpResponseCode == HTTP_CODE_NOT_MODIFIED) {
+    Serial.println("\nThresholds unchanged");
+  } else if (httpResponseCode == HTTP_CODE_OK) {
+    // Only the thresholds are kept from the plant document
+    StaticJsonDocument<128> filter;
+    filter["thresholds"]["moisture"] = true;
+
+    StaticJsonDocument<256> doc;
+    DeserializationError error = deserializeJson(doc, http.getStream(), DeserializationOption::Filter(filter));
+
+    if (!error && !validRange(doc["thresholds"]["moisture"])) {
+      // A partial document would be cached as {0, 0} and stop the pump for good
+      Serial.println("\nNo valid moisture range in response, keeping current thresholds");
+    } else if (!error) {
+      Thresholds fresh;
+      fresh.soilMin = doc["thresholds"]["moisture"]["min"];
+      fresh.soilMax = doc["thresholds"]["moisture"]["max"];
+
+      String etag = http.header("ETag");
+      if (!haveThresholds || memcmp(&fresh, &thresholds, sizeof(fresh)) != 0 || etag != thresholdsEtag) {
+        thresholds = fresh;
+        thresholdsEtag = etag;
+        haveThresholds = true;
+        saveThresholds();
+      }
+      Serial.printf("\nThresholds: soil %.1f%% to %.1f%%\n", thresholds.soilMin, thresholds.soilMax);
+    } else {
+      Serial.print("JSON Parsing error: ");
+      Serial.println(error.c_str());
+    }
+  } else {
+    Serial.print("HTTP Error: ");
+    Serial.println(httpResponseCode);
+  }
+
+  http.end();
+}
 
 void setup() {
   Serial.begin(9600);
@@ -26,6 +117,8 @@ void setup() {
   pinMode(PUMP_PIN, OUTPUT);
   digitalWrite(PUMP_PIN, LOW); // Start with pump OFF
 
+  loadThresholds();
+
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
   Serial.print("Connecting to WiFi");
 
@@ -41,56 +134,37 @@ void setup() {
 
 void loop() {
   if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient http;
-    http.begin(API_URL);
-    int httpResponseCode = http.GET();
-
-    if (httpResponseCode > 0) {
-      String payload = http.getString();
-      Serial.println("\nReceived API response:");
-      Serial.println(payload);
-
-      StaticJsonDocument<2048> doc;
-      DeserializationError error = deserializeJson(doc, payload);
-
-      if (!error) {
-        // --- Extract Thresholds ---
-        float soilMin = doc["thresholds"]["moisture"]["min"];
-        float soilMax = doc["thresholds"]["moisture"]["max"];
-
-        // --- Read Sensor Data ---
-        int rawSoil = analogRead(SOIL_PIN); // ESP32 ADC: 0–4095
-        float soilPercent = map(rawSoil, 0, 4095, 100, 0); // Adjust as per calibration
-
-        Serial.println("\n---- Sensor Readings ----");
-        Serial.printf("Soil Moisture: %.1f%% (raw: %d)\n", soilPercent, rawSoil);
-
-        // --- Control Pump Based on Thresholds ---
-        if (soilPercent < soilMin) {
-          Serial.println("Soil too dry! Pump ON");
-          digitalWrite(PUMP_PIN, HIGH); // ON
-        } else if (soilPercent > soilMax) {
-          Serial.println("Soil too wet! Pump OFF");
-          digitalWrite(PUMP_PIN, LOW);  // OFF
-        } else {
-          Serial.println("Soil moisture is OK. Pump OFF");
-          digitalWrite(PUMP_PIN, LOW);  // OFF
-        }
-
-      } else {
-        Serial.print("JSON Parsing error: ");
-        Serial.println(error.c_str());
-      }
+    fetchThresholds();
+  } else {
+    Serial.println("WiFi Disconnected!");
+  }
+
+  if (haveThresholds) {
+    float soilMin = thresholds.soilMin;
+    float soilMax = thresholds.soilMax;
+
+    // --- Read Sensor Data ---
+    int rawSoil = analogRead(SOIL_PIN); // ESP32 ADC: 0–4095
+    float soilPercent = map(rawSoil, 0, 4095, 100, 0); // Adjust as per calibration
+
+    Serial.println("\n---- Sensor Readings ----");
+    Serial.printf("Soil Moisture: %.1f%% (raw: %d)\n", soilPercent, rawSoil);
 
+    // --- Control Pump Based on Thresholds ---
+    if (soilPercent < soilMin) {
+      Serial.println("Soil too dry! Pump ON");
+      digitalWrite(PUMP_PIN, HIGH); // ON
+    } else if (soilPercent > soilMax) {
+      Serial.println("Soil too wet! Pump OFF");
+      digitalWrite(PUMP_PIN, LOW);  // OFF
     } else {
-      Serial.print("HTTP Error: ");
-      Serial.println(httpResponseCode);
+      Serial.println("Soil moisture is OK. Pump OFF");
+      digitalWrite(PUMP_PIN, LOW);  // OFF
     }
-
-    http.end();
   } else {
-    Serial.println("WiFi Disconnected!");
+    Serial.println("No thresholds yet, pump stays OFF");
+    digitalWrite(PUMP_PIN, LOW);
   }
 
   delay(10000); // Check every 10 seconds
-}
\ No newline at end of file
+}
@@ -1,26 +1,100 @@
 #include "MqttModule.h"
 
-void MqttModule::connectToMqtt(Adafruit_MQTT_Client& mqtt) {
-  Serial.print("Connecting to MQTT...");
+MqttModule::MqttModule(Adafruit_MQTT_Client& mqtt) : mqtt(mqtt) {
+  state = WAITING_FOR_WIFI;
+  backoffMs = MIN_BACKOFF_MS;
+  nextAttemptAt = 0;
+  lastPingAt = 0;
+  attempts = 0;
+}
+
+bool MqttModule::update() {
+  unsigned long now = millis();
 
-  int8_t connection;
-  int8_t retries = 0;
+  // No point hitting the broker without a network
+  if (WiFi.status() != WL_CONNECTED) {
+    if (state == CONNECTED) {
+      linkLost(now);
+    }
+    if (state != WAITING_FOR_WIFI) {
+      Serial.println("MQTT: WiFi down, pausing reconnects");
+    }
+    state = WAITING_FOR_WIFI;
+    return false;
+  }
 
-  // Attempt to connect up to 5 times
-  while ((connection = mqtt.connect()) != 0) {
-    Serial.print("Error: ");
-    Serial.println(mqtt.connectErrorString(connection));
+  switch (state) {
+    case WAITING_FOR_WIFI:
+      // Fresh WiFi link: try straight away
+      state = BACKING_OFF;
+      backoffMs = MIN_BACKOFF_MS;
+      nextAttemptAt = now;
+      // fall through
+    case BACKING_OFF:
+      if ((long)(now - nextAttemptAt) >= 0) {
+        attempt();
+      }
+      break;
 
-    retries++;
-    if (retries >= 5) {
-      Serial.println("Failed to connect after 5 attempts. Restarting...");
+    case CONNECTED:
+      if (!mqtt.connected()) {
+        linkLost(now);
+        break;
+      }
+      if (now - lastPingAt >= PING_INTERVAL_MS) {
+        lastPingAt = now;
+        if (!mqtt.ping()) {
+          linkLost(now);
+        }
+      }
+      break;
+  }
+  return state == CONNECTED;
+}
 
-      // Blocking alternative for platforms that don't support restart
-      while (true); 
-    }
+void MqttModule::attempt() {
+  attempts++;
+  Serial.print("Connecting to MQTT...");
+  int8_t connection = mqtt.connect();
+  unsigned long now = millis();
 
-    delay(2000); // Wait before retry
+  if (connection == 0) {
+    Serial.println("Connected to MQTT!");
+    state = CONNECTED;
+    backoffMs = MIN_BACKOFF_MS;
+    lastPingAt = now;
+    attempts = 0;
+    return;
   }
 
-  Serial.println("Connected to MQTT!");
+  Serial.print("Error: ");
+  Serial.println(mqtt.connectErrorString(connection));
+  mqtt.disconnect();
+
+  uint32_t delayMs = jittered(backoffMs);
+  nextAttemptAt = now + delayMs;
+  Serial.printf("MQTT: attempt %lu failed, next in %lu ms\n", (unsigned long)attempts, (unsigned long)delayMs);
+  backoffMs = backoffMs >= MAX_BACKOFF_MS / 2 ? MAX_BACKOFF_MS : backoffMs * 2;
+}
+
+void MqttModule::linkLost(unsigned long now) {
+  Serial.println("MQTT: connection lost");
+  mqtt.disconnect();
+  state = BACKING_OFF;
+  backoffMs = MIN_BACKOFF_MS;
+  nextAttemptAt = now + jittered(backoffMs);
+}
+
+uint32_t MqttModule::jittered(uint32_t delayMs) {
+  // Uniform in [0.75, 1.25] x delay
+  uint32_t spread = delayMs / 2;
+  return delayMs - spread / 2 + (uint32_t)random(spread + 1);
+}
+
+bool MqttModule::isConnected() const {
+  return state == CONNECTED;
+}
+
+MqttModule::State MqttModule::getState() const {
+  return state;
 }
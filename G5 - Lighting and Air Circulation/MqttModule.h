@@ -5,11 +5,47 @@
 #include <Adafruit_MQTT_Client.h>
 #include <ArduinoJson.h>
 #include <Arduino.h>
+#include <WiFi.h>
 
+// MQTT connection state machine, stepped from loop().
+//
+// update() makes at most one connect() per call, and only once the backoff
+// has expired, so the loop is never held up for more than one attempt.
+// Failed attempts back off exponentially from MIN_BACKOFF_MS to
+// MAX_BACKOFF_MS with +/-25 % jitter. Nothing is tried while WiFi is down.
+// connect() re-sends the registered subscriptions, so they survive a reconnect.
 class MqttModule {
 
   public:
-  static void connectToMqtt(Adafruit_MQTT_Client& mqtt);
+  enum State : uint8_t {
+    WAITING_FOR_WIFI,
+    BACKING_OFF,
+    CONNECTED
+  };
+
+  static const uint32_t MIN_BACKOFF_MS = 1000;
+  static const uint32_t MAX_BACKOFF_MS = 60000;
+  // Well inside the 300 s keepalive of Adafruit_MQTT
+  static const uint32_t PING_INTERVAL_MS = 60000;
+
+  explicit MqttModule(Adafruit_MQTT_Client& mqtt);
+
+  // Advances the state machine; returns true while the broker link is up
+  bool update();
+  bool isConnected() const;
+  State getState() const;
+
+  private:
+  Adafruit_MQTT_Client& mqtt;
+  State state;
+  uint32_t backoffMs;
+  unsigned long nextAttemptAt;
+  unsigned long lastPingAt;
+  uint32_t attempts;
+
+  void attempt();
+  void linkLost(unsigned long now);
+  uint32_t jittered(uint32_t delayMs);
 };
 
-#endif
\ No newline at end of file
+#endif
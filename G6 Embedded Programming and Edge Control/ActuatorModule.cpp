@@ -1,177 +1,312 @@
 #include "ActuatorModule.h"
+#include "Log.h"
 
 ActuatorModule::ActuatorModule(
-    int pump,
-    int fan1,
-    int fan2,
-    int light,
+    ActuatorOutputs &outputs,
     Adafruit_MQTT_Publish *publish,
     Adafruit_MQTT_Publish *feedback,
-    Adafruit_MQTT_Subscribe *subscribe)
+    Adafruit_MQTT_Subscribe *subscribe,
+    const String &zone)
+    : outputs(outputs)
 {
-  pumpPin = pump;
-  fanPin1 = fan1;
-  fanPin2 = fan2;
-  lightPin = light;
   publishFeed = publish;
   feedbackFeed = feedback;
   subscribeFeed = subscribe;
+  strncpy(this->zone, zone.c_str(), sizeof(this->zone) - 1);
+  this->zone[sizeof(this->zone) - 1] = '\0';
+
+  // Fixed header, topic length and topic share the client's packet buffer
+  if (feedback != nullptr)
+  {
+    size_t overhead = strlen(feedback->topic) + 5;
+    size_t room = overhead < MAXBUFFERSIZE ? MAXBUFFERSIZE - overhead : 0;
+    if (room < feedbackLimit)
+    {
+      feedbackLimit = room;
+    }
+  }
 }
 
 void ActuatorModule::begin()
 {
   Serial.println("Initializing actuators...");
-  pinMode(pumpPin, OUTPUT);
-  pinMode(fanPin1, OUTPUT);
-  pinMode(fanPin2, OUTPUT);
-  pinMode(lightPin, OUTPUT);
+  // Start from a known state so the recorded states match the outputs
+  outputs.begin();
   Serial.println("Actuators initialized.");
 }
 
-String ActuatorModule::getISO8601Time()
+void ActuatorModule::recordTransition(const char *action, bool system)
 {
-  struct tm timeinfo;
-  time_t now;
-
-  time(&now);                   // Get current time as time_t
-  now += 8 * 3600;              // Add 8 hours for UTC+8
-  gmtime_r(&now, &timeinfo);    // Convert to UTC+8 time
-
-  char buffer[30];
-  strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-
-  Serial.println("Timestamp (UTC+8): " + String(buffer));
-  return String(buffer);
+  feedbackStats.transitions++;
+  if (transitionCount == MAX_PENDING_TRANSITIONS)
+  {
+    // Keep the most recent transitions
+    memmove(transitions, transitions + 1, sizeof(transitions[0]) * (MAX_PENDING_TRANSITIONS - 1));
+    transitionCount--;
+    feedbackStats.dropped++;
+  }
+  transitions[transitionCount].action = action;
+  transitions[transitionCount].system = system;
+  transitionCount++;
 }
 
-void ActuatorModule::sendFeedback(const String &action, const String &triggeredBy, const String &source, const String &zone, bool success)
+void ActuatorModule::flushFeedback(unsigned long now)
 {
-  StaticJsonDocument<256> doc;
-
-  String timestamp = getISO8601Time();
-
-  doc["action"] = action;
-  doc["triggeredBy"] = triggeredBy;
-  doc["source"] = source;
-  doc["zone"] = zone;
-  doc["timestamp"] = timestamp;
-  doc["result"] = success ? "success" : "fail";
+  if (transitionCount == 0 || (feedbackFeed == nullptr && feedbackPublisher == nullptr))
+  {
+    return;
+  }
+  if (feedbackSentOnce && now - lastFeedbackAt < FEEDBACK_INTERVAL_MS)
+  {
+    return;
+  }
 
-  char payload[256];
-  serializeJson(doc, payload);
+  PROFILE_SCOPE(PHASE_FEEDBACK);
+  lastFeedbackAt = now;
+  feedbackSentOnce = true;
 
-  if (feedbackFeed)
+  // A batch that does not fit one MQTT packet goes out as several messages
+  // of as many transitions as fit; the client would cut it off otherwise
+  char payload[FEEDBACK_CAPACITY];
+  while (transitionCount > 0)
   {
-    if (!feedbackFeed->publish(payload))
+    BufferPrint out(payload, feedbackLimit + 1);
+    int count = transitionCount;
+    while (count > 0 && !encodeFeedback(out, count))
     {
-      Serial.println("Failed to publish actuator feedback");
+      count--;
     }
-    else
+    if (count == 0)
     {
-      Serial.println("Actuator feedback published");
+      // Cannot be sent at all; drop it rather than block the ones behind it
+      feedbackStats.oversized++;
+      LOG_WARN("Actuator feedback %s does not fit one message, dropped", transitions[0].action);
+      removeTransitions(1);
+      continue;
     }
+
+    feedbackStats.publishes++;
+    bool published = feedbackPublisher != nullptr ? feedbackPublisher(out.data(), out.length())
+                                                  : feedbackFeed->publish((uint8_t *)payload, out.length());
+    if (!published)
+    {
+      // Kept for the next interval
+      feedbackStats.publishFailures++;
+      LOG_WARN("Failed to publish actuator feedback");
+      return;
+    }
+    LOG_INFO("Actuator feedback published (%d transitions)", count);
+    removeTransitions(count);
   }
 }
 
+bool ActuatorModule::encodeFeedback(BufferPrint &out, int count)
+{
+  out.reset();
+  if (feedbackFormat == FORMAT_CBOR)
+  {
+    CborWriter cbor(out);
+    PayloadSerializer::actuatorFeedbackBatch(cbor, zone, ClockService::epochMs(), transitions, count);
+  } else
+  {
+    PayloadSerializer::actuatorFeedbackBatch(out, zone, ClockService::epochSeconds(), transitions, count);
+  }
+  return !out.overflowed();
+}
+
+void ActuatorModule::removeTransitions(int count)
+{
+  memmove(transitions, transitions + count, sizeof(transitions[0]) * (transitionCount - count));
+  transitionCount -= count;
+}
+
+void ActuatorModule::setFeedbackPublisher(FeedbackPublisher publisher)
+{
+  feedbackPublisher = publisher;
+}
+
+void ActuatorModule::setFeedbackFormat(PayloadFormat format)
+{
+  feedbackFormat = format;
+}
+
+bool ActuatorModule::isOn(ActuatorId id) const
+{
+  return outputs.isOn(id);
+}
+
+bool ActuatorModule::isPumpOn() const
+{
+  return outputs.isOn(ACTUATOR_PUMP);
+}
+
+const FeedbackStats &ActuatorModule::getFeedbackStats() const
+{
+  return feedbackStats;
+}
+
 void ActuatorModule::callback(Adafruit_MQTT_Subscribe *subscription)
 {
-  Serial.println("ActuatorModule callback triggered");
+  LOG_DEBUG("ActuatorModule callback triggered");
   // Ensure the message came from the correct topic
   if (subscribeFeed && strcmp(subscription->topic, subscribeFeed->topic) == 0)
   {
-    const char *command = (char *)subscribeFeed->lastread;
-
-    // Parse JSON payload
-    StaticJsonDocument<200> doc;
-    DeserializationError error = deserializeJson(doc, command);
+    handleCommand((char *)subscribeFeed->lastread, Hal::micros());
+  }
+}
 
-    if (error)
-    {
-      Serial.print("JSON parse failed: ");
-      Serial.println(error.c_str());
-      return;
-    }
+void ActuatorModule::handleCommand(const char *command, unsigned long receivedAtUs)
+{
+  // Parse JSON payload
+  StaticJsonDocument<200> doc;
+  DeserializationError error = deserializeJson(doc, command);
 
-    // Read JSON fields
-    const char *light = doc["light"];
-    const char *fan = doc["fan"];
-    const char *pump = doc["pump"];
+  if (error)
+  {
+    LOG_WARN("JSON parse failed: %s", error.c_str());
+    return;
+  }
 
-    Serial.print("Light: ");
-    Serial.println(light);
-    Serial.print("Fan: ");
-    Serial.println(fan);
-    Serial.print("Pump: ");
-    Serial.println(pump);
+  handleCommand(doc, receivedAtUs);
+}
 
-    if (light != nullptr)
+void ActuatorModule::handleCommand(const JsonDocument &doc, unsigned long receivedAtUs)
+{
+  // One key per channel of this zone, queued in declaration order
+  for (uint8_t i = 0; i < outputs.size(); i++)
+  {
+    ActuatorId id = outputs.idAt(i);
+    const char *value = doc[actuatorName(id)];
+    if (value != nullptr)
     {
-      setLight(strcmp(light, "ON") == 0, false);
-      delay(5000);
+      LOG_INFO("%s %s: %s", zone, actuatorName(id), value);
+      enqueue(id, strcmp(value, "ON") == 0, receivedAtUs);
     }
+  }
 
-    if (fan != nullptr)
-    {
-      setFan(strcmp(fan, "ON") == 0, false);
-      delay(5000);
-    }
+  update();
+}
 
-    if (pump != nullptr)
+bool ActuatorModule::enqueue(ActuatorId target, bool on, unsigned long receivedAtUs)
+{
+  commandStats.received++;
+
+  for (int i = 0; i < commandCount; i++)
+  {
+    ActuatorCommand &queued = commands[(commandHead + i) % COMMAND_QUEUE_SIZE];
+    if (queued.target == target)
     {
-      setPump(strcmp(pump, "ON") == 0, false);
-      delay(5000);
+      queued.on = on;
+      queued.receivedAtUs = receivedAtUs;
+      commandStats.coalesced++;
+      return true;
     }
   }
+
+  if (commandCount == COMMAND_QUEUE_SIZE)
+  {
+    LOG_WARN("Actuator command queue full, command dropped");
+    commandStats.dropped++;
+    return false;
+  }
+
+  ActuatorCommand &command = commands[(commandHead + commandCount) % COMMAND_QUEUE_SIZE];
+  command.target = target;
+  command.on = on;
+  command.receivedAtUs = receivedAtUs;
+  commandCount++;
+  return true;
 }
 
-void ActuatorModule::setPump(bool state, bool system)
+bool ActuatorModule::hasPendingCommands() const
 {
-  const bool currentState = digitalRead(pumpPin) == HIGH ? true : false;
-  if( currentState == state ) {
-    Serial.println("Pump is already in the desired state. No action taken.");
-    return;
+  return commandCount > 0;
+}
+
+const CommandStats &ActuatorModule::getCommandStats() const
+{
+  return commandStats;
+}
+
+void ActuatorModule::printCommandStats()
+{
+  Serial.printf("[ACT] transitions: %lu, feedback publishes: %lu, failed: %lu, dropped: %lu, oversized: %lu\n",
+                (unsigned long)feedbackStats.transitions, (unsigned long)feedbackStats.publishes,
+                (unsigned long)feedbackStats.publishFailures, (unsigned long)feedbackStats.dropped,
+                (unsigned long)feedbackStats.oversized);
+  Serial.printf("[ACT] commands: %lu, applied: %lu, coalesced: %lu, dropped: %lu, latency us (last/max): %lu/%lu\n",
+                (unsigned long)commandStats.received, (unsigned long)commandStats.applied,
+                (unsigned long)commandStats.coalesced, (unsigned long)commandStats.dropped,
+                (unsigned long)commandStats.lastLatencyUs, (unsigned long)commandStats.maxLatencyUs);
+}
+
+void ActuatorModule::apply(const ActuatorCommand &command)
+{
+  PROFILE_SCOPE(PHASE_ACTUATION);
+  uint32_t latencyUs = Hal::micros() - command.receivedAtUs;
+
+  set(command.target, command.on, false);
+
+  commandStats.applied++;
+  commandStats.lastLatencyUs = latencyUs;
+  if (latencyUs > commandStats.maxLatencyUs)
+  {
+    commandStats.maxLatencyUs = latencyUs;
   }
-  digitalWrite(pumpPin, state ? HIGH : LOW);
-  sendFeedback(
-      String("pump ") + (state ? "ON" : "OFF"),
-      system ? "SYSTEM" : "USER",
-      system ? "auto" : "manual",
-      "zone1",
-      true);
 }
 
-void ActuatorModule::setFan(bool state, bool system)
+void ActuatorModule::update()
 {
-  const bool currentState = digitalRead(fanPin1) == HIGH ? true : false;
-  const bool currentState2 = digitalRead(fanPin2) == HIGH ? true : false;
-  if( currentState == state && currentState2 == state ) 
+  unsigned long now = Hal::millis();
+  if (!hasPendingCommands() || (actuatedOnce && now - lastActuationAt < ACTUATION_SPACING_MS))
   {
-    Serial.println("Fan is already in the desired state. No action taken.");
+    flushFeedback(now);
     return;
   }
-  digitalWrite(fanPin1, state ? HIGH : LOW);
-  digitalWrite(fanPin2, state ? HIGH : LOW);
-  sendFeedback(
-      String("fan ") + (state ? "ON" : "OFF"),
-      system ? "SYSTEM" : "USER",
-      system ? "auto" : "manual",
-      "zone1",
-      true);
+
+  // Take the command off the queue first so the setters see a consistent queue
+  ActuatorCommand command = commands[commandHead];
+  commandHead = (commandHead + 1) % COMMAND_QUEUE_SIZE;
+  commandCount--;
+  apply(command);
+
+  lastActuationAt = now;
+  actuatedOnce = true;
+  flushFeedback(now);
 }
 
-void ActuatorModule::setLight(bool state, bool system)
+ActuatorWrite ActuatorModule::set(ActuatorId id, bool state, bool system)
 {
-  const bool currentState = digitalRead(lightPin) == HIGH ? true : false;
-  if( currentState == state ) 
+  ActuatorWrite result = outputs.set(id, state, Hal::millis());
+  switch (result)
   {
-    Serial.println("Light is already in the desired state. No action taken.");
-    return;
+  case WRITE_SWITCHED:
+    recordTransition(actuatorAction(id, state), system);
+    break;
+  case WRITE_UNCHANGED:
+    LOG_DEBUG("%s is already in the desired state. No action taken.", actuatorName(id));
+    break;
+  case WRITE_HELD:
+    LOG_INFO("%s %s held back by the channel dwell", actuatorName(id), state ? "ON" : "OFF");
+    break;
+  case WRITE_ABSENT:
+    LOG_WARN("No %s on this node", actuatorName(id));
+    break;
   }
-  digitalWrite(lightPin, state ? HIGH : LOW);
-  sendFeedback(
-      String("light ") + (state ? "ON" : "OFF"),
-      system ? "SYSTEM" : "USER",
-      system ? "auto" : "manual",
-      "zone1",
-      true);
+  return result;
+}
+
+void ActuatorModule::setPump(bool state, bool system)
+{
+  set(ACTUATOR_PUMP, state, system);
+}
+
+void ActuatorModule::setFan(bool state, bool system)
+{
+  set(ACTUATOR_FAN, state, system);
+}
+
+void ActuatorModule::setLight(bool state, bool system)
+{
+  set(ACTUATOR_LIGHT, state, system);
 }
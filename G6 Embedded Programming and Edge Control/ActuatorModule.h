@@ -2,40 +2,126 @@
 #define ACTUATORMODULE_H
 
 #include <Arduino.h>
+#include <functional>
 
 #include <Adafruit_MQTT.h>
 #include <Adafruit_MQTT_Client.h>
 #include <ArduinoJson.h>
 #include "SensorModule.h"
+#include "PayloadSerializer.h"
+#include "ClockService.h"
+#include "Profiler.h"
+#include "ActuatorRoles.h"
+#include "Hal.h"
+
+// Manual command received over MQTT, waiting for its turn on the GPIO
+struct ActuatorCommand
+{
+  ActuatorId target;
+  bool on;
+  unsigned long receivedAtUs;
+};
+
+struct FeedbackStats
+{
+  uint32_t transitions;
+  uint32_t publishes;
+  uint32_t publishFailures;
+  uint32_t dropped;        // transitions lost while the feedback queue was full
+  uint32_t oversized;      // a single transition larger than one MQTT message, dropped
+};
+
+struct CommandStats
+{
+  uint32_t received;
+  uint32_t applied;
+  uint32_t coalesced;      // replaced a queued command for the same actuator
+  uint32_t dropped;        // queue full
+  uint32_t lastLatencyUs;  // receive to GPIO write
+  uint32_t maxLatencyUs;
+};
 
 class ActuatorModule 
 {
+  public:
+    // Hands a serialized feedback message to the network side; false = retry later
+    typedef std::function<bool(const uint8_t *payload, size_t length)> FeedbackPublisher;
+    static const size_t FEEDBACK_CAPACITY = 512;
+
   private:
-    int pumpPin;
-    int fanPin1;
-    int fanPin2;
-    int lightPin;
+    // Channel set of this module's zone, see ActuatorRoles.h
+    ActuatorOutputs &outputs;
     Adafruit_MQTT_Publish* publishFeed;
     Adafruit_MQTT_Publish* feedbackFeed;
     Adafruit_MQTT_Subscribe* subscribeFeed;
+    char zone[16];
+
+    // Transitions are published together, at most one message per FEEDBACK_INTERVAL_MS
+    static const unsigned long FEEDBACK_INTERVAL_MS = 2000;
+    static const int MAX_PENDING_TRANSITIONS = 8;
+    ActuatorTransition transitions[MAX_PENDING_TRANSITIONS];
+    int transitionCount = 0;
+    unsigned long lastFeedbackAt = 0;
+    bool feedbackSentOnce = false;
+    FeedbackStats feedbackStats = {};
+    FeedbackPublisher feedbackPublisher = nullptr;
+    PayloadFormat feedbackFormat = FORMAT_JSON;
+    // Largest message the feedback topic can carry in one MQTT packet
+    size_t feedbackLimit = FEEDBACK_CAPACITY - 1;
+
+    // Manual commands are applied in arrival order, one actuator at a time,
+    // ACTUATION_SPACING_MS apart. A newer command for an actuator that is
+    // still queued replaces the older one in place.
+    static const unsigned long ACTUATION_SPACING_MS = 5000;
+    static const int COMMAND_QUEUE_SIZE = 8;
+    ActuatorCommand commands[COMMAND_QUEUE_SIZE];
+    int commandHead = 0;
+    int commandCount = 0;
+    unsigned long lastActuationAt = 0;
+    bool actuatedOnce = false;
+    CommandStats commandStats = {};
+
+    bool enqueue(ActuatorId target, bool on, unsigned long receivedAtUs);
+    void apply(const ActuatorCommand &command);
+    void recordTransition(const char *action, bool system);
+    void flushFeedback(unsigned long now);
+    // Serializes the count oldest transitions; false if they do not fit out
+    bool encodeFeedback(BufferPrint &out, int count);
+    void removeTransitions(int count);
 
   public:
     ActuatorModule(
-      int pump, 
-      int fan1, 
-      int fan2, 
-      int light, 
+      ActuatorOutputs &outputs,
       Adafruit_MQTT_Publish* publish, 
       Adafruit_MQTT_Publish* feedback,
-      Adafruit_MQTT_Subscribe* subscribe
+      Adafruit_MQTT_Subscribe* subscribe,
+      const String &zone
 );
     void begin();
+    // Switches one channel and records the transition for feedback
+    ActuatorWrite set(ActuatorId id, bool state, bool system = true);
+    bool isOn(ActuatorId id) const;
     void setPump(bool state, bool system = true);
     void setFan(bool state, bool system = true);
     void callback(Adafruit_MQTT_Subscribe* subscription);
-    void sendFeedback(const String &action, const String &triggeredBy, const String &source, const String &zone, bool success);
+    // Parses a JSON command ({"light":"ON",...}) and queues it
+    void handleCommand(const char *json, unsigned long receivedAtUs);
+    // Same for a command the caller already parsed (e.g. to route it by zone)
+    void handleCommand(const JsonDocument &doc, unsigned long receivedAtUs);
+    // Feedback goes through publisher instead of publishing on feedbackFeed directly,
+    // for when the MQTT client is owned by another task
+    void setFeedbackPublisher(FeedbackPublisher publisher);
+    // JSON by default; CBOR messages are binary and only fit a binary-safe feed
+    void setFeedbackFormat(PayloadFormat format);
+    // Applies the next queued manual command once the spacing has elapsed
+    // and publishes the feedback collected since the last message
+    void update();
+    bool hasPendingCommands() const;
+    const CommandStats &getCommandStats() const;
+    void printCommandStats();
+    bool isPumpOn() const;
+    const FeedbackStats &getFeedbackStats() const;
     void setLight(bool state, bool system = true);
-    String getISO8601Time();
 };
 
 #endif
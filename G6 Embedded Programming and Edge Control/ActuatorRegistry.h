@@ -0,0 +1,232 @@
+#ifndef ACTUATORREGISTRY_H
+#define ACTUATORREGISTRY_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+// Every actuator kind a node can carry. The name doubles as the key of
+// the MQTT command ({"light":"ON"}) and the prefix of feedback actions.
+enum ActuatorId : uint8_t
+{
+    ACTUATOR_LIGHT,
+    ACTUATOR_FAN,
+    ACTUATOR_PUMP,
+    ACTUATOR_COUNT
+};
+
+inline const char *actuatorName(ActuatorId id)
+{
+    static const char *const NAMES[ACTUATOR_COUNT] = {"light", "fan", "pump"};
+    return id < ACTUATOR_COUNT ? NAMES[id] : "?";
+}
+
+// "pump ON", "fan OFF", ...; static strings, safe to keep in a feedback batch
+inline const char *actuatorAction(ActuatorId id, bool on)
+{
+    static const char *const ACTIONS[ACTUATOR_COUNT][2] = {
+        {"light OFF", "light ON"},
+        {"fan OFF", "fan ON"},
+        {"pump OFF", "pump ON"}};
+    return id < ACTUATOR_COUNT ? ACTIONS[id][on ? 1 : 0] : "?";
+}
+
+enum ActuatorWrite : uint8_t
+{
+    WRITE_UNCHANGED,   // already in that state
+    WRITE_SWITCHED,
+    WRITE_HELD,        // refused: the channel's dwell has not elapsed
+    WRITE_ABSENT       // this node has no such channel
+};
+
+static const uint8_t NO_PIN = 0xFF;
+
+// One output channel, fixed at compile time. GangedPin is driven together
+// with Pin (two relays for one fan bank). ActiveLevel is the level that
+// switches the load on. MinOnMs/MinOffMs hold a state for at least that
+// long; keep them at 0 on channels that must always be able to switch off.
+template <ActuatorId Id, uint8_t Pin, uint8_t GangedPin = NO_PIN, uint8_t ActiveLevel = HIGH,
+          uint32_t MinOnMs = 0, uint32_t MinOffMs = 0>
+struct ActuatorChannel
+{
+    static const ActuatorId ID = Id;
+    static const uint32_t MIN_ON_MS = MinOnMs;
+    static const uint32_t MIN_OFF_MS = MinOffMs;
+
+    static void configure()
+    {
+        Hal::pinMode(Pin, OUTPUT);
+        if (GangedPin != NO_PIN)
+        {
+            Hal::pinMode(GangedPin, OUTPUT);
+        }
+        write(false);
+    }
+
+    static void write(bool on)
+    {
+        uint8_t level = on ? ActiveLevel : (ActiveLevel == HIGH ? LOW : HIGH);
+        Hal::digitalWrite(Pin, level);
+        if (GangedPin != NO_PIN)
+        {
+            Hal::digitalWrite(GangedPin, level);
+        }
+    }
+};
+
+// The channel set of a node role. Each channel keeps the last state
+// written (outputs are never read back) and when it changed. Lookups by
+// id unroll into a chain of compares over the declared channels only, so
+// a role without a pump carries no pump code at all.
+template <typename... Channels>
+class ActuatorRegistry;
+
+template <>
+class ActuatorRegistry<>
+{
+public:
+    static const uint8_t SIZE = 0;
+
+    static constexpr bool has(ActuatorId)
+    {
+        return false;
+    }
+
+    void begin()
+    {
+    }
+
+    ActuatorWrite set(ActuatorId, bool, uint32_t)
+    {
+        return WRITE_ABSENT;
+    }
+
+    bool isOn(ActuatorId) const
+    {
+        return false;
+    }
+
+    static constexpr ActuatorId idAt(uint8_t)
+    {
+        return ACTUATOR_COUNT;
+    }
+};
+
+template <typename Channel, typename... Rest>
+class ActuatorRegistry<Channel, Rest...> : private ActuatorRegistry<Rest...>
+{
+    typedef ActuatorRegistry<Rest...> Next;
+
+public:
+    static const uint8_t SIZE = 1 + sizeof...(Rest);
+
+    static constexpr bool has(ActuatorId id)
+    {
+        return id == Channel::ID || Next::has(id);
+    }
+
+    ActuatorRegistry() : on(false), changedOnce(false), changedAt(0)
+    {
+    }
+
+    // Drives every output to off
+    void begin()
+    {
+        Channel::configure();
+        on = false;
+        changedOnce = false;
+        Next::begin();
+    }
+
+    ActuatorWrite set(ActuatorId id, bool state, uint32_t nowMs)
+    {
+        if (id != Channel::ID)
+        {
+            return Next::set(id, state, nowMs);
+        }
+        if (on == state)
+        {
+            return WRITE_UNCHANGED;
+        }
+        uint32_t dwell = Channel::MIN_OFF_MS;
+        if (on)
+        {
+            dwell = Channel::MIN_ON_MS;
+        }
+        if (changedOnce && nowMs - changedAt < dwell)
+        {
+            return WRITE_HELD;
+        }
+        Channel::write(state);
+        on = state;
+        changedOnce = true;
+        changedAt = nowMs;
+        return WRITE_SWITCHED;
+    }
+
+    bool isOn(ActuatorId id) const
+    {
+        return id == Channel::ID ? on : Next::isOn(id);
+    }
+
+    // Id of the index-th channel in declaration order
+    static constexpr ActuatorId idAt(uint8_t index)
+    {
+        return index == 0 ? Channel::ID : Next::idAt(index - 1);
+    }
+
+private:
+    bool on;
+    bool changedOnce;
+    uint32_t changedAt;
+};
+
+// Runtime view of a channel set, so one ActuatorModule can drive the
+// registry of whichever zone it belongs to
+class ActuatorOutputs
+{
+public:
+    virtual ~ActuatorOutputs()
+    {
+    }
+
+    virtual void begin() = 0;
+    virtual ActuatorWrite set(ActuatorId id, bool on, uint32_t nowMs) = 0;
+    virtual bool isOn(ActuatorId id) const = 0;
+    virtual uint8_t size() const = 0;
+    virtual ActuatorId idAt(uint8_t index) const = 0;
+};
+
+template <typename Registry>
+class ActuatorBank : public ActuatorOutputs
+{
+public:
+    void begin() override
+    {
+        registry.begin();
+    }
+
+    ActuatorWrite set(ActuatorId id, bool on, uint32_t nowMs) override
+    {
+        return registry.set(id, on, nowMs);
+    }
+
+    bool isOn(ActuatorId id) const override
+    {
+        return registry.isOn(id);
+    }
+
+    uint8_t size() const override
+    {
+        return Registry::SIZE;
+    }
+
+    ActuatorId idAt(uint8_t index) const override
+    {
+        return Registry::idAt(index);
+    }
+
+private:
+    Registry registry;
+};
+
+#endif
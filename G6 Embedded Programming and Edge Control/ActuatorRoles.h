@@ -0,0 +1,34 @@
+#ifndef ACTUATORROLES_H
+#define ACTUATORROLES_H
+
+#include "ActuatorRegistry.h"
+
+// Actuator layouts of the zone controller, one channel set per zone the
+// board drives.
+
+// Pump, a fan bank on two relays and the grow light. Light and fan dwell is
+// handled by RuleEvaluator, the pump by PumpController (and it must always
+// be able to switch off), so the channels add none.
+#define PUMP_PIN 25
+#define FAN_PIN_1 27
+#define FAN_PIN_2 18
+#define LIGHT_PIN 26
+
+typedef ActuatorRegistry<
+    ActuatorChannel<ACTUATOR_LIGHT, LIGHT_PIN>,
+    ActuatorChannel<ACTUATOR_FAN, FAN_PIN_1, FAN_PIN_2>,
+    ActuatorChannel<ACTUATOR_PUMP, PUMP_PIN>>
+    Zone1Actuators;
+
+// A second tray on the same board: same channels, single fan relay
+#define ZONE2_PUMP_PIN 19
+#define ZONE2_FAN_PIN 21
+#define ZONE2_LIGHT_PIN 22
+
+typedef ActuatorRegistry<
+    ActuatorChannel<ACTUATOR_LIGHT, ZONE2_LIGHT_PIN>,
+    ActuatorChannel<ACTUATOR_FAN, ZONE2_FAN_PIN>,
+    ActuatorChannel<ACTUATOR_PUMP, ZONE2_PUMP_PIN>>
+    Zone2Actuators;
+
+#endif
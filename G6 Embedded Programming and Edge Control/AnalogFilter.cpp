@@ -0,0 +1,127 @@
+#include "AnalogFilter.h"
+
+const AnalogFilter::Config AnalogFilter::DEFAULT_CONFIG = {8, 5, 3};
+
+AnalogFilter::AnalogFilter(uint8_t pin, AnalogReader reader)
+{
+    this->reader = reader;
+    this->pin = pin;
+    lastCostUs = 0;
+    maxCostUs = 0;
+    configure(DEFAULT_CONFIG);
+}
+
+void AnalogFilter::configure(const Config &config)
+{
+    this->config.oversample = constrain(config.oversample, 1, MAX_OVERSAMPLE);
+    // An even window has no middle element, round it down to an odd one
+    uint8_t window = constrain(config.medianWindow, 1, MAX_MEDIAN);
+    this->config.medianWindow = (window % 2 == 0) ? window - 1 : window;
+    this->config.emaShift = config.emaShift > MAX_EMA_SHIFT ? MAX_EMA_SHIFT : config.emaShift;
+    reset();
+}
+
+const AnalogFilter::Config &AnalogFilter::getConfig() const
+{
+    return config;
+}
+
+void AnalogFilter::attach(uint8_t pin)
+{
+    this->pin = pin;
+    reset();
+}
+
+uint8_t AnalogFilter::getPin() const
+{
+    return pin;
+}
+
+void AnalogFilter::reset()
+{
+    windowHead = 0;
+    windowCount = 0;
+    ema = 0;
+    primed = false;
+}
+
+uint16_t AnalogFilter::sample()
+{
+    uint32_t start = Hal::micros();
+
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < config.oversample; i++)
+    {
+        sum += reader(pin);
+    }
+    uint16_t filtered = update((sum + config.oversample / 2) / config.oversample);
+
+    lastCostUs = Hal::micros() - start;
+    if (lastCostUs > maxCostUs)
+    {
+        maxCostUs = lastCostUs;
+    }
+    return filtered;
+}
+
+uint16_t AnalogFilter::update(uint16_t reading)
+{
+    window[windowHead] = reading;
+    windowHead = (windowHead + 1) % config.medianWindow;
+    if (windowCount < config.medianWindow)
+    {
+        windowCount++;
+    }
+
+    int32_t x = (int32_t)median() << EMA_FRACTION_BITS;
+    if (!primed)
+    {
+        // Start from the first reading instead of ramping up from zero
+        ema = x;
+        primed = true;
+    }
+    else
+    {
+        ema += (x - ema) >> config.emaShift;
+    }
+    return value();
+}
+
+uint16_t AnalogFilter::median() const
+{
+    // Insertion sort of at most MAX_MEDIAN values
+    uint16_t sorted[MAX_MEDIAN];
+    for (uint8_t i = 0; i < windowCount; i++)
+    {
+        uint16_t v = window[i];
+        int8_t j = i - 1;
+        while (j >= 0 && sorted[j] > v)
+        {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    return sorted[windowCount / 2];
+}
+
+uint16_t AnalogFilter::value() const
+{
+    // Round to nearest
+    return (uint16_t)((ema + (1 << (EMA_FRACTION_BITS - 1))) >> EMA_FRACTION_BITS);
+}
+
+bool AnalogFilter::hasValue() const
+{
+    return primed;
+}
+
+uint32_t AnalogFilter::getLastCostUs() const
+{
+    return lastCostUs;
+}
+
+uint32_t AnalogFilter::getMaxCostUs() const
+{
+    return maxCostUs;
+}
@@ -0,0 +1,74 @@
+#ifndef ANALOGFILTER_H
+#define ANALOGFILTER_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+// Noise filter for one ADC channel, run once per sampling tick:
+//
+//   oversample  -> average of N back-to-back analogRead()s
+//   median      -> median of the last k averages, drops single-tick spikes
+//   EMA         -> y += (x - y) / 2^emaShift, smooths what is left
+//
+// Each stage is disabled by setting it to 1 (oversample, medianWindow) or
+// 0 (emaShift). Fixed memory, integer arithmetic only. The ADC read is
+// injected so recorded traces can be replayed through update().
+class AnalogFilter
+{
+public:
+    typedef uint16_t (*AnalogReader)(uint8_t pin);
+
+    static const uint8_t MAX_OVERSAMPLE = 64;
+    static const uint8_t MAX_MEDIAN = 7;
+    static const uint8_t MAX_EMA_SHIFT = 8;
+
+    struct Config
+    {
+        uint8_t oversample;
+        uint8_t medianWindow;   // odd, <= MAX_MEDIAN
+        uint8_t emaShift;
+    };
+
+    static const Config DEFAULT_CONFIG;
+
+    explicit AnalogFilter(uint8_t pin = 0, AnalogReader reader = Hal::analogRead);
+
+    void configure(const Config &config);
+    const Config &getConfig() const;
+    // Switches to another pin and clears the filter history
+    void attach(uint8_t pin);
+    uint8_t getPin() const;
+
+    // Reads the ADC and runs one filter step; returns the filtered value
+    uint16_t sample();
+    // Runs one filter step on an already averaged reading
+    uint16_t update(uint16_t reading);
+
+    uint16_t value() const;
+    bool hasValue() const;
+    void reset();
+
+    // Cost of sample() including the ADC reads, in microseconds
+    uint32_t getLastCostUs() const;
+    uint32_t getMaxCostUs() const;
+
+private:
+    static const uint8_t EMA_FRACTION_BITS = 8;
+
+    AnalogReader reader;
+    Config config;
+    uint8_t pin;
+
+    uint16_t window[MAX_MEDIAN];
+    uint8_t windowHead;
+    uint8_t windowCount;
+    int32_t ema;            // Q(EMA_FRACTION_BITS)
+    bool primed;
+
+    uint32_t lastCostUs;
+    uint32_t maxCostUs;
+
+    uint16_t median() const;
+};
+
+#endif
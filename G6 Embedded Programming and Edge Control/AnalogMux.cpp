@@ -0,0 +1,95 @@
+#include "AnalogMux.h"
+
+AnalogMux::AnalogMux()
+{
+    memset(&config, 0, sizeof(config));
+    configured = false;
+    selected = 0xFF;
+    switchedAtUs = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void AnalogMux::configure(const Config &newConfig)
+{
+    config = newConfig;
+    if (config.selectCount > MAX_SELECT)
+    {
+        config.selectCount = MAX_SELECT;
+    }
+    for (uint8_t i = 0; i < config.selectCount; i++)
+    {
+        Hal::pinMode(config.selectPins[i], OUTPUT);
+    }
+    if (config.enablePin != NO_ENABLE)
+    {
+        Hal::pinMode(config.enablePin, OUTPUT);
+        Hal::digitalWrite(config.enablePin, LOW);
+    }
+    Hal::pinMode(config.signalPin, INPUT);
+    configured = true;
+    selected = 0xFF;
+    select(0);
+}
+
+bool AnalogMux::isConfigured() const
+{
+    return configured;
+}
+
+uint8_t AnalogMux::channels() const
+{
+    return configured ? 1 << config.selectCount : 0;
+}
+
+bool AnalogMux::isMuxPin(int pin)
+{
+    return pin >= PIN_BASE && pin < PIN_BASE + (1 << MAX_SELECT);
+}
+
+uint8_t AnalogMux::channelOf(int pin)
+{
+    return pin - PIN_BASE;
+}
+
+void AnalogMux::select(uint8_t channel)
+{
+    if (channel == selected)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < config.selectCount; i++)
+    {
+        Hal::digitalWrite(config.selectPins[i], (channel >> i) & 1 ? HIGH : LOW);
+    }
+    selected = channel;
+    switchedAtUs = Hal::micros();
+    stats.switches++;
+}
+
+void AnalogMux::waitSettled()
+{
+    uint32_t start = Hal::micros();
+    while (Hal::micros() - switchedAtUs < config.settleUs)
+    {
+    }
+    stats.settleWaitUs += Hal::micros() - start;
+}
+
+uint16_t AnalogMux::read(uint8_t count)
+{
+    if (count == 0)
+    {
+        count = 1;
+    }
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        sum += Hal::analogRead(config.signalPin);
+    }
+    return (sum + count / 2) / count;
+}
+
+const AnalogMux::Stats &AnalogMux::getStats() const
+{
+    return stats;
+}
@@ -0,0 +1,64 @@
+#ifndef ANALOGMUX_H
+#define ANALOGMUX_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+// Analog multiplexer in front of one ADC pin (CD74HC4051/4067 style): the
+// select lines route channel 0..2^selectCount-1 to the signal pin. Soil
+// probes behind it are given plant pins PIN_BASE + channel, so the backend
+// and the snapshots keep addressing probes by pin.
+//
+// After a switch the output needs settleUs to follow the new source (mux
+// on-resistance into the ADC sample capacitor). select() only records when
+// the switch happened and waitSettled() waits out what is left, so a caller
+// can do other work in between and hide the settle time.
+class AnalogMux
+{
+public:
+    static const uint8_t PIN_BASE = 100;
+    static const uint8_t MAX_SELECT = 4;      // 16 channels
+    static const uint8_t NO_ENABLE = 0xFF;
+
+    struct Config
+    {
+        uint8_t signalPin;                    // ADC1 pin
+        uint8_t selectPins[MAX_SELECT];       // S0 first
+        uint8_t selectCount;
+        uint8_t enablePin;                    // active low, NO_ENABLE if tied low
+        uint16_t settleUs;
+    };
+
+    struct Stats
+    {
+        uint32_t switches;
+        uint32_t settleWaitUs;    // total time spent in waitSettled()
+    };
+
+    AnalogMux();
+
+    void configure(const Config &config);
+    bool isConfigured() const;
+    uint8_t channels() const;
+
+    static bool isMuxPin(int pin);
+    static uint8_t channelOf(int pin);
+
+    // Routes channel to the signal pin; no-op if it already is
+    void select(uint8_t channel);
+    // Returns once settleUs have passed since the last switch
+    void waitSettled();
+    // Average of count back-to-back reads of the selected channel
+    uint16_t read(uint8_t count = 1);
+
+    const Stats &getStats() const;
+
+private:
+    Config config;
+    bool configured;
+    uint8_t selected;
+    uint32_t switchedAtUs;
+    Stats stats;
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "ClockService.h"
+#include <sys/time.h>
+#include "PayloadSerializer.h"
+
+std::atomic<uint32_t> ClockService::sequence(0);
+std::atomic<uint32_t> ClockService::baseEpoch(0);
+std::atomic<uint32_t> ClockService::baseMillis(0);
+std::atomic_flag ClockService::cacheLock = ATOMIC_FLAG_INIT;
+uint32_t ClockService::cachedSecond = 0;
+char ClockService::cachedText[ClockService::TIMESTAMP_SIZE] = {0};
+ClockStats ClockService::stats = {0, 0, 0};
+
+void ClockService::begin(const char *server1, const char *server2)
+{
+    // Only starts the SNTP client; it keeps retrying until the network is up
+    configTime(0, 0, server1, server2);
+    Serial.println("NTP sync started");
+}
+
+void ClockService::update()
+{
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    if (now.tv_sec < (time_t)MIN_VALID_EPOCH)
+    {
+        return;
+    }
+
+    bool first = baseEpoch.load(std::memory_order_relaxed) == 0;
+    uint32_t millisAt = (uint32_t)Hal::millis() - (uint32_t)(now.tv_usec / 1000);
+
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    baseEpoch.store((uint32_t)now.tv_sec, std::memory_order_relaxed);
+    baseMillis.store(millisAt, std::memory_order_relaxed);
+    sequence.store(seq + 2, std::memory_order_release);
+
+    stats.syncs++;
+    if (first)
+    {
+        Serial.printf("Time synchronized: %lu\n", (unsigned long)now.tv_sec);
+    }
+}
+
+void ClockService::readBase(uint32_t &epoch, uint32_t &millisAt)
+{
+    uint32_t seq;
+    do
+    {
+        seq = sequence.load(std::memory_order_acquire);
+        epoch = baseEpoch.load(std::memory_order_relaxed);
+        millisAt = baseMillis.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != sequence.load(std::memory_order_relaxed));
+}
+
+bool ClockService::isSynced()
+{
+    return baseEpoch.load(std::memory_order_acquire) != 0;
+}
+
+uint64_t ClockService::epochMs()
+{
+    uint32_t epoch, millisAt;
+    readBase(epoch, millisAt);
+    if (epoch == 0)
+    {
+        return 0;
+    }
+    return (uint64_t)epoch * 1000 + (uint32_t)((uint32_t)Hal::millis() - millisAt);
+}
+
+uint32_t ClockService::epochSeconds()
+{
+    return (uint32_t)(epochMs() / 1000);
+}
+
+void ClockService::timestamp(char *buffer, size_t size)
+{
+    format(epochSeconds(), buffer, size);
+}
+
+void ClockService::format(uint32_t epochSeconds, char *buffer, size_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    if (epochSeconds < MIN_VALID_EPOCH)
+    {
+        buffer[0] = '\0';
+        return;
+    }
+
+    if (cacheLock.test_and_set(std::memory_order_acquire))
+    {
+        PayloadSerializer::formatTimestamp(epochSeconds, buffer, size);
+        return;
+    }
+
+    if (cachedSecond != epochSeconds)
+    {
+        PayloadSerializer::formatTimestamp(epochSeconds, cachedText, sizeof(cachedText));
+        cachedSecond = epochSeconds;
+        stats.formatted++;
+    }
+    else
+    {
+        stats.reused++;
+    }
+    strncpy(buffer, cachedText, size - 1);
+    buffer[size - 1] = '\0';
+    cacheLock.clear(std::memory_order_release);
+}
+
+ClockStats ClockService::getStats()
+{
+    return stats;
+}
+
+void ClockService::printStats()
+{
+    Serial.printf("[CLOCK] synced: %s, syncs: %lu, timestamps formatted: %lu, reused: %lu\n",
+                  isSynced() ? "yes" : "no", (unsigned long)stats.syncs,
+                  (unsigned long)stats.formatted, (unsigned long)stats.reused);
+}
@@ -0,0 +1,63 @@
+#ifndef CLOCKSERVICE_H
+#define CLOCKSERVICE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Hal.h"
+
+struct ClockStats
+{
+    uint32_t syncs;       // update() calls that saw a valid wall clock
+    uint32_t formatted;   // timestamps rendered by strftime
+    uint32_t reused;      // timestamps served from the cached second
+};
+
+// Wall-clock time shared by every module.
+//
+// SNTP runs in the background (begin() returns at once). update() captures
+// the system time against the monotonic Hal::millis() clock, so epochMs() is
+// a subtraction and an add, safe to call from either core. ISO-8601 text is
+// rendered once per second into a cache and copied out to the caller;
+// encoders that carry binary time use epochMs()/epochSeconds() instead.
+// Until the first sync every time reads as 0 and every timestamp as "".
+class ClockService
+{
+public:
+    // "2024-01-01T00:00:00Z" plus terminator, with room to spare
+    static const size_t TIMESTAMP_SIZE = 25;
+    // Anything earlier means SNTP has not set the clock yet
+    static const uint32_t MIN_VALID_EPOCH = 1609459200;   // 2021-01-01
+
+    static void begin(const char *server1, const char *server2 = nullptr);
+    // Refreshes the monotonic-to-epoch offset; call periodically from one task
+    static void update();
+
+    static bool isSynced();
+    static uint64_t epochMs();
+    static uint32_t epochSeconds();
+
+    // Current time as the backend's ISO-8601 text (UTC+8)
+    static void timestamp(char *buffer, size_t size);
+    // Same for any epoch; the cached second is not formatted again
+    static void format(uint32_t epochSeconds, char *buffer, size_t size);
+
+    static ClockStats getStats();
+    static void printStats();
+
+private:
+    // Offset published by update() under a sequence lock (single writer)
+    static std::atomic<uint32_t> sequence;
+    static std::atomic<uint32_t> baseEpoch;
+    static std::atomic<uint32_t> baseMillis;
+
+    // Last formatted second; taken with a try-lock, a contended caller
+    // formats into its own buffer instead of waiting
+    static std::atomic_flag cacheLock;
+    static uint32_t cachedSecond;
+    static char cachedText[TIMESTAMP_SIZE];
+    static ClockStats stats;
+
+    static void readBase(uint32_t &epoch, uint32_t &millisAt);
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "DeltaReporter.h"
+
+// Roughly the sensor noise after AnalogFilter, so a steady zone sends only keyframes
+const DeltaReporter::Config DeltaReporter::DEFAULT_CONFIG = {
+    {0.3f, 0.0f},     // temperature
+    {1.0f, 0.0f},     // humidity
+    {50.0f, 0.1f},    // light
+    {50.0f, 0.05f},   // air quality
+    {40.0f, 0.0f},    // soil, about 1.5 % moisture
+    900000            // keyframe every 15 min
+};
+
+DeltaReporter::DeltaReporter(const Config &config)
+{
+    configure(config);
+    haveKeyframe = false;
+    lastKeyframeAt = 0;
+    memset(&lastSent, 0, sizeof(lastSent));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void DeltaReporter::configure(const Config &config)
+{
+    this->config = config;
+}
+
+bool DeltaReporter::changed(float value, float last, const Deadband &band)
+{
+    if (isnan(value) || isnan(last))
+    {
+        // Appearing or disappearing counts as a change
+        return isnan(value) != isnan(last);
+    }
+    float threshold = band.relative * fabsf(last);
+    if (threshold < band.absolute)
+    {
+        threshold = band.absolute;
+    }
+    return fabsf(value - last) > threshold;
+}
+
+int DeltaReporter::countValues(const ZoneSample &sample)
+{
+    int count = 0;
+    uint16_t present = sample.present & ZoneSample::ALL_FIELDS;
+    while (present)
+    {
+        count += present & 1;
+        present >>= 1;
+    }
+    return count;
+}
+
+void DeltaReporter::track(float value, float &last, const Deadband &band, uint16_t field, uint16_t &present)
+{
+    if (changed(value, last, band))
+    {
+        last = value;
+        present |= field;
+    }
+}
+
+bool DeltaReporter::filter(ZoneSample &sample)
+{
+    stats.samples++;
+    stats.valuesIn += 4 + sample.soilCount;
+
+    bool samePins = haveKeyframe && sample.soilCount == lastSent.soilCount &&
+                    memcmp(sample.soilPins, lastSent.soilPins, sample.soilCount) == 0;
+    if (!samePins || sample.takenAtMs - lastKeyframeAt >= config.keyframeIntervalMs)
+    {
+        sample.present = ZoneSample::ALL_FIELDS;
+        sample.keyframe = true;
+        lastSent = sample;
+        haveKeyframe = true;
+        lastKeyframeAt = sample.takenAtMs;
+        stats.keyframes++;
+        stats.valuesOut += 4 + sample.soilCount;
+        return true;
+    }
+
+    uint16_t present = 0;
+    track(sample.temperature, lastSent.temperature, config.temperature, ZoneSample::HAS_TEMPERATURE, present);
+    track(sample.humidity, lastSent.humidity, config.humidity, ZoneSample::HAS_HUMIDITY, present);
+    track(sample.light, lastSent.light, config.light, ZoneSample::HAS_LIGHT, present);
+    track(sample.airQuality, lastSent.airQuality, config.airQuality, ZoneSample::HAS_AIR_QUALITY, present);
+    for (int i = 0; i < sample.soilCount; i++)
+    {
+        track(sample.soilMoisture[i], lastSent.soilMoisture[i], config.soil, 1 << (ZoneSample::SOIL_SHIFT + i), present);
+    }
+
+    sample.present = present;
+    sample.keyframe = false;
+    if (present == 0)
+    {
+        stats.suppressed++;
+        return false;
+    }
+    stats.deltas++;
+    stats.valuesOut += countValues(sample);
+    return true;
+}
+
+void DeltaReporter::forceKeyframe()
+{
+    haveKeyframe = false;
+}
+
+const DeltaStats &DeltaReporter::getStats() const
+{
+    return stats;
+}
+
+void DeltaReporter::printStats()
+{
+    unsigned long saved = stats.valuesIn > 0 ? 100UL * (stats.valuesIn - stats.valuesOut) / stats.valuesIn : 0;
+    Serial.printf("[DELTA] samples: %lu, keyframes: %lu, deltas: %lu, suppressed: %lu, values %lu -> %lu (-%lu%%)\n",
+                  (unsigned long)stats.samples, (unsigned long)stats.keyframes, (unsigned long)stats.deltas,
+                  (unsigned long)stats.suppressed, (unsigned long)stats.valuesIn, (unsigned long)stats.valuesOut, saved);
+}
@@ -0,0 +1,71 @@
+#ifndef DELTAREPORTER_H
+#define DELTAREPORTER_H
+
+#include <Arduino.h>
+#include "TelemetryBuffer.h"
+
+struct DeltaStats
+{
+    uint32_t samples;
+    uint32_t keyframes;
+    uint32_t deltas;
+    uint32_t suppressed;     // nothing changed, not sent at all
+    uint32_t valuesIn;       // readings offered
+    uint32_t valuesOut;      // readings left to send
+};
+
+// Change detection in front of the upload. A reading is sent when it moved
+// past its deadband since the value last sent for it; the others are left
+// out of the sample (ZoneSample::present) and a sample with nothing left is
+// dropped. Every keyframeIntervalMs, and whenever the soil pin set changes,
+// a full keyframe goes out so the backend can rebuild the state by carrying
+// each reading forward from the last keyframe.
+//
+// Only the mask is changed: the sample keeps all its values, so a sample
+// that ends up in the offline queue is still complete.
+class DeltaReporter
+{
+public:
+    // A change counts once |value - last sent| > max(absolute, relative * |last sent|)
+    struct Deadband
+    {
+        float absolute;
+        float relative;
+    };
+
+    struct Config
+    {
+        Deadband temperature;   // °C
+        Deadband humidity;      // %
+        Deadband light;         // ADC counts
+        Deadband airQuality;    // ADC counts
+        Deadband soil;          // raw ADC counts
+        uint32_t keyframeIntervalMs;
+    };
+
+    static const Config DEFAULT_CONFIG;
+
+    explicit DeltaReporter(const Config &config = DEFAULT_CONFIG);
+
+    void configure(const Config &config);
+    // Reduces sample to its changed readings; false when it need not be sent
+    bool filter(ZoneSample &sample);
+    // The next sample goes out in full
+    void forceKeyframe();
+
+    const DeltaStats &getStats() const;
+    void printStats();
+
+private:
+    Config config;
+    bool haveKeyframe;
+    uint32_t lastKeyframeAt;
+    ZoneSample lastSent;
+    DeltaStats stats;
+
+    static bool changed(float value, float last, const Deadband &band);
+    static int countValues(const ZoneSample &sample);
+    void track(float value, float &last, const Deadband &band, uint16_t field, uint16_t &present);
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "Hal.h"
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_app_desc.h>
+#include <esp_memory_utils.h>
+#else
+#include <esp_ota_ops.h>
+#include <soc/soc_memory_layout.h>
+#endif
+
+// ESP32 implementation: straight calls into the Arduino core
+
+unsigned long Hal::millis()
+{
+    return ::millis();
+}
+
+unsigned long Hal::micros()
+{
+    return ::micros();
+}
+
+void Hal::pinMode(uint8_t pin, uint8_t mode)
+{
+    ::pinMode(pin, mode);
+}
+
+void Hal::digitalWrite(uint8_t pin, uint8_t value)
+{
+    ::digitalWrite(pin, value);
+}
+
+int Hal::digitalRead(uint8_t pin)
+{
+    return ::digitalRead(pin);
+}
+
+uint16_t Hal::analogRead(uint8_t pin)
+{
+    return ::analogRead(pin);
+}
+
+void Hal::imageId(uint8_t *id, size_t size)
+{
+#if ESP_IDF_VERSION_MAJOR >= 5
+    const esp_app_desc_t *app = esp_app_get_description();
+#else
+    const esp_app_desc_t *app = esp_ota_get_app_description();
+#endif
+    memcpy(id, app->app_elf_sha256, min(size, sizeof(app->app_elf_sha256)));
+}
+
+bool Hal::isRodata(const void *address)
+{
+    return esp_ptr_in_drom(address);
+}
@@ -0,0 +1,32 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <Arduino.h>
+
+// Hardware access used by the G6 modules (GPIO, ADC, clock, firmware image).
+//
+// The modules call these instead of the Arduino core directly, so the core
+// is only referenced from Hal.cpp. A build for another target (a host
+// simulation with a virtual clock and scripted inputs) replaces Hal.cpp and
+// leaves the modules untouched. The signatures mirror the Arduino functions
+// so they can be passed where a ClockSource or AnalogReader is expected.
+class Hal
+{
+public:
+    static unsigned long millis();
+    static unsigned long micros();
+
+    static void pinMode(uint8_t pin, uint8_t mode);
+    static void digitalWrite(uint8_t pin, uint8_t value);
+    static int digitalRead(uint8_t pin);
+    static uint16_t analogRead(uint8_t pin);
+
+    // Leading bytes of the running image's ELF SHA-256, same for every boot
+    // of one build and different after an OTA or reflash
+    static void imageId(uint8_t *id, size_t size);
+    // True if address lies in the image's flash-mapped read-only data, where
+    // string literals live
+    static bool isRodata(const void *address);
+};
+
+#endif
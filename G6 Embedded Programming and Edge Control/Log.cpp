@@ -0,0 +1,328 @@
+#include "Log.h"
+
+// Record: [length][level][millis, 4 bytes][format address, 4 bytes on the ESP32]
+// then per argument a tag byte and 4 bytes, or for strings a length byte and the text
+static const size_t RECORD_HEADER = 6 + sizeof(const char *);
+static const uint32_t RING_MAGIC = 0x4C4F4732;   // "LOG2", the layout with the image id
+static const size_t IMAGE_ID_SIZE = 8;
+
+struct LogRing
+{
+    uint32_t magic;
+    uint8_t image[IMAGE_ID_SIZE];   // firmware that wrote the records
+    uint32_t head;       // bytes ever written
+    uint32_t tail;       // bytes ever drained
+    uint32_t dropped;
+    uint8_t data[Logger::RING_SIZE];
+};
+
+// Not cleared by a panic or watchdog reset, only by a power cycle
+RTC_NOINIT_ATTR static LogRing ring;
+static portMUX_TYPE ringLock = portMUX_INITIALIZER_UNLOCKED;
+
+void Logger::begin(Print &out)
+{
+    uint8_t image[IMAGE_ID_SIZE];
+    Hal::imageId(image, sizeof(image));
+    uint32_t pending = ring.head - ring.tail;
+    if (ring.magic == RING_MAGIC && pending > 0 && pending <= RING_SIZE)
+    {
+        if (memcmp(ring.image, image, sizeof(image)) == 0)
+        {
+            out.printf("--- %lu bytes of log left from before the reset ---\n", (unsigned long)pending);
+            while (drain(out) > 0)
+            {
+            }
+            out.println("--- end of previous log ---");
+            return;
+        }
+
+        // Written by another image (OTA, reflash): its format addresses point
+        // into that firmware, so only its ELF can decode the records
+        out.printf("--- %lu bytes of log left by image ", (unsigned long)pending);
+        for (size_t i = 0; i < IMAGE_ID_SIZE; i++)
+        {
+            out.printf("%02x", ring.image[i]);
+        }
+        out.println(", decode with its ELF ---");
+        dumpRaw(out);
+    }
+    ring.magic = RING_MAGIC;
+    memcpy(ring.image, image, sizeof(image));
+    ring.head = 0;
+    ring.tail = 0;
+    ring.dropped = 0;
+}
+
+size_t Logger::beginRecord(uint8_t *record, uint8_t level, const char *format)
+{
+    uint32_t now = Hal::millis();
+    record[0] = 0;
+    record[1] = level;
+    memcpy(record + 2, &now, sizeof(now));
+    memcpy(record + 6, &format, sizeof(format));
+    return RECORD_HEADER;
+}
+
+void Logger::put(uint8_t *record, size_t &length, uint8_t tag, const void *value, size_t size)
+{
+    // Arguments that do not fit are left out; the text shows "?" for them
+    if (length + 1 + size > MAX_RECORD)
+    {
+        return;
+    }
+    record[length++] = tag;
+    memcpy(record + length, value, size);
+    length += size;
+}
+
+void Logger::encodeArg(uint8_t *record, size_t &length, int value)
+{
+    int32_t v = value;
+    put(record, length, ARG_INT, &v, sizeof(v));
+}
+
+void Logger::encodeArg(uint8_t *record, size_t &length, long value)
+{
+    int32_t v = (int32_t)value;
+    put(record, length, ARG_INT, &v, sizeof(v));
+}
+
+void Logger::encodeArg(uint8_t *record, size_t &length, unsigned int value)
+{
+    uint32_t v = value;
+    put(record, length, ARG_UINT, &v, sizeof(v));
+}
+
+void Logger::encodeArg(uint8_t *record, size_t &length, unsigned long value)
+{
+    uint32_t v = (uint32_t)value;
+    put(record, length, ARG_UINT, &v, sizeof(v));
+}
+
+void Logger::encodeArg(uint8_t *record, size_t &length, bool value)
+{
+    uint32_t v = value ? 1 : 0;
+    put(record, length, ARG_UINT, &v, sizeof(v));
+}
+
+void Logger::encodeArg(uint8_t *record, size_t &length, double value)
+{
+    float v = (float)value;
+    put(record, length, ARG_FLOAT, &v, sizeof(v));
+}
+
+void Logger::encodeArg(uint8_t *record, size_t &length, const char *value)
+{
+    if (value == nullptr)
+    {
+        value = "(null)";
+    }
+    size_t size = strnlen(value, MAX_STRING);
+    if (length + 2 + size > MAX_RECORD)
+    {
+        return;
+    }
+    record[length++] = ARG_STRING;
+    record[length++] = (uint8_t)size;
+    memcpy(record + length, value, size);
+    length += size;
+}
+
+void Logger::encodeArg(uint8_t *record, size_t &length, const String &value)
+{
+    encodeArg(record, length, value.c_str());
+}
+
+void Logger::commit(uint8_t *record, size_t length)
+{
+    record[0] = (uint8_t)length;
+    portENTER_CRITICAL(&ringLock);
+    if (RING_SIZE - (ring.head - ring.tail) < length)
+    {
+        ring.dropped++;
+    }
+    else
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            ring.data[(ring.head + i) % RING_SIZE] = record[i];
+        }
+        ring.head += length;
+    }
+    portEXIT_CRITICAL(&ringLock);
+}
+
+size_t Logger::read(uint8_t *record)
+{
+    size_t length = 0;
+    portENTER_CRITICAL(&ringLock);
+    uint32_t pending = ring.head - ring.tail;
+    if (pending > 0)
+    {
+        length = ring.data[ring.tail % RING_SIZE];
+        if (length < RECORD_HEADER || length > MAX_RECORD || length > pending)
+        {
+            // Damaged ring (e.g. garbage after a power cycle): start over
+            ring.tail = ring.head;
+            length = 0;
+        }
+        else
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                record[i] = ring.data[(ring.tail + i) % RING_SIZE];
+            }
+            ring.tail += length;
+        }
+    }
+    portEXIT_CRITICAL(&ringLock);
+    return length;
+}
+
+void Logger::format(Print &out, const uint8_t *record, size_t length)
+{
+    static const char LEVELS[] = "?EWID";
+    uint32_t at;
+    const char *f;
+    memcpy(&at, record + 2, sizeof(at));
+    memcpy(&f, record + 6, sizeof(f));
+    const uint8_t *arg = record + RECORD_HEADER;
+    const uint8_t *end = record + length;
+
+    char text[64];
+    snprintf(text, sizeof(text), "[%c %lu] ", LEVELS[record[1] < 5 ? record[1] : 0], (unsigned long)at);
+    out.print(text);
+
+    // A damaged record must not send us reading through a wild pointer
+    if (!Hal::isRodata(f))
+    {
+        out.printf("<format %p not in rodata>\n", (const void *)f);
+        return;
+    }
+
+    while (*f)
+    {
+        const char *next = strchr(f, '%');
+        if (next == nullptr)
+        {
+            out.print(f);
+            break;
+        }
+        out.write((const uint8_t *)f, next - f);
+        f = next + 1;
+        if (*f == '%')
+        {
+            out.write('%');
+            f++;
+            continue;
+        }
+
+        // Rebuild the conversion without length modifiers, sized for the stored argument
+        char spec[16] = "%";
+        size_t n = 1;
+        while (*f && strchr("-+ #0123456789.", *f) && n < sizeof(spec) - 3)
+        {
+            spec[n++] = *f++;
+        }
+        while (*f && strchr("hlzjtL", *f))
+        {
+            f++;
+        }
+        char conversion = *f ? *f++ : 's';
+
+        if (arg >= end)
+        {
+            out.write('?');
+            continue;
+        }
+
+        uint8_t tag = *arg++;
+        if (tag == ARG_STRING)
+        {
+            char value[MAX_STRING + 1];
+            uint8_t size = *arg++;
+            memcpy(value, arg, size);
+            value[size] = '\0';
+            arg += size;
+            spec[n++] = 's';
+            snprintf(text, sizeof(text), spec, value);
+            out.print(text);
+            continue;
+        }
+
+        uint32_t raw;
+        memcpy(&raw, arg, sizeof(raw));
+        arg += sizeof(raw);
+        float asFloat;
+        memcpy(&asFloat, &raw, sizeof(asFloat));
+        double number = tag == ARG_FLOAT ? asFloat : tag == ARG_INT ? (double)(int32_t)raw : (double)raw;
+
+        if (strchr("fFeEgG", conversion))
+        {
+            spec[n++] = conversion;
+            snprintf(text, sizeof(text), spec, number);
+        }
+        else if (conversion == 'c')
+        {
+            spec[n++] = 'c';
+            snprintf(text, sizeof(text), spec, (int)raw);
+        }
+        else if (conversion == 'd' || conversion == 'i')
+        {
+            spec[n++] = 'l';
+            spec[n++] = 'd';
+            snprintf(text, sizeof(text), spec, tag == ARG_FLOAT ? (long)asFloat : (long)(int32_t)raw);
+        }
+        else
+        {
+            // u, x, X, o and anything unexpected
+            spec[n++] = 'l';
+            spec[n++] = strchr("uxXo", conversion) ? conversion : 'u';
+            snprintf(text, sizeof(text), spec, tag == ARG_FLOAT ? (unsigned long)asFloat : (unsigned long)raw);
+        }
+        out.print(text);
+    }
+    out.println();
+}
+
+int Logger::drain(Print &out, int maxRecords)
+{
+    uint8_t record[MAX_RECORD];
+    int drained = 0;
+    while (drained < maxRecords)
+    {
+        size_t length = read(record);
+        if (length == 0)
+        {
+            break;
+        }
+        format(out, record, length);
+        drained++;
+    }
+    return drained;
+}
+
+void Logger::dumpRaw(Print &out)
+{
+    // Meant for quiet moments (boot, a debug command); does not lock the ring
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    out.print("LOGDUMP ");
+    for (uint32_t i = ring.tail; i != ring.head; i++)
+    {
+        uint8_t b = ring.data[i % RING_SIZE];
+        out.write(HEX_DIGITS[b >> 4]);
+        out.write(HEX_DIGITS[b & 0x0F]);
+    }
+    out.println();
+}
+
+uint32_t Logger::getDropped()
+{
+    return ring.dropped;
+}
+
+size_t Logger::getPending()
+{
+    return ring.head - ring.tail;
+}
@@ -0,0 +1,121 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Messages above this level are removed by the preprocessor, arguments
+// included. Override with -DLOG_LEVEL=LOG_LEVEL_DEBUG (or _NONE).
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Deferred logging. A call stores a binary record (format string address,
+// timestamp, raw arguments) in a RAM ring and returns; Logger::drain()
+// turns records into text later, from a low-priority task. Nothing is
+// formatted or allocated on the caller's path and Serial never blocks it.
+//
+// The ring lives in RTC memory that survives a panic or watchdog reset, so
+// records that were never drained are printed by begin() after the restart.
+// The ring remembers which firmware image wrote it: records left by another
+// image (after an OTA) are not formatted but dumped with dumpRaw(), as hex
+// for tools/decode_log.py, which resolves the format addresses from that
+// image's ELF. A format address outside rodata is never dereferenced.
+//
+// Arguments: integers up to 32 bits, float/double (sent as float), bool,
+// const char * and String. Strings are copied, cut to MAX_STRING bytes.
+// Length modifiers in the format (%lu, %ld) are accepted and ignored.
+class Logger
+{
+public:
+    static const size_t RING_SIZE = 2048;
+    static const uint8_t MAX_RECORD = 96;
+    static const uint8_t MAX_STRING = 32;
+
+    // Call once at boot, before the first log call
+    static void begin(Print &out);
+
+    template <typename... Args>
+    static void log(uint8_t level, const char *format, const Args &...args)
+    {
+        uint8_t record[MAX_RECORD];
+        size_t length = beginRecord(record, level, format);
+        encode(record, length, args...);
+        commit(record, length);
+    }
+
+    // Formats up to maxRecords pending records to out, returns how many
+    static int drain(Print &out, int maxRecords = 16);
+    // Pending records as one hex line, without consuming them
+    static void dumpRaw(Print &out);
+
+    static uint32_t getDropped();
+    static size_t getPending();
+
+private:
+    enum ArgTag : uint8_t
+    {
+        ARG_INT = 'i',
+        ARG_UINT = 'u',
+        ARG_FLOAT = 'f',
+        ARG_STRING = 's'
+    };
+
+    static size_t beginRecord(uint8_t *record, uint8_t level, const char *format);
+    static void commit(uint8_t *record, size_t length);
+    static void put(uint8_t *record, size_t &length, uint8_t tag, const void *value, size_t size);
+    static size_t read(uint8_t *record);
+    static void format(Print &out, const uint8_t *record, size_t length);
+
+    static void encode(uint8_t *, size_t &)
+    {
+    }
+
+    template <typename T, typename... Rest>
+    static void encode(uint8_t *record, size_t &length, const T &value, const Rest &...rest)
+    {
+        encodeArg(record, length, value);
+        encode(record, length, rest...);
+    }
+
+    static void encodeArg(uint8_t *record, size_t &length, int value);
+    static void encodeArg(uint8_t *record, size_t &length, long value);
+    static void encodeArg(uint8_t *record, size_t &length, unsigned int value);
+    static void encodeArg(uint8_t *record, size_t &length, unsigned long value);
+    static void encodeArg(uint8_t *record, size_t &length, bool value);
+    static void encodeArg(uint8_t *record, size_t &length, double value);
+    static void encodeArg(uint8_t *record, size_t &length, const char *value);
+    static void encodeArg(uint8_t *record, size_t &length, const String &value);
+};
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::log(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) Logger::log(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::log(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::log(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#endif
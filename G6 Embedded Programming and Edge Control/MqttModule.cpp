@@ -1,29 +1,152 @@
 #include "MqttModule.h"
+#include <WiFi.h>
 
-void MqttModule::connectToMqtt(Adafruit_MQTT_Client& mqtt) 
+MqttModule::MqttModule(Adafruit_MQTT_Client& mqtt, ClockSource clock, LinkCheck linkUp)
+  : mqtt(mqtt), clock(clock), linkUp(linkUp)
 {
-  Serial.print("Connecting to MQTT...");
+  state = WAITING_FOR_WIFI;
+  backoffMs = MIN_BACKOFF_MS;
+  nextAttemptAt = 0;
+  lastPingAt = 0;
+  disconnectedSince = clock();
+  memset(&stats, 0, sizeof(stats));
+}
 
-  int8_t connection;
-  int8_t retries = 0;
+bool MqttModule::wifiConnected()
+{
+  return WiFi.status() == WL_CONNECTED;
+}
 
-  // Attempt to connect up to 5 times
-  while ((connection = mqtt.connect()) != 0) 
-  {
-    Serial.print("Error: ");
-    Serial.println(mqtt.connectErrorString(connection));
+bool MqttModule::update()
+{
+  unsigned long now = clock();
 
-    retries++;
-    if (retries >= 5) 
+  if (!linkUp())
+  {
+    if (state == CONNECTED)
     {
-      Serial.println("Failed to connect after 5 attempts. Restarting...");
+      linkLost(now);
+    }
+    if (state != WAITING_FOR_WIFI)
+    {
+      Serial.println("MQTT: WiFi down, pausing reconnects");
+    }
+    state = WAITING_FOR_WIFI;
+    return false;
+  }
 
-      // Blocking alternative for platforms that don't support restart
-      while (true); 
+  switch (state)
+  {
+    case WAITING_FOR_WIFI:
+      // Fresh WiFi link: try straight away
+      state = BACKING_OFF;
+      backoffMs = MIN_BACKOFF_MS;
+      nextAttemptAt = now;
+      // fall through
+    case BACKING_OFF:
+      if ((long)(now - nextAttemptAt) >= 0)
+      {
+        attempt();
+      }
+      break;
+
+    case CONNECTED:
+      if (!mqtt.connected())
+      {
+        linkLost(now);
+        break;
+      }
+      if (now - lastPingAt >= PING_INTERVAL_MS)
+      {
+        lastPingAt = now;
+        if (!mqtt.ping())
+        {
+          linkLost(now);
+        }
+      }
+      break;
+  }
+  return state == CONNECTED;
+}
+
+void MqttModule::attempt()
+{
+  stats.attempts++;
+  int8_t result = mqtt.connect();
+  unsigned long now = clock();
+
+  if (result == 0)
+  {
+    uint32_t outage = now - disconnectedSince;
+    stats.connects++;
+    stats.lastReconnectMs = outage;
+    if (outage > stats.maxReconnectMs)
+    {
+      stats.maxReconnectMs = outage;
     }
+    stats.disconnectedMs += outage;
+    state = CONNECTED;
+    backoffMs = MIN_BACKOFF_MS;
+    lastPingAt = now;
+    Serial.printf("MQTT: connected after %lu ms (attempt %lu)\n",
+                  (unsigned long)outage, (unsigned long)stats.attempts);
+    return;
+  }
+
+  Serial.print("MQTT: connect failed: ");
+  Serial.println(mqtt.connectErrorString(result));
+  mqtt.disconnect();
+
+  uint32_t delayMs = jittered(backoffMs);
+  nextAttemptAt = now + delayMs;
+  Serial.printf("MQTT: next attempt in %lu ms\n", (unsigned long)delayMs);
+  backoffMs = backoffMs >= MAX_BACKOFF_MS / 2 ? MAX_BACKOFF_MS : backoffMs * 2;
+}
+
+void MqttModule::linkLost(unsigned long now)
+{
+  Serial.println("MQTT: connection lost");
+  mqtt.disconnect();
+  stats.disconnects++;
+  disconnectedSince = now;
+  state = BACKING_OFF;
+  backoffMs = MIN_BACKOFF_MS;
+  nextAttemptAt = now + jittered(backoffMs);
+}
+
+uint32_t MqttModule::jittered(uint32_t delayMs)
+{
+  // Uniform in [0.75, 1.25] x delay
+  uint32_t spread = delayMs / 2;
+  return delayMs - spread / 2 + (uint32_t)random(spread + 1);
+}
 
-    delay(2000); // Wait before retry
+bool MqttModule::isConnected() const
+{
+  return state == CONNECTED;
+}
+
+MqttModule::State MqttModule::getState() const
+{
+  return state;
+}
+
+MqttStats MqttModule::getStats() const
+{
+  MqttStats current = stats;
+  if (state != CONNECTED)
+  {
+    current.disconnectedMs += clock() - disconnectedSince;
   }
+  return current;
+}
 
-  Serial.println("Connected to MQTT!");
-}
\ No newline at end of file
+void MqttModule::printStats()
+{
+  MqttStats current = getStats();
+  Serial.printf("[MQTT] state: %s, attempts: %lu, connects: %lu, drops: %lu, reconnect ms last/max: %lu/%lu, disconnected s: %lu\n",
+                state == CONNECTED ? "up" : state == BACKING_OFF ? "backoff" : "no wifi",
+                (unsigned long)current.attempts, (unsigned long)current.connects, (unsigned long)current.disconnects,
+                (unsigned long)current.lastReconnectMs, (unsigned long)current.maxReconnectMs,
+                (unsigned long)(current.disconnectedMs / 1000));
+}
@@ -5,11 +5,72 @@
 #include <Adafruit_MQTT_Client.h>
 #include <ArduinoJson.h>
 #include <Arduino.h>
+#include "Hal.h"
 
+// Connection counters; times are in ms
+struct MqttStats
+{
+  uint32_t attempts;           // connect() calls
+  uint32_t connects;           // successful ones
+  uint32_t disconnects;        // links lost after being up
+  uint32_t lastReconnectMs;    // link lost -> link up again, last outage
+  uint32_t maxReconnectMs;
+  uint32_t disconnectedMs;     // total time without a link, current outage included
+};
+
+// MQTT connection state machine, stepped from a scheduler task.
+//
+// update() does at most one connect() per call and only once the backoff has
+// expired, so the caller is never held up for more than one attempt. Failed
+// attempts back off exponentially from MIN_BACKOFF_MS to MAX_BACKOFF_MS with
+// +/-25 % jitter so a fleet does not reconnect in lockstep. Nothing is tried
+// while WiFi is down. Adafruit_MQTT re-sends every registered subscription
+// inside connect(), so subscriptions survive a reconnect.
 class MqttModule 
 {
   public:
-  static void connectToMqtt(Adafruit_MQTT_Client& mqtt);
+  enum State : uint8_t
+  {
+    WAITING_FOR_WIFI,
+    BACKING_OFF,
+    CONNECTED
+  };
+
+  typedef unsigned long (*ClockSource)();
+  typedef bool (*LinkCheck)();
+
+  static const uint32_t MIN_BACKOFF_MS = 1000;
+  static const uint32_t MAX_BACKOFF_MS = 60000;
+  // Well inside the 300 s keepalive of Adafruit_MQTT
+  static const uint32_t PING_INTERVAL_MS = 60000;
+
+  explicit MqttModule(Adafruit_MQTT_Client& mqtt, ClockSource clock = Hal::millis, LinkCheck linkUp = wifiConnected);
+
+  // Advances the state machine; returns true while the broker link is up
+  bool update();
+  bool isConnected() const;
+  State getState() const;
+
+  MqttStats getStats() const;
+  void printStats();
+
+  static bool wifiConnected();
+
+  private:
+  Adafruit_MQTT_Client& mqtt;
+  ClockSource clock;
+  LinkCheck linkUp;
+
+  State state;
+  uint32_t backoffMs;
+  unsigned long nextAttemptAt;
+  unsigned long lastPingAt;
+  unsigned long disconnectedSince;
+  MqttStats stats;
+
+  void attempt();
+  void linkLost(unsigned long now);
+  uint32_t jittered(uint32_t delayMs);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,63 @@
+#include "MqttTelemetry.h"
+
+MqttTelemetry::MqttTelemetry(Adafruit_MQTT &mqtt, const char *topicPrefix, const String &zoneId, PayloadFormat format)
+    : mqtt(mqtt), zoneId(zoneId), format(format)
+{
+    snprintf(topic, sizeof(topic), "%s%s", topicPrefix, zoneId.c_str());
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool MqttTelemetry::publish(const ZoneSample &sample, const String &userId)
+{
+    BufferPrint out(message, sizeof(message));
+    if (PayloadSerializer::sensorBatch(out, zoneId, &sample, 1, userId, format) != 1)
+    {
+        stats.oversized++;
+        return false;
+    }
+
+    // Fixed header, topic length and topic share the client's packet buffer
+    size_t packetSize = out.length() + strlen(topic) + 5;
+    if (packetSize > MAXBUFFERSIZE)
+    {
+        stats.oversized++;
+        return false;
+    }
+
+    PROFILE_SCOPE(PHASE_MQTT_PUBLISH);
+    unsigned long start = micros();
+    bool ok = mqtt.publish(topic, (uint8_t *)message, (uint16_t)out.length(), 0);
+    uint32_t elapsed = micros() - start;
+
+    if (!ok)
+    {
+        stats.failed++;
+        return false;
+    }
+    stats.published++;
+    stats.bytesSent += out.length();
+    stats.lastSendUs = elapsed;
+    if (elapsed > stats.maxSendUs)
+    {
+        stats.maxSendUs = elapsed;
+    }
+    return true;
+}
+
+const char *MqttTelemetry::getTopic() const
+{
+    return topic;
+}
+
+const MqttTelemetryStats &MqttTelemetry::getStats() const
+{
+    return stats;
+}
+
+void MqttTelemetry::printStats()
+{
+    Serial.printf("[MQTT-TLM] %s published: %lu, failed: %lu, oversized: %lu, bytes: %lu, send us last/max: %lu/%lu\n",
+                  topic, (unsigned long)stats.published, (unsigned long)stats.failed,
+                  (unsigned long)stats.oversized, (unsigned long)stats.bytesSent,
+                  (unsigned long)stats.lastSendUs, (unsigned long)stats.maxSendUs);
+}
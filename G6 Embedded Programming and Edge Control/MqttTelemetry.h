@@ -0,0 +1,49 @@
+#ifndef MQTTTELEMETRY_H
+#define MQTTTELEMETRY_H
+
+#include <Arduino.h>
+#include <Adafruit_MQTT.h>
+#include "PayloadSerializer.h"
+#include "TelemetryBuffer.h"
+#include "Profiler.h"
+
+struct MqttTelemetryStats
+{
+    uint32_t published;
+    uint32_t failed;         // publish() refused or socket write failed
+    uint32_t oversized;      // did not fit one MQTT packet
+    uint32_t bytesSent;      // payload bytes
+    uint32_t lastSendUs;
+    uint32_t maxSendUs;
+};
+
+// Publishes zone samples on the MQTT session the node already keeps open,
+// one message per sample on the zone's own topic, in the same encoding as
+// the REST batches (a batch of one). Publishes use QoS 0: a QoS 1 publish
+// in Adafruit_MQTT waits for the PUBACK and can swallow an incoming command
+// while it does. A false return leaves the sample with the caller, which
+// falls back to the REST upload path.
+class MqttTelemetry
+{
+public:
+    static const size_t TOPIC_CAPACITY = 64;
+    static const size_t MESSAGE_CAPACITY = 256;
+
+    MqttTelemetry(Adafruit_MQTT &mqtt, const char *topicPrefix, const String &zoneId, PayloadFormat format = FORMAT_CBOR);
+
+    bool publish(const ZoneSample &sample, const String &userId);
+
+    const char *getTopic() const;
+    const MqttTelemetryStats &getStats() const;
+    void printStats();
+
+private:
+    Adafruit_MQTT &mqtt;
+    String zoneId;
+    PayloadFormat format;
+    char topic[TOPIC_CAPACITY];
+    char message[MESSAGE_CAPACITY];
+    MqttTelemetryStats stats;
+};
+
+#endif
@@ -0,0 +1,388 @@
+#include "OfflineQueue.h"
+#include "Log.h"
+
+static const uint8_t RECORD_MAGIC = 0xA5;
+
+OfflineQueue::OfflineQueue(fs::FS &fs, const char *dir, uint32_t maxRecords)
+    : fs(fs), dir(dir)
+{
+    maxSegments = (maxRecords + RECORDS_PER_SEGMENT - 1) / RECORDS_PER_SEGMENT;
+    if (maxSegments < 2)
+    {
+        maxSegments = 2;
+    }
+    ready = false;
+    tailSeq = 0;
+    headSeq = 0;
+    tailOffset = 0;
+    headCount = 0;
+    count = 0;
+    evicted = 0;
+    corrupt = 0;
+}
+
+String OfflineQueue::segmentPath(uint32_t seq) const
+{
+    return dir + "/" + String(seq) + ".seg";
+}
+
+String OfflineQueue::cursorPath() const
+{
+    return dir + "/cursor";
+}
+
+uint16_t OfflineQueue::recordsIn(uint32_t seq)
+{
+    File file = fs.open(segmentPath(seq), "r");
+    if (!file)
+    {
+        return 0;
+    }
+    uint16_t records = file.size() / sizeof(QueuedSample);
+    file.close();
+    return records;
+}
+
+bool OfflineQueue::begin()
+{
+    ready = false;
+    if (!fs.exists(dir) && !fs.mkdir(dir))
+    {
+        Serial.println("Offline queue: cannot create " + dir);
+        return false;
+    }
+
+    File root = fs.open(dir);
+    if (!root || !root.isDirectory())
+    {
+        Serial.println("Offline queue: " + dir + " is not a directory");
+        return false;
+    }
+
+    bool found = false;
+    uint32_t minSeq = 0;
+    uint32_t maxSeq = 0;
+    uint32_t total = 0;
+    size_t headBytes = 0;
+
+    File entry = root.openNextFile();
+    while (entry)
+    {
+        // Older cores return the full path, newer ones only the file name
+        String name = entry.name();
+        name = name.substring(name.lastIndexOf('/') + 1);
+        if (name.endsWith(".seg"))
+        {
+            uint32_t seq = name.toInt();
+            total += entry.size() / sizeof(QueuedSample);
+            if (!found || seq < minSeq)
+            {
+                minSeq = seq;
+            }
+            if (!found || seq >= maxSeq)
+            {
+                maxSeq = seq;
+                headBytes = entry.size();
+            }
+            found = true;
+        }
+        entry.close();
+        entry = root.openNextFile();
+    }
+    root.close();
+
+    tailSeq = minSeq;
+    headSeq = maxSeq;
+    tailOffset = 0;
+    headCount = headBytes / sizeof(QueuedSample);
+
+    File cursor = fs.open(cursorPath(), "r");
+    if (cursor)
+    {
+        uint32_t savedSeq = 0;
+        uint16_t savedOffset = 0;
+        if (cursor.read((uint8_t *)&savedSeq, sizeof(savedSeq)) == sizeof(savedSeq) &&
+            cursor.read((uint8_t *)&savedOffset, sizeof(savedOffset)) == sizeof(savedOffset) &&
+            found && savedSeq == tailSeq)
+        {
+            tailOffset = min(savedOffset, recordsIn(tailSeq));
+        }
+        cursor.close();
+    }
+
+    count = total - tailOffset;
+
+    // A torn write left a partial record behind: continue in a fresh segment
+    if (found && headBytes % sizeof(QueuedSample) != 0)
+    {
+        headSeq++;
+        headCount = 0;
+    }
+
+    ready = true;
+    Serial.printf("Offline queue: %lu samples waiting\n", (unsigned long)count);
+    return true;
+}
+
+bool OfflineQueue::push(const String &zoneId, const ZoneSample &sample)
+{
+    if (!ready)
+    {
+        return false;
+    }
+    // A cut id would replay the sample into another zone, or none
+    if (zoneId.length() > MAX_ZONE_ID)
+    {
+        LOG_WARN("Offline queue: zone id %s is longer than %d characters, sample dropped", zoneId, (int)MAX_ZONE_ID);
+        return false;
+    }
+
+    if (headCount >= RECORDS_PER_SEGMENT)
+    {
+        headSeq++;
+        headCount = 0;
+    }
+
+    QueuedSample record;
+    memset(&record, 0, sizeof(record));
+    record.magic = RECORD_MAGIC;
+    record.soilCount = min((int)sample.soilCount, (int)ZoneSample::MAX_SOIL);
+    memcpy(record.zoneId, zoneId.c_str(), zoneId.length() + 1);
+    record.epoch = sample.epoch;
+    record.temperature = sample.temperature;
+    record.humidity = sample.humidity;
+    record.light = sample.light;
+    record.airQuality = sample.airQuality;
+    for (int i = 0; i < record.soilCount; i++)
+    {
+        record.soilPins[i] = sample.soilPins[i];
+        record.soilMoisture[i] = (uint16_t)constrain(sample.soilMoisture[i], 0.0f, 65535.0f);
+    }
+    record.crc = crc16((const uint8_t *)&record, offsetof(QueuedSample, crc));
+
+    File file = fs.open(segmentPath(headSeq), "a");
+    if (!file)
+    {
+        return false;
+    }
+    size_t written = file.write((const uint8_t *)&record, sizeof(record));
+    file.close();
+    if (written != sizeof(record))
+    {
+        // Never append behind a partial record
+        headSeq++;
+        headCount = 0;
+        return false;
+    }
+
+    headCount++;
+    count++;
+
+    // Over the cap: evict the oldest segment
+    while (headSeq - tailSeq + 1 > maxSegments)
+    {
+        dropTailSegment();
+    }
+    return true;
+}
+
+int OfflineQueue::peek(ZoneSample *out, int max, String &zoneId)
+{
+    if (!ready || count == 0 || max <= 0)
+    {
+        return 0;
+    }
+
+    File file = fs.open(segmentPath(tailSeq), "r");
+    if (!file)
+    {
+        // Segment vanished underneath us, skip it
+        if (tailSeq == headSeq)
+        {
+            count = 0;
+            headSeq++;
+            headCount = 0;
+            tailSeq = headSeq;
+            tailOffset = 0;
+        }
+        else
+        {
+            dropTailSegment();
+        }
+        return 0;
+    }
+
+    uint16_t available = file.size() / sizeof(QueuedSample);
+    file.seek((size_t)tailOffset * sizeof(QueuedSample));
+
+    int n = 0;
+    char firstZone[sizeof(QueuedSample::zoneId) + 1] = {0};
+    while (n < max && tailOffset + n < available)
+    {
+        QueuedSample record;
+        if (file.read((uint8_t *)&record, sizeof(record)) != sizeof(record))
+        {
+            break;
+        }
+
+        bool valid = record.magic == RECORD_MAGIC &&
+                     record.soilCount <= ZoneSample::MAX_SOIL &&
+                     record.crc == crc16((const uint8_t *)&record, offsetof(QueuedSample, crc));
+        if (!valid)
+        {
+            if (n > 0)
+            {
+                break;
+            }
+            // Skip damaged records at the front so they cannot block the queue
+            corrupt++;
+            tailOffset++;
+            count--;
+            continue;
+        }
+
+        if (n == 0)
+        {
+            memcpy(firstZone, record.zoneId, sizeof(record.zoneId));
+        }
+        else if (strncmp(firstZone, record.zoneId, sizeof(record.zoneId)) != 0)
+        {
+            break;
+        }
+
+        ZoneSample &sample = out[n];
+        sample.takenAtMs = 0;
+        sample.setTimestamp(record.epoch);
+        sample.temperature = record.temperature;
+        sample.humidity = record.humidity;
+        sample.light = record.light;
+        sample.airQuality = record.airQuality;
+        sample.soilCount = record.soilCount;
+        // Only the values are kept on flash; replay them in full
+        sample.present = ZoneSample::ALL_FIELDS;
+        sample.keyframe = true;
+        for (int i = 0; i < record.soilCount; i++)
+        {
+            sample.soilPins[i] = record.soilPins[i];
+            sample.soilMoisture[i] = record.soilMoisture[i];
+        }
+        n++;
+    }
+    file.close();
+
+    if (n == 0 && tailOffset >= available)
+    {
+        // Only damaged records were left in this segment
+        retireTail();
+        saveCursor();
+    }
+
+    zoneId = firstZone;
+    return n;
+}
+
+void OfflineQueue::pop(int n)
+{
+    while (ready && n > 0 && count > 0)
+    {
+        uint16_t inTail = tailSeq == headSeq ? headCount : recordsIn(tailSeq);
+        int take = min(n, (int)inTail - (int)tailOffset);
+        if (take <= 0)
+        {
+            if (tailSeq == headSeq)
+            {
+                count = 0;
+                break;
+            }
+            retireTail();
+            continue;
+        }
+
+        tailOffset += take;
+        count -= take;
+        n -= take;
+
+        if (tailOffset >= inTail)
+        {
+            retireTail();
+        }
+    }
+    saveCursor();
+}
+
+void OfflineQueue::retireTail()
+{
+    fs.remove(segmentPath(tailSeq));
+    if (tailSeq == headSeq)
+    {
+        // Queue drained: continue in a fresh segment
+        headSeq++;
+        headCount = 0;
+    }
+    tailSeq++;
+    tailOffset = 0;
+}
+
+void OfflineQueue::dropTailSegment()
+{
+    if (tailSeq == headSeq)
+    {
+        return;
+    }
+
+    uint16_t records = recordsIn(tailSeq);
+    uint32_t remaining = records > tailOffset ? records - tailOffset : 0;
+    fs.remove(segmentPath(tailSeq));
+    count = count > remaining ? count - remaining : 0;
+    evicted += remaining;
+    tailSeq++;
+    tailOffset = 0;
+    saveCursor();
+}
+
+void OfflineQueue::saveCursor()
+{
+    File cursor = fs.open(cursorPath(), "w");
+    if (!cursor)
+    {
+        return;
+    }
+    cursor.write((const uint8_t *)&tailSeq, sizeof(tailSeq));
+    cursor.write((const uint8_t *)&tailOffset, sizeof(tailOffset));
+    cursor.close();
+}
+
+uint32_t OfflineQueue::size() const
+{
+    return count;
+}
+
+bool OfflineQueue::isEmpty() const
+{
+    return count == 0;
+}
+
+uint32_t OfflineQueue::getEvicted() const
+{
+    return evicted;
+}
+
+uint32_t OfflineQueue::getCorrupt() const
+{
+    return corrupt;
+}
+
+// CRC-16/CCITT-FALSE
+uint16_t OfflineQueue::crc16(const uint8_t *data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    while (length--)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
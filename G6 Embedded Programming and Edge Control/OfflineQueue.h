@@ -0,0 +1,83 @@
+#ifndef OFFLINEQUEUE_H
+#define OFFLINEQUEUE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "TelemetryBuffer.h"
+
+// Fixed-size on-flash form of a ZoneSample (56 bytes)
+struct __attribute__((packed)) QueuedSample
+{
+    uint8_t magic;
+    uint8_t soilCount;
+    char zoneId[8];     // NUL-terminated
+    uint32_t epoch;
+    float temperature;
+    float humidity;
+    float light;
+    float airQuality;
+    uint8_t soilPins[ZoneSample::MAX_SOIL];
+    uint16_t soilMoisture[ZoneSample::MAX_SOIL];  // raw ADC
+    uint16_t crc;
+};
+
+// Persistent FIFO of samples that could not be uploaded.
+//
+// Records are appended to segment files <dir>/<seq>.seg, each holding
+// RECORDS_PER_SEGMENT records (one 4 KB flash block). Segments are never
+// rewritten: a new sequence number is used when one fills up, and a fully
+// drained segment is deleted, so writes rotate over fresh blocks. The read
+// position inside the oldest segment is kept in <dir>/cursor.
+// When maxRecords is exceeded the oldest segment is evicted as a whole.
+//
+// The file system is injected, so any fs::FS (LittleFS on the node, a
+// file-backed implementation elsewhere) can hold the queue.
+class OfflineQueue
+{
+public:
+    static const int RECORDS_PER_SEGMENT = 4096 / sizeof(QueuedSample);
+    // Longest zone id a record can hold
+    static const size_t MAX_ZONE_ID = sizeof(QueuedSample::zoneId) - 1;
+
+    OfflineQueue(fs::FS &fs, const char *dir = "/queue", uint32_t maxRecords = 2048);
+
+    // Rebuilds the queue state from the segments found on flash
+    bool begin();
+
+    // False if the sample could not be stored, or zoneId is longer than MAX_ZONE_ID
+    bool push(const String &zoneId, const ZoneSample &sample);
+    // Reads up to max of the oldest records that share the zone of the first one.
+    // Stays inside one segment so a call costs at most one file open and read.
+    int peek(ZoneSample *out, int max, String &zoneId);
+    // Drops the count oldest records, e.g. after peek()ed records were uploaded
+    void pop(int count);
+
+    uint32_t size() const;
+    bool isEmpty() const;
+    uint32_t getEvicted() const;
+    uint32_t getCorrupt() const;
+
+private:
+    fs::FS &fs;
+    String dir;
+    uint32_t maxSegments;
+    bool ready;
+
+    uint32_t tailSeq;      // oldest segment
+    uint32_t headSeq;      // segment being appended to
+    uint16_t tailOffset;   // records already consumed in the tail segment
+    uint16_t headCount;    // records in the head segment
+    uint32_t count;
+    uint32_t evicted;
+    uint32_t corrupt;
+
+    String segmentPath(uint32_t seq) const;
+    String cursorPath() const;
+    uint16_t recordsIn(uint32_t seq);
+    void saveCursor();
+    void dropTailSegment();
+    void retireTail();
+    static uint16_t crc16(const uint8_t *data, size_t length);
+};
+
+#endif
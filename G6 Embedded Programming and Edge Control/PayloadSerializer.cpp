@@ -0,0 +1,617 @@
+#include "PayloadSerializer.h"
+
+BufferPrint::BufferPrint(char *buffer, size_t capacity)
+{
+    this->buffer = buffer;
+    this->capacity = capacity;
+    reset();
+}
+
+size_t BufferPrint::write(uint8_t c)
+{
+    // Keep one byte for the terminator
+    if (used + 1 >= capacity)
+    {
+        overflow = true;
+        return 0;
+    }
+    buffer[used++] = (char)c;
+    buffer[used] = '\0';
+    return 1;
+}
+
+size_t BufferPrint::write(const uint8_t *data, size_t size)
+{
+    size_t room = remaining();
+    if (size > room)
+    {
+        overflow = true;
+        size = room;
+    }
+    memcpy(buffer + used, data, size);
+    used += size;
+    buffer[used] = '\0';
+    return size;
+}
+
+const char *BufferPrint::c_str() const
+{
+    return buffer;
+}
+
+const uint8_t *BufferPrint::data() const
+{
+    return (const uint8_t *)buffer;
+}
+
+size_t BufferPrint::length() const
+{
+    return used;
+}
+
+size_t BufferPrint::remaining() const
+{
+    return capacity > used + 1 ? capacity - used - 1 : 0;
+}
+
+bool BufferPrint::overflowed() const
+{
+    return overflow;
+}
+
+void BufferPrint::truncate(size_t length)
+{
+    if (length < used)
+    {
+        used = length;
+        buffer[used] = '\0';
+    }
+    overflow = false;
+}
+
+void BufferPrint::reset()
+{
+    used = 0;
+    overflow = false;
+    if (capacity > 0)
+    {
+        buffer[0] = '\0';
+    }
+}
+
+JsonWriter::JsonWriter(Print &out) : out(out)
+{
+    firstItem = 1;
+    depth = 0;
+}
+
+void JsonWriter::separator()
+{
+    uint16_t bit = 1u << depth;
+    if (firstItem & bit)
+    {
+        firstItem &= ~bit;
+    }
+    else
+    {
+        out.write(',');
+    }
+}
+
+void JsonWriter::writeString(const char *value)
+{
+    out.write('"');
+    for (const char *p = value; *p; p++)
+    {
+        char c = *p;
+        if (c == '"' || c == '\\')
+        {
+            out.write('\\');
+            out.write(c);
+        }
+        else if ((uint8_t)c < 0x20)
+        {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out.write(escaped);
+        }
+        else
+        {
+            out.write(c);
+        }
+    }
+    out.write('"');
+}
+
+void JsonWriter::writeKey(const char *key)
+{
+    separator();
+    if (key != nullptr)
+    {
+        writeString(key);
+        out.write(':');
+    }
+}
+
+void JsonWriter::writeNumber(float value, uint8_t decimals)
+{
+    if (isnan(value) || isinf(value))
+    {
+        out.print("null");
+        return;
+    }
+    out.print(value, decimals);
+}
+
+void JsonWriter::open(char bracket, const char *key)
+{
+    if (depth > 0)
+    {
+        writeKey(key);
+    }
+    out.write(bracket);
+    if (depth + 1 < MAX_DEPTH)
+    {
+        depth++;
+        firstItem |= 1u << depth;
+    }
+}
+
+void JsonWriter::close(char bracket)
+{
+    out.write(bracket);
+    if (depth > 0)
+    {
+        depth--;
+    }
+}
+
+JsonWriter &JsonWriter::beginObject(const char *key)
+{
+    open('{', key);
+    return *this;
+}
+
+JsonWriter &JsonWriter::endObject()
+{
+    close('}');
+    return *this;
+}
+
+JsonWriter &JsonWriter::beginArray(const char *key)
+{
+    open('[', key);
+    return *this;
+}
+
+JsonWriter &JsonWriter::endArray()
+{
+    close(']');
+    return *this;
+}
+
+JsonWriter &JsonWriter::field(const char *key, const char *value)
+{
+    writeKey(key);
+    writeString(value != nullptr ? value : "");
+    return *this;
+}
+
+JsonWriter &JsonWriter::field(const char *key, const String &value)
+{
+    return field(key, value.c_str());
+}
+
+JsonWriter &JsonWriter::field(const char *key, float value, uint8_t decimals)
+{
+    writeKey(key);
+    writeNumber(value, decimals);
+    return *this;
+}
+
+JsonWriter &JsonWriter::field(const char *key, int value)
+{
+    writeKey(key);
+    out.print(value);
+    return *this;
+}
+
+JsonWriter &JsonWriter::field(const char *key, uint32_t value)
+{
+    writeKey(key);
+    out.print((unsigned long)value);
+    return *this;
+}
+
+JsonWriter &JsonWriter::field(const char *key, bool value)
+{
+    writeKey(key);
+    out.print(value ? "true" : "false");
+    return *this;
+}
+
+CborWriter::CborWriter(Print &out) : out(out)
+{
+}
+
+void CborWriter::writeHead(uint8_t major, uint64_t value)
+{
+    uint8_t head = major << 5;
+    if (value < 24)
+    {
+        out.write((uint8_t)(head | value));
+        return;
+    }
+
+    uint8_t bytes;
+    if (value <= 0xFF)
+    {
+        head |= 24;
+        bytes = 1;
+    }
+    else if (value <= 0xFFFF)
+    {
+        head |= 25;
+        bytes = 2;
+    }
+    else if (value <= 0xFFFFFFFFULL)
+    {
+        head |= 26;
+        bytes = 4;
+    }
+    else
+    {
+        head |= 27;
+        bytes = 8;
+    }
+
+    uint8_t encoded[9];
+    encoded[0] = head;
+    for (int i = 0; i < bytes; i++)
+    {
+        // Big endian
+        encoded[bytes - i] = (uint8_t)(value >> (8 * i));
+    }
+    out.write(encoded, bytes + 1);
+}
+
+CborWriter &CborWriter::beginMap()
+{
+    out.write((uint8_t)0xBF);
+    return *this;
+}
+
+CborWriter &CborWriter::beginArray()
+{
+    out.write((uint8_t)0x9F);
+    return *this;
+}
+
+CborWriter &CborWriter::end()
+{
+    out.write((uint8_t)0xFF);
+    return *this;
+}
+
+CborWriter &CborWriter::key(uint8_t key)
+{
+    writeHead(0, key);
+    return *this;
+}
+
+CborWriter &CborWriter::value(uint64_t value)
+{
+    writeHead(0, value);
+    return *this;
+}
+
+CborWriter &CborWriter::value(int value)
+{
+    if (value < 0)
+    {
+        writeHead(1, (uint64_t)(-(int64_t)value - 1));
+    }
+    else
+    {
+        writeHead(0, (uint64_t)value);
+    }
+    return *this;
+}
+
+CborWriter &CborWriter::value(float value)
+{
+    if (isnan(value) || isinf(value))
+    {
+        return null();
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t encoded[5] = {0xFA, (uint8_t)(bits >> 24), (uint8_t)(bits >> 16), (uint8_t)(bits >> 8), (uint8_t)bits};
+    out.write(encoded, sizeof(encoded));
+    return *this;
+}
+
+CborWriter &CborWriter::value(const char *value)
+{
+    if (value == nullptr)
+    {
+        value = "";
+    }
+    size_t length = strlen(value);
+    writeHead(3, length);
+    out.write((const uint8_t *)value, length);
+    return *this;
+}
+
+CborWriter &CborWriter::value(bool value)
+{
+    out.write((uint8_t)(value ? 0xF5 : 0xF4));
+    return *this;
+}
+
+CborWriter &CborWriter::null()
+{
+    out.write((uint8_t)0xF6);
+    return *this;
+}
+
+void PayloadSerializer::zoneSample(JsonWriter &json, const String &zoneId, const ZoneSample &sample, const String &userId)
+{
+    json.beginObject();
+    json.field("zoneId", zoneId);
+
+    json.beginObject("zoneSensors");
+    if (sample.has(ZoneSample::HAS_HUMIDITY))
+        json.field("humidity", isnan(sample.humidity) ? 0.0f : sample.humidity);
+    if (sample.has(ZoneSample::HAS_TEMPERATURE))
+        json.field("temp", isnan(sample.temperature) ? 0.0f : sample.temperature);
+    if (sample.has(ZoneSample::HAS_LIGHT))
+        json.field("light", isnan(sample.light) ? 0.0f : sample.light);
+    if (sample.has(ZoneSample::HAS_AIR_QUALITY))
+        json.field("airQuality", isnan(sample.airQuality) ? 0.0f : sample.airQuality);
+    json.endObject();
+
+    json.beginArray("soilMoistureByPin");
+    for (int p = 0; p < sample.soilCount; p++)
+    {
+        if (!sample.hasSoil(p))
+            continue;
+        json.beginObject();
+        json.field("pin", (int)sample.soilPins[p]);
+        json.field("soilMoisture", toMoisturePercent(sample.soilMoisture[p]));
+        json.endObject();
+    }
+    json.endArray();
+
+    if (userId != "")
+        json.field("userId", userId);
+    if (sample.timestamp[0] != '\0')
+        json.field("timestamp", sample.timestamp);
+    // Keyframes keep the original shape
+    if (!sample.keyframe)
+        json.field("delta", true);
+    json.endObject();
+}
+
+bool PayloadSerializer::appendSample(BufferPrint &out, JsonWriter &json, const String &zoneId, const ZoneSample &sample, const String &userId)
+{
+    size_t mark = out.length();
+    zoneSample(json, zoneId, sample, userId);
+    // Keep room for the closing bracket; drop a sample that does not fit whole
+    if (out.overflowed() || out.remaining() < 1)
+    {
+        out.truncate(mark);
+        return false;
+    }
+    return true;
+}
+
+bool PayloadSerializer::appendSample(BufferPrint &out, CborWriter &cbor, const ZoneSample &sample)
+{
+    size_t mark = out.length();
+    cbor.beginMap();
+    if (sample.epoch != 0)
+        cbor.field(FIELD_TIMESTAMP, (uint64_t)sample.epoch * 1000);
+    if (!sample.keyframe)
+        cbor.field(FIELD_DELTA, true);
+    if (sample.has(ZoneSample::HAS_TEMPERATURE))
+        cbor.field(FIELD_TEMPERATURE, sample.temperature);
+    if (sample.has(ZoneSample::HAS_HUMIDITY))
+        cbor.field(FIELD_HUMIDITY, sample.humidity);
+    if (sample.has(ZoneSample::HAS_LIGHT))
+        cbor.field(FIELD_LIGHT, sample.light);
+    if (sample.has(ZoneSample::HAS_AIR_QUALITY))
+        cbor.field(FIELD_AIR_QUALITY, sample.airQuality);
+    cbor.key(FIELD_SOIL).beginArray();
+    for (int p = 0; p < sample.soilCount; p++)
+    {
+        if (!sample.hasSoil(p))
+            continue;
+        cbor.beginArray();
+        cbor.value((int)sample.soilPins[p]);
+        cbor.value(toMoisturePercent(sample.soilMoisture[p]));
+        cbor.end();
+    }
+    cbor.end();
+    cbor.end();
+    // Keep room for the two breaks closing the sample array and the message
+    if (out.overflowed() || out.remaining() < 2)
+    {
+        out.truncate(mark);
+        return false;
+    }
+    return true;
+}
+
+int PayloadSerializer::jsonBatch(BufferPrint &out, const String &zoneId, const SampleSource &sampleAt, int count, const String &userId)
+{
+    JsonWriter json(out);
+    json.beginArray();
+    int written = 0;
+    while (written < count && appendSample(out, json, zoneId, sampleAt(written), userId))
+    {
+        written++;
+    }
+    json.endArray();
+    return out.overflowed() ? 0 : written;
+}
+
+// {schema, zone, user, samples: [...]}: the zone and user are sent once
+// per batch rather than once per sample
+int PayloadSerializer::cborBatch(BufferPrint &out, const String &zoneId, const SampleSource &sampleAt, int count, const String &userId)
+{
+    CborWriter cbor(out);
+    cbor.beginMap();
+    cbor.field(FIELD_SCHEMA, (int)CBOR_SCHEMA_VERSION);
+    cbor.field(FIELD_ZONE, zoneId.c_str());
+    if (userId != "")
+        cbor.field(FIELD_USER, userId.c_str());
+    cbor.key(FIELD_SAMPLES).beginArray();
+    int written = 0;
+    while (written < count && appendSample(out, cbor, sampleAt(written)))
+    {
+        written++;
+    }
+    cbor.end();
+    cbor.end();
+    return out.overflowed() ? 0 : written;
+}
+
+int PayloadSerializer::sensorBatch(BufferPrint &out, const String &zoneId, const TelemetryBuffer &buffer, int count, const String &userId,
+                                   PayloadFormat format)
+{
+    count = min(count, buffer.size());
+    SampleSource sampleAt = [&buffer](int index) -> const ZoneSample & { return buffer.at(index); };
+    return sensorBatch(out, zoneId, sampleAt, count, userId, format);
+}
+
+int PayloadSerializer::sensorBatch(BufferPrint &out, const String &zoneId, const ZoneSample *samples, int count, const String &userId,
+                                   PayloadFormat format)
+{
+    SampleSource sampleAt = [samples](int index) -> const ZoneSample & { return samples[index]; };
+    return sensorBatch(out, zoneId, sampleAt, count, userId, format);
+}
+
+int PayloadSerializer::sensorBatch(BufferPrint &out, const String &zoneId, const SampleSource &sampleAt, int count, const String &userId,
+                                   PayloadFormat format)
+{
+    return format == FORMAT_CBOR ? cborBatch(out, zoneId, sampleAt, count, userId)
+                                 : jsonBatch(out, zoneId, sampleAt, count, userId);
+}
+
+const char *PayloadSerializer::contentType(PayloadFormat format)
+{
+    return format == FORMAT_CBOR ? "application/cbor" : "application/json";
+}
+
+void PayloadSerializer::actuatorLog(Print &out, const char *action, const char *actuatorId, const char *plantId,
+                                    const char *trigger, const char *zone, const char *triggerBy, const char *timestamp)
+{
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("action", action);
+    json.field("actuatorId", actuatorId);
+    json.field("plantId", plantId);
+    json.field("trigger", trigger);
+    json.field("zone", zone);
+    if (triggerBy != nullptr && triggerBy[0] != '\0')
+        json.field("triggerBy", triggerBy);
+    if (timestamp != nullptr && timestamp[0] != '\0')
+        json.field("timestamp", timestamp);
+    json.endObject();
+}
+
+void PayloadSerializer::actuatorFeedbackBatch(Print &out, const char *zone, uint32_t epochSeconds,
+                                              const ActuatorTransition *transitions, int count)
+{
+    // Same content as the CBOR form, so one transition fits next to the topic
+    // in the MQTT client's packet buffer
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("zone", zone);
+    if (epochSeconds != 0)
+        json.field("ts", epochSeconds);
+    json.beginArray("tr");
+    for (int i = 0; i < count; i++)
+    {
+        json.beginArray();
+        json.field(nullptr, transitions[i].action);
+        json.field(nullptr, transitions[i].system ? 1 : 0);
+        json.endArray();
+    }
+    json.endArray();
+    json.endObject();
+}
+
+void PayloadSerializer::actuatorFeedbackBatch(CborWriter &cbor, const char *zone, uint64_t epochMs,
+                                              const ActuatorTransition *transitions, int count)
+{
+    cbor.beginMap();
+    cbor.field(FIELD_SCHEMA, (int)CBOR_SCHEMA_VERSION);
+    cbor.field(FIELD_ZONE, zone);
+    if (epochMs != 0)
+        cbor.field(FIELD_TIMESTAMP, epochMs);
+    cbor.key(FIELD_TRANSITIONS).beginArray();
+    for (int i = 0; i < count; i++)
+    {
+        cbor.beginArray();
+        cbor.value(transitions[i].action);
+        cbor.value(transitions[i].system);
+        cbor.end();
+    }
+    cbor.end();
+    cbor.end();
+}
+
+void PayloadSerializer::plantRecord(JsonWriter &json, const char *plantId, const char *userId, const char *timestamp,
+                                    float humidity, float light, float soilMoisture, float temperature, float airQuality)
+{
+    json.beginObject();
+
+    json.beginObject("automation");
+    json.field("fanOn", false);
+    json.field("lightOn", false);
+    json.field("waterOn", false);
+    json.endObject();
+
+    json.field("lastUpdated", timestamp);
+    json.field("plantId", plantId);
+
+    json.beginObject("profile");
+    json.field("humidityMax", 100);
+    json.field("humidityMin", 0);
+    json.field("lightMax", 1000);
+    json.field("lightMin", 0);
+    json.field("moistureMax", 100);
+    json.field("moistureMin", 0);
+    json.field("tempMax", 50);
+    json.field("tempMin", 0);
+    json.endObject();
+
+    json.field("sensorRecordId", timestamp);
+
+    json.beginObject("sensors");
+    json.field("humidity", humidity);
+    json.field("light", light);
+    json.field("soilMoisture", soilMoisture);
+    json.field("temp", temperature);
+    json.field("airQuality", airQuality);
+    json.endObject();
+
+    json.field("userId", userId);
+    json.endObject();
+}
+
+void PayloadSerializer::formatTimestamp(time_t epoch, char *buffer, size_t size)
+{
+    struct tm timeinfo;
+    time_t local = epoch + 8 * 3600;    // Add 8 hours for UTC+8
+    gmtime_r(&local, &timeinfo);
+    strftime(buffer, size, "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
+}
+
+float PayloadSerializer::toMoisturePercent(float rawValue)
+{
+    float moisturePercent = map((int)rawValue, 3900, 1200, 0, 100);
+    return constrain(moisturePercent, 0, 100);
+}
@@ -0,0 +1,187 @@
+#ifndef PAYLOADSERIALIZER_H
+#define PAYLOADSERIALIZER_H
+
+#include <Arduino.h>
+#include <time.h>
+#include <functional>
+#include "TelemetryBuffer.h"
+
+// Print target over a caller-provided buffer. Never allocates; output past
+// the capacity is dropped and reported through overflowed().
+class BufferPrint : public Print
+{
+public:
+    BufferPrint(char *buffer, size_t capacity);
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *data, size_t size) override;
+
+    const char *c_str() const;
+    const uint8_t *data() const;
+    size_t length() const;
+    // Bytes that can still be written
+    size_t remaining() const;
+    bool overflowed() const;
+    // Cuts the output back to length bytes and clears the overflow flag
+    void truncate(size_t length);
+    void reset();
+
+private:
+    char *buffer;
+    size_t capacity;
+    size_t used;
+    bool overflow;
+};
+
+// Streaming JSON emitter. Writes straight to any Print (a BufferPrint, a
+// socket, Serial) and keeps only a nesting bitmask as state.
+class JsonWriter
+{
+public:
+    explicit JsonWriter(Print &out);
+
+    JsonWriter &beginObject(const char *key = nullptr);
+    JsonWriter &endObject();
+    JsonWriter &beginArray(const char *key = nullptr);
+    JsonWriter &endArray();
+
+    JsonWriter &field(const char *key, const char *value);
+    JsonWriter &field(const char *key, const String &value);
+    JsonWriter &field(const char *key, float value, uint8_t decimals = 2);
+    JsonWriter &field(const char *key, int value);
+    JsonWriter &field(const char *key, uint32_t value);
+    JsonWriter &field(const char *key, bool value);
+
+private:
+    static const uint8_t MAX_DEPTH = 16;
+
+    void separator();
+    void writeKey(const char *key);
+    void writeString(const char *value);
+    void writeNumber(float value, uint8_t decimals);
+    void open(char bracket, const char *key);
+    void close(char bracket);
+
+    Print &out;
+    uint16_t firstItem;   // one bit per nesting level
+    uint8_t depth;
+};
+
+// Streaming CBOR (RFC 8949) emitter with the same contract as JsonWriter.
+// Maps and arrays are written with indefinite length and closed by end(),
+// so nothing has to be counted up front.
+class CborWriter
+{
+public:
+    explicit CborWriter(Print &out);
+
+    CborWriter &beginMap();
+    CborWriter &beginArray();
+    CborWriter &end();
+
+    CborWriter &value(uint64_t value);
+    CborWriter &value(int value);
+    // NaN and infinity are written as null
+    CborWriter &value(float value);
+    CborWriter &value(const char *value);
+    CborWriter &value(bool value);
+    CborWriter &null();
+
+    // Map entry with an integer key
+    template <typename T>
+    CborWriter &field(uint8_t key, T fieldValue)
+    {
+        value((uint64_t)key);
+        return value(fieldValue);
+    }
+    CborWriter &key(uint8_t key);
+
+private:
+    void writeHead(uint8_t major, uint64_t value);
+
+    Print &out;
+};
+
+// Uplink encoding. JSON is what the backend has always accepted; CBOR
+// carries the same data with integer keys (see PayloadField).
+enum PayloadFormat : uint8_t
+{
+    FORMAT_JSON,
+    FORMAT_CBOR
+};
+
+// Integer keys of the CBOR payloads, schema CBOR_SCHEMA_VERSION.
+// tools/decode_payload.py maps them back to the JSON names; keep both in sync.
+enum PayloadField : uint8_t
+{
+    FIELD_SCHEMA = 0,
+    FIELD_ZONE = 1,
+    FIELD_USER = 2,
+    FIELD_SAMPLES = 3,
+    FIELD_TIMESTAMP = 4,      // epoch ms, absent while the clock is unsynced
+    FIELD_TRANSITIONS = 5,    // [[action, system], ...]
+    FIELD_DELTA = 6,          // true: only changed readings are present
+    FIELD_TEMPERATURE = 10,
+    FIELD_HUMIDITY = 11,
+    FIELD_LIGHT = 12,
+    FIELD_AIR_QUALITY = 13,
+    FIELD_SOIL = 14           // [[pin, moisture %], ...]
+};
+
+// One actuator state change reported in a feedback message
+struct ActuatorTransition
+{
+    const char *action;   // "pump ON", "fan OFF", ...
+    bool system;          // switched by the edge rules rather than a user command
+};
+
+// Wire formats of every payload the node sends. All of them write through
+// JsonWriter into caller-provided storage and allocate nothing.
+class PayloadSerializer
+{
+public:
+    static const uint8_t CBOR_SCHEMA_VERSION = 1;
+
+    // Sample by age, 0 the oldest
+    typedef std::function<const ZoneSample &(int)> SampleSource;
+
+    static const char *contentType(PayloadFormat format);
+
+    // Writes as many of the count oldest samples as fit, returns how many were written
+    static int sensorBatch(BufferPrint &out, const String &zoneId, const TelemetryBuffer &buffer, int count, const String &userId,
+                           PayloadFormat format = FORMAT_JSON);
+    static int sensorBatch(BufferPrint &out, const String &zoneId, const ZoneSample *samples, int count, const String &userId,
+                           PayloadFormat format = FORMAT_JSON);
+    static int sensorBatch(BufferPrint &out, const String &zoneId, const SampleSource &sampleAt, int count, const String &userId,
+                           PayloadFormat format = FORMAT_JSON);
+    static void zoneSample(JsonWriter &json, const String &zoneId, const ZoneSample &sample, const String &userId);
+
+    static void actuatorLog(Print &out, const char *action, const char *actuatorId, const char *plantId,
+                            const char *trigger, const char *zone, const char *triggerBy, const char *timestamp);
+    // Every transition of one control cycle in a single message:
+    //   {"zone":"zone1","ts":1709294400,"tr":[["pump ON",1],["fan OFF",0]]}
+    // with 1 for a rule (SYSTEM) and 0 for a user command; "ts" is the epoch
+    // in seconds and left out until the clock is synced
+    static void actuatorFeedbackBatch(Print &out, const char *zone, uint32_t epochSeconds,
+                                      const ActuatorTransition *transitions, int count);
+    static void actuatorFeedbackBatch(CborWriter &cbor, const char *zone, uint64_t epochMs,
+                                      const ActuatorTransition *transitions, int count);
+
+    // Legacy per-plant record posted by SensorModule::sendAllToCloud
+    static void plantRecord(JsonWriter &json, const char *plantId, const char *userId, const char *timestamp,
+                            float humidity, float light, float soilMoisture, float temperature, float airQuality);
+
+    // ISO-8601 text in UTC+8 as the backend expects it
+    static void formatTimestamp(time_t epoch, char *buffer, size_t size);
+
+    // Raw ADC to percentage (100% = very wet, 0% = very dry)
+    static float toMoisturePercent(float rawValue);
+
+private:
+    static int jsonBatch(BufferPrint &out, const String &zoneId, const SampleSource &sampleAt, int count, const String &userId);
+    static int cborBatch(BufferPrint &out, const String &zoneId, const SampleSource &sampleAt, int count, const String &userId);
+    static bool appendSample(BufferPrint &out, JsonWriter &json, const String &zoneId, const ZoneSample &sample, const String &userId);
+    static bool appendSample(BufferPrint &out, CborWriter &cbor, const ZoneSample &sample);
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "PlantCache.h"
+
+static const char *KEY_PLANTS = "plants";
+static const char *KEY_ETAG = "etag";
+
+PlantCache::PlantCache(const char *nvsNamespace)
+{
+    this->nvsNamespace = nvsNamespace;
+}
+
+bool PlantCache::load(std::vector<PlantData> &plants)
+{
+    Preferences prefs;
+    if (!prefs.begin(nvsNamespace, true))
+    {
+        return false;
+    }
+
+    uint8_t blob[sizeof(Header) + MAX_CACHED_PLANTS * sizeof(CachedPlant)];
+    size_t length = prefs.getBytesLength(KEY_PLANTS);
+    bool ok = length >= sizeof(Header) && length <= sizeof(blob) &&
+              prefs.getBytes(KEY_PLANTS, blob, length) == length;
+
+    Header header;
+    if (ok)
+    {
+        memcpy(&header, blob, sizeof(header));
+        ok = header.version == FORMAT_VERSION &&
+             length == sizeof(Header) + header.count * sizeof(CachedPlant);
+    }
+
+    if (ok)
+    {
+        etag = prefs.getString(KEY_ETAG, "");
+    }
+    prefs.end();
+
+    if (!ok)
+    {
+        return false;
+    }
+
+    plants.clear();
+    plants.reserve(header.count);
+    for (int i = 0; i < header.count; i++)
+    {
+        CachedPlant record;
+        memcpy(&record, blob + sizeof(Header) + i * sizeof(CachedPlant), sizeof(record));
+        record.plantId[sizeof(record.plantId) - 1] = '\0';
+
+        PlantData data;
+        data.plantId = record.plantId;
+        data.moisturePin = record.moisturePin;
+        data.min_moisture = record.minMoisture;
+        data.max_moisture = record.maxMoisture;
+        data.min_temperature = record.minTemperature;
+        data.max_temperature = record.maxTemperature;
+        data.min_light = record.minLight;
+        data.max_light = record.maxLight;
+        data.min_airQuality = record.minAirQuality;
+        data.max_airQuality = record.maxAirQuality;
+        plants.push_back(data);
+    }
+    return true;
+}
+
+bool PlantCache::save(const std::vector<PlantData> &plants, const String &etag)
+{
+    if (plants.size() > MAX_CACHED_PLANTS)
+    {
+        Serial.println("Plant cache: too many plants, not cached");
+        return false;
+    }
+
+    uint8_t blob[sizeof(Header) + MAX_CACHED_PLANTS * sizeof(CachedPlant)];
+    memset(blob, 0, sizeof(blob));
+    Header header;
+    header.version = FORMAT_VERSION;
+    header.count = plants.size();
+    memcpy(blob, &header, sizeof(header));
+
+    for (size_t i = 0; i < plants.size(); i++)
+    {
+        const PlantData &data = plants[i];
+        CachedPlant record;
+        memset(&record, 0, sizeof(record));
+        if (data.plantId.length() >= sizeof(record.plantId))
+        {
+            Serial.println("Plant cache: plant id too long, not cached");
+            return false;
+        }
+        memcpy(record.plantId, data.plantId.c_str(), data.plantId.length() + 1);
+        record.moisturePin = data.moisturePin;
+        record.minMoisture = data.min_moisture;
+        record.maxMoisture = data.max_moisture;
+        record.minTemperature = data.min_temperature;
+        record.maxTemperature = data.max_temperature;
+        record.minLight = data.min_light;
+        record.maxLight = data.max_light;
+        record.minAirQuality = data.min_airQuality;
+        record.maxAirQuality = data.max_airQuality;
+        memcpy(blob + sizeof(Header) + i * sizeof(CachedPlant), &record, sizeof(record));
+    }
+    size_t length = sizeof(Header) + plants.size() * sizeof(CachedPlant);
+
+    Preferences prefs;
+    if (!prefs.begin(nvsNamespace, false))
+    {
+        return false;
+    }
+
+    // Servers without ETags still get polled in full; skip identical writes
+    uint8_t stored[sizeof(blob)];
+    bool unchanged = prefs.getBytesLength(KEY_PLANTS) == length &&
+                     prefs.getBytes(KEY_PLANTS, stored, length) == length &&
+                     memcmp(stored, blob, length) == 0;
+
+    bool ok = unchanged || prefs.putBytes(KEY_PLANTS, blob, length) == length;
+    if (ok && prefs.getString(KEY_ETAG, "") != etag)
+    {
+        prefs.putString(KEY_ETAG, etag);
+    }
+    prefs.end();
+
+    if (ok)
+    {
+        this->etag = etag;
+    }
+    return ok;
+}
+
+void PlantCache::clear()
+{
+    Preferences prefs;
+    if (prefs.begin(nvsNamespace, false))
+    {
+        prefs.clear();
+        prefs.end();
+    }
+    etag = "";
+}
+
+const String &PlantCache::getETag() const
+{
+    return etag;
+}
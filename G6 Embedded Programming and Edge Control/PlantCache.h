@@ -0,0 +1,60 @@
+#ifndef PLANTCACHE_H
+#define PLANTCACHE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <vector>
+#include "RESTClient.h"
+
+// Fixed-size NVS form of a PlantData (65 bytes)
+struct __attribute__((packed)) CachedPlant
+{
+    char plantId[32];
+    uint8_t moisturePin;
+    float minMoisture;
+    float maxMoisture;
+    float minTemperature;
+    float maxTemperature;
+    float minLight;
+    float maxLight;
+    float minAirQuality;
+    float maxAirQuality;
+};
+
+// Last plant/threshold set received from the backend, kept in NVS so the
+// node can boot and run its rules without waiting for the server.
+//
+// The plants are stored as one binary blob next to the ETag of the response
+// they came from; the ETag is sent back as If-None-Match on the next refresh
+// so an unchanged configuration costs a 304 and no parsing.
+class PlantCache
+{
+public:
+    static const int MAX_CACHED_PLANTS = 16;
+
+    explicit PlantCache(const char *nvsNamespace = "plants");
+
+    // Fills plants from NVS. Returns false if nothing valid is stored.
+    bool load(std::vector<PlantData> &plants);
+    // Stores plants with the ETag they were served with. The blob is only
+    // rewritten when its content changed, to spare the flash.
+    bool save(const std::vector<PlantData> &plants, const String &etag);
+    void clear();
+
+    // ETag of the stored set, empty when there is none
+    const String &getETag() const;
+
+private:
+    static const uint8_t FORMAT_VERSION = 1;
+
+    struct __attribute__((packed)) Header
+    {
+        uint8_t version;
+        uint8_t count;
+    };
+
+    const char *nvsNamespace;
+    String etag;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "PlantTable.h"
+
+void PlantTable::clear()
+{
+    pins.clear();
+    readings.clear();
+    readAtMs.clear();
+    dryRaw.clear();
+    wetRaw.clear();
+    minMoisture.clear();
+    maxMoisture.clear();
+    filters.clear();
+    ids.clear();
+}
+
+void PlantTable::reserve(int count)
+{
+    pins.reserve(count);
+    readings.reserve(count);
+    readAtMs.reserve(count);
+    dryRaw.reserve(count);
+    wetRaw.reserve(count);
+    minMoisture.reserve(count);
+    maxMoisture.reserve(count);
+    filters.reserve(count);
+    ids.reserve(count);
+}
+
+int PlantTable::add(const String &plantId, uint8_t pin, float minPercent, float maxPercent)
+{
+    pins.push_back(pin);
+    readings.push_back(0);
+    readAtMs.push_back(0);
+    dryRaw.push_back((uint16_t)DEFAULT_DRY_RAW);
+    wetRaw.push_back((uint16_t)DEFAULT_WET_RAW);
+    minMoisture.push_back(minPercent);
+    maxMoisture.push_back(maxPercent);
+    filters.push_back(AnalogFilter(pin));
+    ids.push_back(plantId);
+    return pins.size() - 1;
+}
+
+void PlantTable::carryOver(int index, const PlantTable &from, int fromIndex)
+{
+    readings[index] = from.readings[fromIndex];
+    readAtMs[index] = from.readAtMs[fromIndex];
+    dryRaw[index] = from.dryRaw[fromIndex];
+    wetRaw[index] = from.wetRaw[fromIndex];
+    filters[index] = from.filters[fromIndex];
+}
+
+void PlantTable::swap(PlantTable &other)
+{
+    pins.swap(other.pins);
+    readings.swap(other.readings);
+    readAtMs.swap(other.readAtMs);
+    dryRaw.swap(other.dryRaw);
+    wetRaw.swap(other.wetRaw);
+    minMoisture.swap(other.minMoisture);
+    maxMoisture.swap(other.maxMoisture);
+    filters.swap(other.filters);
+    ids.swap(other.ids);
+}
+
+int PlantTable::size() const
+{
+    return pins.size();
+}
+
+int PlantTable::indexOfPin(int pin) const
+{
+    for (size_t i = 0; i < pins.size(); i++)
+    {
+        if (pins[i] == pin)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+uint8_t PlantTable::getPin(int index) const
+{
+    return pins[index];
+}
+
+const String &PlantTable::getId(int index) const
+{
+    return ids[index];
+}
+
+float PlantTable::getMinMoisture(int index) const
+{
+    return minMoisture[index];
+}
+
+float PlantTable::getMaxMoisture(int index) const
+{
+    return maxMoisture[index];
+}
+
+void PlantTable::setCalibration(int index, uint16_t dry, uint16_t wet)
+{
+    dryRaw[index] = dry;
+    wetRaw[index] = wet;
+}
+
+float PlantTable::toPercent(int index, float raw) const
+{
+    float dry = dryRaw[index];
+    float wet = wetRaw[index];
+    if (dry == wet)
+    {
+        return NAN;
+    }
+    float percent = (dry - raw) * 100 / (dry - wet);
+    return constrain(percent, 0, 100);
+}
+
+bool PlantTable::hasReading(int index) const
+{
+    return filters[index].hasValue();
+}
+
+uint16_t PlantTable::getReading(int index) const
+{
+    return readings[index];
+}
+
+uint32_t PlantTable::getReadAtMs(int index) const
+{
+    return readAtMs[index];
+}
+
+void PlantTable::setReading(int index, uint16_t raw, uint32_t nowMs)
+{
+    readings[index] = raw;
+    readAtMs[index] = nowMs;
+}
+
+AnalogFilter &PlantTable::filter(int index)
+{
+    return filters[index];
+}
+
+const AnalogFilter &PlantTable::filter(int index) const
+{
+    return filters[index];
+}
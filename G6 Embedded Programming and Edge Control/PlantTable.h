@@ -0,0 +1,63 @@
+#ifndef PLANTTABLE_H
+#define PLANTTABLE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "AnalogFilter.h"
+
+// Soil probes of one zone, stored column by column: the scan walks the pin
+// and reading columns and the watering check the thresholds, each a short
+// contiguous array, instead of striding over whole records. The table owns
+// its storage and grows with the plant set; there is no fixed limit.
+//
+// Readings are the filtered raw ADC values. Calibration maps them to a
+// moisture percentage per probe and defaults to the values the backend
+// uses for telemetry.
+class PlantTable
+{
+public:
+    static const uint16_t DEFAULT_DRY_RAW = 3900;
+    static const uint16_t DEFAULT_WET_RAW = 1200;
+
+    void clear();
+    void reserve(int count);
+    // Appends a plant, returns its index
+    int add(const String &plantId, uint8_t pin, float minMoisture, float maxMoisture);
+    // Takes calibration, filter history and last reading of a probe kept across a plant update
+    void carryOver(int index, const PlantTable &from, int fromIndex);
+    void swap(PlantTable &other);
+
+    int size() const;
+    // Index of the plant on pin, -1 if none
+    int indexOfPin(int pin) const;
+
+    uint8_t getPin(int index) const;
+    const String &getId(int index) const;
+    float getMinMoisture(int index) const;
+    float getMaxMoisture(int index) const;
+
+    void setCalibration(int index, uint16_t dryRaw, uint16_t wetRaw);
+    // raw through the plant's calibration, 0..100 %
+    float toPercent(int index, float raw) const;
+
+    bool hasReading(int index) const;
+    uint16_t getReading(int index) const;
+    uint32_t getReadAtMs(int index) const;
+    void setReading(int index, uint16_t raw, uint32_t nowMs);
+
+    AnalogFilter &filter(int index);
+    const AnalogFilter &filter(int index) const;
+
+private:
+    std::vector<uint8_t> pins;
+    std::vector<uint16_t> readings;
+    std::vector<uint32_t> readAtMs;
+    std::vector<uint16_t> dryRaw;
+    std::vector<uint16_t> wetRaw;
+    std::vector<float> minMoisture;     // %
+    std::vector<float> maxMoisture;     // %
+    std::vector<AnalogFilter> filters;
+    std::vector<String> ids;
+};
+
+#endif
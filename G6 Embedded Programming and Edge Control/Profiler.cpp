@@ -0,0 +1,141 @@
+#include "Profiler.h"
+
+#if PROFILING
+
+#include "PayloadSerializer.h"
+
+static const char *const PHASE_NAMES[PHASE_COUNT] = {
+    "adc", "sensors", "rules", "actuate", "feedback",
+    "serialize", "post", "fetch", "mqttpoll", "mqttpub"};
+
+LatencyHistogram Profiler::histograms[PHASE_COUNT];
+std::atomic<uint32_t> Profiler::windows[PHASE_COUNT];
+std::atomic<uint32_t> Profiler::currentWindow(0);
+const LatencyHistogram Profiler::EMPTY;
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+uint32_t LatencyHistogram::getCount() const
+{
+    return count;
+}
+
+uint32_t LatencyHistogram::getMax() const
+{
+    return max;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t p) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    // Rank of the sample at p, rounded up
+    uint32_t rank = ((uint64_t)count * p + 99) / 100;
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        {
+            uint32_t upper = i == 0 ? 1 : (2UL << i) - 1;
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+void LatencyHistogram::reset()
+{
+    memset(counts, 0, sizeof(counts));
+    count = 0;
+    max = 0;
+}
+
+const LatencyHistogram &Profiler::histogram(ProfilePhase phase)
+{
+    // Pairs with the release in record(): a histogram of the current window has been cleared
+    if (windows[phase].load(std::memory_order_acquire) != currentWindow.load(std::memory_order_relaxed))
+    {
+        return EMPTY;
+    }
+    return histograms[phase];
+}
+
+const char *Profiler::phaseName(ProfilePhase phase)
+{
+    return phase < PHASE_COUNT ? PHASE_NAMES[phase] : "?";
+}
+
+int Profiler::writeSummary(BufferPrint &out, int first)
+{
+    out.write('{');
+    bool empty = true;
+    int phase = first;
+    for (; phase < PHASE_COUNT; phase++)
+    {
+        const LatencyHistogram &h = histogram((ProfilePhase)phase);
+        if (h.getCount() == 0)
+        {
+            continue;
+        }
+
+        size_t mark = out.length();
+        out.printf("%s\"%s\":[%lu,%lu,%lu,%lu]", empty ? "" : ",", PHASE_NAMES[phase],
+                   (unsigned long)h.getCount(), (unsigned long)h.percentile(50),
+                   (unsigned long)h.percentile(99), (unsigned long)h.getMax());
+        // Keep room for the closing brace; an entry that does not fit starts the next message
+        if (out.overflowed() || out.remaining() < 1)
+        {
+            out.truncate(mark);
+            break;
+        }
+        empty = false;
+    }
+    out.write('}');
+    return phase;
+}
+
+void Profiler::reset()
+{
+    currentWindow.fetch_add(1, std::memory_order_release);
+}
+
+uint32_t Profiler::calibrate()
+{
+    const int ROUNDS = 1000;
+    LatencyHistogram scratch;
+    unsigned long start = Hal::micros();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        // What a PROFILE_SCOPE does, into a histogram nobody reports
+        unsigned long scopeStart = Hal::micros();
+        scratch.record(Hal::micros() - scopeStart);
+    }
+    return (uint32_t)((Hal::micros() - start) * 1000UL / ROUNDS);
+}
+
+void Profiler::printStats()
+{
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        const LatencyHistogram &h = histogram((ProfilePhase)i);
+        if (h.getCount() == 0)
+        {
+            continue;
+        }
+        Serial.printf("[PROFILE] %-9s n: %lu, p50: %lu us, p99: %lu us, max: %lu us\n", PHASE_NAMES[i],
+                      (unsigned long)h.getCount(), (unsigned long)h.percentile(50),
+                      (unsigned long)h.percentile(99), (unsigned long)h.getMax());
+    }
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Hal.h"
+
+// Build with -DPROFILING=0 to compile every PROFILE_SCOPE and the profiler
+// itself out of the firmware
+#ifndef PROFILING
+#define PROFILING 1
+#endif
+
+// Timed phases. Each one is recorded from a single task (control or
+// network), so the histograms need no locking. Only that task ever writes
+// a phase's histogram, resets included (see Profiler::reset()).
+enum ProfilePhase : uint8_t
+{
+    // control task
+    PHASE_ADC,            // filtered analog sampling
+    PHASE_SENSORS,        // SensorModule::acquire
+    PHASE_RULES,          // rule evaluation and the resulting writes
+    PHASE_ACTUATION,      // one queued manual command applied
+    PHASE_FEEDBACK,       // feedback message serialized and queued
+    // network task
+    PHASE_SERIALIZE,      // upload body encoding
+    PHASE_HTTP_POST,      // POST including connection setup
+    PHASE_HTTP_FETCH,     // plant config GET
+    PHASE_MQTT_POLL,      // draining incoming subscriptions
+    PHASE_MQTT_PUBLISH,   // feedback and telemetry publishes
+    PHASE_COUNT
+};
+
+#if PROFILING
+
+// Log2-bucketed latency histogram in microseconds: bucket 0 holds 0-1 µs,
+// bucket i holds [2^i, 2^(i+1)). Percentiles are reported as the upper
+// bound of their bucket (capped at the maximum), so they are exact to a
+// factor of two, which is enough to find where a cycle's time goes.
+class LatencyHistogram
+{
+public:
+    static const uint8_t BUCKETS = 24;   // up to ~16 s
+
+    LatencyHistogram();
+
+    void record(uint32_t us)
+    {
+        uint8_t bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+        counts[bucket < BUCKETS ? bucket : BUCKETS - 1]++;
+        count++;
+        if (us > max)
+        {
+            max = us;
+        }
+    }
+
+    uint32_t getCount() const;
+    uint32_t getMax() const;
+    // p in 0..100
+    uint32_t percentile(uint8_t p) const;
+    void reset();
+
+private:
+    uint32_t counts[BUCKETS];
+    uint32_t count;
+    uint32_t max;
+};
+
+class BufferPrint;
+
+// Histograms of every ProfilePhase, summarized for Serial and for the
+// metrics feed
+class Profiler
+{
+public:
+    static void record(ProfilePhase phase, uint32_t us)
+    {
+        // First record of a new window: the writer clears its own histogram
+        uint32_t window = currentWindow.load(std::memory_order_acquire);
+        if (windows[phase].load(std::memory_order_relaxed) != window)
+        {
+            histograms[phase].reset();
+            windows[phase].store(window, std::memory_order_release);
+        }
+        histograms[phase].record(us);
+    }
+
+    // Empty if the phase has not been recorded since the last reset()
+    static const LatencyHistogram &histogram(ProfilePhase phase);
+    static const char *phaseName(ProfilePhase phase);
+
+    // Compact JSON {"adc":[n,p50,p99,max],...} of the phases from first on,
+    // as many as fit out; returns the phase to continue from in the next
+    // message, PHASE_COUNT once all are written. Phases without samples are skipped.
+    static int writeSummary(BufferPrint &out, int first);
+    // Starts a new window for the next summary. Callable from any task: the
+    // histograms are not touched here but cleared by their writers on their
+    // next record(), and until then reported as empty.
+    static void reset();
+
+    // Measures the cost of an empty scope, in ns
+    static uint32_t calibrate();
+    static void printStats();
+
+private:
+    static LatencyHistogram histograms[PHASE_COUNT];
+    // Window each histogram holds; written by the phase's task only
+    static std::atomic<uint32_t> windows[PHASE_COUNT];
+    static std::atomic<uint32_t> currentWindow;
+    static const LatencyHistogram EMPTY;
+};
+
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(ProfilePhase phase) : phase(phase), start(Hal::micros())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        Profiler::record(phase, Hal::micros() - start);
+    }
+
+private:
+    ProfilePhase phase;
+    unsigned long start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+// Times the rest of the enclosing scope as phase
+#define PROFILE_SCOPE(phase) ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)(phase)
+
+#else
+
+#define PROFILE_SCOPE(phase) do {} while (0)
+
+#endif
+
+#endif
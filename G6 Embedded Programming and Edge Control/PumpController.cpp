@@ -0,0 +1,191 @@
+#include "PumpController.h"
+#include "Log.h"
+
+const PumpController::Config PumpController::DEFAULT_CONFIG = {1000, 8000, 20000, 6, 2.0f, 0.3f, 0.0f};
+const float PumpController::MIN_GAIN = 0.05f;
+const float PumpController::MAX_GAIN = 50.0f;
+const float PumpController::MIN_OBSERVED_DELTA = 0.5f;
+
+PumpController::PumpController(PumpOutput output, ClockSource clock)
+{
+    this->output = output;
+    this->clock = clock;
+    state = IDLE;
+    finished = false;
+    cycleStartedAt = 0;
+    phaseStartedAt = 0;
+    pulseMs = 0;
+    moistureBeforePulse = 0;
+    memset(&report, 0, sizeof(report));
+    configure(DEFAULT_CONFIG);
+}
+
+void PumpController::configure(const Config &config)
+{
+    this->config = config;
+    if (this->config.maxPulseMs < this->config.minPulseMs)
+    {
+        this->config.maxPulseMs = this->config.minPulseMs;
+    }
+    if (this->config.maxPulses == 0)
+    {
+        this->config.maxPulses = 1;
+    }
+    this->config.learningRate = constrain(config.learningRate, 0.0f, 1.0f);
+    setGain(config.initialGain);
+}
+
+uint32_t PumpController::now() const
+{
+    return (uint32_t)clock();
+}
+
+bool PumpController::start(float moisture, float targetMoisture)
+{
+    if (state != IDLE || isnan(moisture) || moisture >= targetMoisture)
+    {
+        return false;
+    }
+
+    memset(&report, 0, sizeof(report));
+    report.startMoisture = moisture;
+    report.targetMoisture = targetMoisture;
+    cycleStartedAt = now();
+    finished = false;
+    startPulse(moisture);
+    return true;
+}
+
+void PumpController::startPulse(float moisture)
+{
+    // Size the pulse to close the deficit at the learned rate
+    float seconds = (report.targetMoisture - moisture) / gain;
+    uint32_t ms = seconds * 1000.0f;
+    pulseMs = constrain(ms, config.minPulseMs, config.maxPulseMs);
+
+    moistureBeforePulse = moisture;
+    phaseStartedAt = now();
+    state = PULSING;
+    report.pulses++;
+    LOG_DEBUG("[PUMP] pulse %u: %lu ms (%.1f%% -> %.1f%%, %.2f %%/s)", report.pulses,
+              (unsigned long)pulseMs, moisture, report.targetMoisture, gain);
+    output(true);
+}
+
+void PumpController::update(float moisture)
+{
+    uint32_t elapsed = now() - phaseStartedAt;
+
+    if (state == PULSING)
+    {
+        if (elapsed < pulseMs)
+        {
+            return;
+        }
+        output(false);
+        report.pumpOnMs += elapsed;
+        phaseStartedAt = now();
+        state = SOAKING;
+        return;
+    }
+
+    if (state != SOAKING || elapsed < config.soakMs || isnan(moisture))
+    {
+        return;
+    }
+
+    learn(moisture);
+    if (moisture >= report.targetMoisture)
+    {
+        finish(moisture, true);
+    }
+    else if (report.pulses >= config.maxPulses)
+    {
+        finish(moisture, false);
+    }
+    else
+    {
+        startPulse(moisture);
+    }
+}
+
+void PumpController::learn(float moisture)
+{
+    float delta = moisture - moistureBeforePulse;
+    float observed = delta / (pulseMs / 1000.0f);
+
+    if (delta < MIN_OBSERVED_DELTA)
+    {
+        // The pulse did not register: the zone is slower than assumed
+        observed = gain * (1.0f - config.learningRate);
+    }
+    setGain(gain + config.learningRate * (observed - gain));
+}
+
+void PumpController::finish(float moisture, bool reachedTarget)
+{
+    output(false);
+    state = IDLE;
+    finished = true;
+    report.endMoisture = moisture;
+    report.reachedTarget = reachedTarget;
+    report.durationMs = now() - cycleStartedAt;
+    report.waterMl = report.pumpOnMs / 1000.0f * config.flowMlPerSecond;
+}
+
+void PumpController::stop()
+{
+    if (state == PULSING)
+    {
+        report.pumpOnMs += now() - phaseStartedAt;
+    }
+    if (state != IDLE)
+    {
+        finish(NAN, false);
+    }
+}
+
+bool PumpController::isActive() const
+{
+    return state != IDLE;
+}
+
+PumpController::State PumpController::getState() const
+{
+    return state;
+}
+
+bool PumpController::takeFinished()
+{
+    bool wasFinished = finished;
+    finished = false;
+    return wasFinished;
+}
+
+float PumpController::getGain() const
+{
+    return gain;
+}
+
+void PumpController::setGain(float gain)
+{
+    if (isnan(gain))
+    {
+        return;
+    }
+    this->gain = constrain(gain, MIN_GAIN, MAX_GAIN);
+}
+
+const PumpController::CycleReport &PumpController::lastCycle() const
+{
+    return report;
+}
+
+void PumpController::printReport() const
+{
+    Serial.printf("[PUMP] cycle %s: %u pulses, pump on %lu ms, ~%.0f ml, %.1f%% -> %.1f%% (target %.1f%%) in %lu ms, response %.2f %%/s\n",
+                  report.reachedTarget ? "reached target" : "stopped",
+                  report.pulses, (unsigned long)report.pumpOnMs, report.waterMl,
+                  report.startMoisture, report.endMoisture, report.targetMoisture,
+                  (unsigned long)report.durationMs, gain);
+}
@@ -0,0 +1,103 @@
+#ifndef PUMPCONTROLLER_H
+#define PUMPCONTROLLER_H
+
+#include <Arduino.h>
+#include <functional>
+#include "Hal.h"
+
+// Closed-loop watering in pulses.
+//
+// A cycle alternates a timed pump pulse with a soak interval, then checks the
+// moisture again. Each pulse is sized from the remaining deficit and the
+// learned zone response (moisture % gained per second of pumping), which is
+// refined after every soak from what the pulse actually achieved. The cycle
+// ends when the target is reached, after maxPulses, or on stop().
+// update() never blocks; call it from a periodic task.
+class PumpController
+{
+public:
+    // Switches the pump; bound to the zone the controller waters
+    typedef std::function<void(bool on)> PumpOutput;
+    typedef unsigned long (*ClockSource)();
+
+    enum State : uint8_t
+    {
+        IDLE,
+        PULSING,
+        SOAKING
+    };
+
+    struct Config
+    {
+        uint32_t minPulseMs;
+        uint32_t maxPulseMs;
+        uint32_t soakMs;
+        uint8_t maxPulses;
+        float initialGain;        // % per second of pumping, used until learned
+        float learningRate;       // 0..1, weight of the newest observation
+        float flowMlPerSecond;    // pump flow, for the water estimate (0 = unknown)
+    };
+
+    struct CycleReport
+    {
+        uint32_t pumpOnMs;
+        uint8_t pulses;
+        float startMoisture;
+        float endMoisture;
+        float targetMoisture;
+        float waterMl;
+        uint32_t durationMs;      // start to stop; time to target when reachedTarget
+        bool reachedTarget;
+    };
+
+    static const Config DEFAULT_CONFIG;
+
+    explicit PumpController(PumpOutput output, ClockSource clock = Hal::millis);
+
+    // Also resets the learned response to config.initialGain
+    void configure(const Config &config);
+
+    // Starts a cycle towards targetMoisture. Returns false if already at target or running.
+    bool start(float moisture, float targetMoisture);
+    // Advances the cycle with the current moisture reading (%)
+    void update(float moisture);
+    // Ends the cycle early with the pump off
+    void stop();
+
+    bool isActive() const;
+    State getState() const;
+    // True once after a cycle ended, for reporting
+    bool takeFinished();
+
+    float getGain() const;
+    void setGain(float gain);
+
+    const CycleReport &lastCycle() const;
+    void printReport() const;
+
+private:
+    static const float MIN_GAIN;
+    static const float MAX_GAIN;
+    // Smaller changes are treated as sensor noise
+    static const float MIN_OBSERVED_DELTA;
+
+    PumpOutput output;
+    ClockSource clock;
+    Config config;
+    State state;
+    float gain;
+    bool finished;
+
+    uint32_t cycleStartedAt;
+    uint32_t phaseStartedAt;
+    uint32_t pulseMs;
+    float moistureBeforePulse;
+    CycleReport report;
+
+    void startPulse(float moisture);
+    void learn(float moisture);
+    void finish(float moisture, bool reachedTarget);
+    uint32_t now() const;
+};
+
+#endif
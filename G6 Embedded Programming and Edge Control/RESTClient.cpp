@@ -1,70 +1,371 @@
 #include "RESTClient.h"
+#include "Log.h"
+
+// Sink used to consume response bodies nobody reads, so the connection
+// is left at a message boundary and can be reused
+class DiscardStream : public Stream
+{
+public:
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t *, size_t size) override { return size; }
+};
+
+// Response body read straight off the connection, for parsing as it
+// arrives. Undoes chunked transfer encoding and ends at the end of the body,
+// so nothing of the next response on a kept-alive connection is read.
+// Waiting is left to the connection's own timeout; failed() tells a body cut
+// short by it, or by the server, from a complete one.
+class HttpBodyStream : public Stream
+{
+public:
+    // length: Content-Length, -1 if the body runs until the connection closes
+    HttpBodyStream(Stream &source, bool chunked, int length)
+        : source(source), chunked(chunked), remaining(chunked ? 0 : length), peeked(-1),
+          ended(!chunked && length == 0), cut(false), firstChunk(true)
+    {
+        setTimeout(0);
+    }
+
+    int available() override { return peeked >= 0 || (!ended && source.available() > 0) ? 1 : 0; }
+
+    int read() override
+    {
+        int c = peek();
+        peeked = -1;
+        return c;
+    }
+
+    int peek() override
+    {
+        if (peeked < 0)
+        {
+            peeked = next();
+        }
+        return peeked;
+    }
+
+    size_t write(uint8_t) override { return 0; }
+
+    bool failed() const { return cut; }
+
+private:
+    Stream &source;
+    bool chunked;
+    long remaining;     // bytes left in the chunk, or in the body; -1 = unknown
+    int peeked;
+    bool ended;
+    bool cut;
+    bool firstChunk;
+
+    int sourceByte()
+    {
+        uint8_t c;
+        if (source.readBytes(&c, 1) != 1)
+        {
+            return -1;
+        }
+        return c;
+    }
+
+    // Next line of the chunk framing, without the CRLF
+    bool readLine(char *line, size_t size)
+    {
+        size_t length = 0;
+        while (true)
+        {
+            int c = sourceByte();
+            if (c < 0)
+            {
+                return false;
+            }
+            if (c == '\n')
+            {
+                line[length] = '\0';
+                return true;
+            }
+            if (c != '\r' && length + 1 < size)
+            {
+                line[length++] = c;
+            }
+        }
+    }
+
+    // Reads the next chunk header; false at the end of the body
+    bool nextChunk()
+    {
+        char line[32];
+        // Every chunk but the first follows the CRLF closing the previous one
+        if (!firstChunk && (!readLine(line, sizeof(line)) || line[0] != '\0'))
+        {
+            cut = true;
+            return false;
+        }
+        firstChunk = false;
+        if (!readLine(line, sizeof(line)))
+        {
+            cut = true;
+            return false;
+        }
+        // Chunk extensions after ';' are ignored
+        remaining = strtol(line, nullptr, 16);
+        if (remaining > 0)
+        {
+            return true;
+        }
+        // Last chunk: skip the trailer up to its empty line
+        while (readLine(line, sizeof(line)) && line[0] != '\0')
+        {
+        }
+        return false;
+    }
+
+    int next()
+    {
+        if (ended)
+        {
+            return -1;
+        }
+        if (chunked && remaining == 0 && !nextChunk())
+        {
+            ended = true;
+            return -1;
+        }
+        int c = sourceByte();
+        if (c < 0)
+        {
+            ended = true;
+            // Without a length the body ends when the server closes
+            cut = remaining >= 0;
+            return -1;
+        }
+        if (remaining > 0 && --remaining == 0 && !chunked)
+        {
+            ended = true;
+        }
+        return c;
+    }
+};
 
 RESTClient::RESTClient(const String &serverUrl, bool insecure)
 {
     this->serverUrl = serverUrl;
     this->useInsecure = insecure;
+    payloadFormat = FORMAT_JSON;
+    batchUploads = false;
+    sensorDataUrl = serverUrl + "/api/v1/sensor-data";
+    sensorBatchUrl = serverUrl + "/api/v1/sensor-data/batch";
+    zonesUrl = serverUrl + "/api/v1/zones/";
+    actionLogUrl = serverUrl + "/api/v1/logs/action/";
+    memset(&stats, 0, sizeof(stats));
+
+    if (useInsecure)
+    {
+        client.setInsecure();
+    }
+    http.setReuse(true);
+}
+
+bool RESTClient::beginRequest(const char *endpoint)
+{
+    stats.requests++;
+    if (client.connected())
+    {
+        stats.reusedRequests++;
+    }
+    else
+    {
+        stats.handshakes++;
+    }
+
+    if (!http.begin(client, endpoint))
+    {
+        stats.failures++;
+        return false;
+    }
+    return true;
+}
+
+void RESTClient::endRequest(int httpResponseCode, bool drainBody)
+{
+    if (httpResponseCode <= 0)
+    {
+        // Transport error: drop the socket so the next request starts clean
+        stats.failures++;
+        client.stop();
+    }
+    else if (drainBody)
+    {
+        DiscardStream discard;
+        http.writeToStream(&discard);
+    }
+    http.end();
+}
+
+const ConnectionStats &RESTClient::getConnectionStats() const
+{
+    return stats;
+}
+
+void RESTClient::printConnectionStats()
+{
+    Serial.printf("[REST] requests: %lu, handshakes: %lu, reused: %lu, failures: %lu, rejected: %lu, bytes sent: %lu (%s), post us last/max: %lu/%lu\n",
+                  (unsigned long)stats.requests, (unsigned long)stats.handshakes,
+                  (unsigned long)stats.reusedRequests, (unsigned long)stats.failures, (unsigned long)stats.rejected,
+                  (unsigned long)stats.bytesSent, payloadFormat == FORMAT_CBOR ? "cbor" : "json",
+                  (unsigned long)stats.lastPostUs, (unsigned long)stats.maxPostUs);
 }
 
 std::vector<PlantData> RESTClient::getPlantsByZone(const String &zoneId)
 {
     std::vector<PlantData> plantList;
-    String endpoint = serverUrl + "/api/v1/zones/" + zoneId + "/plants";
+    forEachPlantInZone(zoneId, [&plantList](const PlantData &data) {
+        plantList.push_back(data);
+    });
+    return plantList;
+}
 
-    WiFiClientSecure client;
-    if (useInsecure)
+bool RESTClient::forEachPlantInZone(const String &zoneId, PlantCallback onPlant)
+{
+    return streamPlants(zoneId, "", onPlant, nullptr) == PLANTS_UPDATED;
+}
+
+PlantFetchResult RESTClient::fetchPlantsIfChanged(
+    const String &zoneId,
+    const String &etag,
+    std::vector<PlantData> &plants,
+    String &newEtag)
+{
+    std::vector<PlantData> fresh;
+    PlantFetchResult result = streamPlants(zoneId, etag, [&fresh](const PlantData &data) {
+        fresh.push_back(data);
+    }, &newEtag);
+
+    if (result == PLANTS_UPDATED)
     {
-        client.setInsecure();
+        plants.swap(fresh);
+    }
+    return result;
+}
+
+PlantFetchResult RESTClient::streamPlants(const String &zoneId, const String &etag, PlantCallback onPlant, String *etagOut)
+{
+    PROFILE_SCOPE(PHASE_HTTP_FETCH);
+    char endpoint[URL_CAPACITY];
+    snprintf(endpoint, sizeof(endpoint), "%s%s/plants", zonesUrl.c_str(), zoneId.c_str());
+
+    if (!beginRequest(endpoint))
+    {
+        return PLANTS_FETCH_FAILED;
     }
 
-    HTTPClient http;
-    http.begin(client, endpoint);
+    if (etag != "")
+    {
+        http.addHeader("If-None-Match", etag);
+    }
+    const char *headerKeys[] = {"ETag", "Transfer-Encoding"};
+    http.collectHeaders(headerKeys, 2);
 
     int httpResponseCode = http.GET();
-    if (httpResponseCode > 0)
+
+    if (httpResponseCode == HTTP_CODE_NOT_MODIFIED)
     {
-        String response = http.getString();
+        endRequest(httpResponseCode);
+        return PLANTS_NOT_MODIFIED;
+    }
 
-        StaticJsonDocument<8192> doc;
-        DeserializationError error = deserializeJson(doc, response);
-        if (error)
-        {
-            Serial.print("JSON parse error: ");
-            Serial.println(error.c_str());
-            http.end();
-            return plantList;
-        }
+    if (httpResponseCode != HTTP_CODE_OK)
+    {
+        LOG_WARN("HTTP error code: %d", httpResponseCode);
+        endRequest(httpResponseCode);
+        return PLANTS_FETCH_FAILED;
+    }
+
+    if (etagOut != nullptr)
+    {
+        *etagOut = http.header("ETag");
+    }
+
+    // Only the fields PlantData needs are kept from each plant object
+    StaticJsonDocument<256> filter;
+    filter["plantId"] = true;
+    filter["moisturePin"] = true;
+    JsonObject thresholds = filter.createNestedObject("thresholds");
+    const char *metrics[] = {"moisture", "temperature", "light", "airQuality"};
+    for (const char *metric : metrics)
+    {
+        thresholds[metric]["min"] = true;
+        thresholds[metric]["max"] = true;
+    }
+
+    // Parsed as it arrives, one plant at a time: only the filter and one
+    // plant document are held, however long the list is
+    HttpBodyStream stream(http.getStream(), http.header("Transfer-Encoding").equalsIgnoreCase("chunked"),
+                          http.getSize());
+
+    bool ok = true;
+    int count = 0;
 
-        JsonArray plants = doc["plants"].as<JsonArray>();
-        for (JsonObject plant : plants)
+    // Walk the "plants" array one element at a time
+    if (stream.find("\"plants\"") && stream.find("["))
+    {
+        StaticJsonDocument<512> doc;
+        do
         {
+            DeserializationError error = deserializeJson(doc, stream, DeserializationOption::Filter(filter));
+            if (error)
+            {
+                // An empty array ends right at the first element
+                if (count > 0 || error != DeserializationError::InvalidInput)
+                {
+                    LOG_WARN("JSON parse error: %s", error.c_str());
+                    ok = false;
+                }
+                break;
+            }
+
             PlantData data;
-            data.plantId = plant["plantId"].as<String>();
-            data.moisturePin = plant["moisturePin"].as<int>();
+            data.plantId = doc["plantId"].as<String>();
+            data.moisturePin = doc["moisturePin"].as<int>();
 
-            data.min_moisture = plant["thresholds"]["moisture"]["min"].as<float>();
-            data.max_moisture = plant["thresholds"]["moisture"]["max"].as<float>();
+            data.min_moisture = doc["thresholds"]["moisture"]["min"].as<float>();
+            data.max_moisture = doc["thresholds"]["moisture"]["max"].as<float>();
 
-            data.min_temperature = plant["thresholds"]["temperature"]["min"].as<float>();
-            data.max_temperature = plant["thresholds"]["temperature"]["max"].as<float>();
+            data.min_temperature = doc["thresholds"]["temperature"]["min"].as<float>();
+            data.max_temperature = doc["thresholds"]["temperature"]["max"].as<float>();
 
-            data.min_light = plant["thresholds"]["light"]["min"].as<float>();
-            data.max_light = plant["thresholds"]["light"]["max"].as<float>();
+            data.min_light = doc["thresholds"]["light"]["min"].as<float>();
+            data.max_light = doc["thresholds"]["light"]["max"].as<float>();
 
-            data.min_airQuality = plant["thresholds"]["airQuality"]["min"].as<float>();
-            data.max_airQuality = plant["thresholds"]["airQuality"]["max"].as<float>();
+            data.min_airQuality = doc["thresholds"]["airQuality"]["min"].as<float>();
+            data.max_airQuality = doc["thresholds"]["airQuality"]["max"].as<float>();
 
-            plantList.push_back(data);
-        }
+            onPlant(data);
+            count++;
+        } while (stream.findUntil(",", "]"));
     }
     else
     {
-        Serial.print("HTTP error code: ");
-        Serial.println(httpResponseCode);
+        LOG_WARN("No plants array in response");
+        ok = false;
     }
 
-    http.end();
-    return plantList;
+    // Skip what follows the array so the connection is left at the end of
+    // the response; one cut short cannot be reused
+    while (stream.read() >= 0)
+    {
+    }
+    if (stream.failed())
+    {
+        LOG_WARN("Plant response cut short");
+        client.stop();
+        ok = false;
+    }
+    endRequest(httpResponseCode, false);
+
+    return ok ? PLANTS_UPDATED : PLANTS_FETCH_FAILED;
 }
 
 bool RESTClient::sendZoneSensorData(
@@ -77,132 +378,278 @@ bool RESTClient::sendZoneSensorData(
     const String &userId,
     const String &timestamp)
 {
-    String endpoint = serverUrl + "/api/v1/sensor-data";
-
-    WiFiClientSecure client;
-    if (useInsecure)
-    {
-        client.setInsecure();
-    }
+    BufferPrint body(payload, sizeof(payload));
+    JsonWriter json(body);
 
-    HTTPClient http;
-    http.begin(client, endpoint);
-    http.addHeader("Content-Type", "application/json");
+    json.beginObject();
+    json.field("zoneId", zoneId);
 
-    StaticJsonDocument<1024> doc;
+    json.beginObject("zoneSensors");
+    json.field("humidity", isnan(humidity) ? 0.0f : humidity);
+    json.field("temp", isnan(temperature) ? 0.0f : temperature);
+    json.field("light", isnan(light) ? 0.0f : light);
+    json.field("airQuality", isnan(airQuality) ? 0.0f : airQuality);
+    json.endObject();
 
-    doc["zoneId"] = zoneId;
-
-    JsonObject zoneSensors = doc.createNestedObject("zoneSensors");
-    zoneSensors["humidity"] = isnan(humidity) ? 0.0f : humidity;
-    zoneSensors["temp"] = isnan(temperature) ? 0.0f : temperature;
-    zoneSensors["light"] = isnan(light) ? 0.0f : light;
-    ;
-    zoneSensors["airQuality"] = isnan(airQuality) ? 0.0f : airQuality;
-
-    JsonArray soilArray = doc.createNestedArray("soilMoistureByPin");
+    json.beginArray("soilMoistureByPin");
     for (const auto &pair : soilMoistureByPin)
     {
-        JsonObject entry = soilArray.createNestedObject();
-        entry["pin"] = pair.first;
-
-        // Convert raw ADC to percentage (100% = very wet, 0% = very dry)
-        int rawValue = pair.second;
-        float moisturePercent = map(rawValue, 3900, 1200, 0, 100);
-        moisturePercent = constrain(moisturePercent, 0, 100);
-
-        entry["soilMoisture"] = moisturePercent;
+        json.beginObject();
+        json.field("pin", pair.first);
+        json.field("soilMoisture", PayloadSerializer::toMoisturePercent(pair.second));
+        json.endObject();
     }
+    json.endArray();
 
     if (userId != "")
-        doc["userId"] = userId;
+        json.field("userId", userId);
     if (timestamp != "")
-        doc["timestamp"] = timestamp;
+        json.field("timestamp", timestamp);
+    json.endObject();
 
-    String requestBody;
-    serializeJson(doc, requestBody);
+    if (body.overflowed())
+    {
+        LOG_WARN("Zone sensor payload too large");
+        return false;
+    }
 
-    int httpResponseCode = http.POST(requestBody);
+    int httpResponseCode = post(sensorDataUrl.c_str(), body);
 
-    if (httpResponseCode > 0)
+    if (classify(httpResponseCode) == POST_SENT)
     {
-        Serial.print("Zone sensor data sent");
-        Serial.println(httpResponseCode);
-        http.end();
+        LOG_INFO("Zone sensor data sent %d", httpResponseCode);
         return true;
     }
     else
     {
-        Serial.print("Failed to send zone sensor data. Code: ");
-        Serial.println(httpResponseCode);
-        http.end();
+        LOG_WARN("Failed to send zone sensor data. Code: %d", httpResponseCode);
         return false;
     }
 }
 
-bool RESTClient::sendActuatorLog(
-    const String &action_name,
-    const String &action,
-    const String &actuatorId,
-    const String &plantId,
-    const String &trigger,
-    const String &zone,
-    const String &triggerBy,
+bool RESTClient::sendZoneSensorData(
+    const String &zoneId,
+    const SensorSnapshot &snapshot,
+    const String &userId,
     const String &timestamp)
 {
-    String endpoint = serverUrl + "/api/v1/logs/action/" + action_name;
+    ZoneSample sample;
+    sample.setReadings(snapshot);
+    strncpy(sample.timestamp, timestamp.c_str(), sizeof(sample.timestamp) - 1);
+    sample.timestamp[sizeof(sample.timestamp) - 1] = '\0';
+    // The binary form carries time as a number, taken from the clock
+    sample.epoch = ClockService::epochSeconds();
+
+    return postSample(zoneId, sample, userId) == POST_SENT;
+}
 
-    WiFiClientSecure client;
-    if (useInsecure)
+PostOutcome RESTClient::postSample(const String &zoneId, const ZoneSample &sample, const String &userId)
+{
+    BufferPrint body(payload, sizeof(payload));
+    if (payloadFormat == FORMAT_CBOR)
     {
-        client.setInsecure();
+        // A batch of one
+        PayloadSerializer::sensorBatch(body, zoneId, &sample, 1, userId, FORMAT_CBOR);
+    }
+    else
+    {
+        JsonWriter json(body);
+        PayloadSerializer::zoneSample(json, zoneId, sample, userId);
     }
 
-    HTTPClient http;
-    http.begin(client, endpoint);
-    http.addHeader("Content-Type", "application/json");
+    if (body.overflowed())
+    {
+        // Cannot shrink on a retry either
+        LOG_WARN("Zone sensor payload too large");
+        return POST_REJECTED;
+    }
 
-    // Create the JSON payload
-    StaticJsonDocument<512> doc;
+    int httpResponseCode = post(sensorDataUrl.c_str(), body, PayloadSerializer::contentType(payloadFormat));
+    PostOutcome outcome = classify(httpResponseCode);
+    if (outcome == POST_SENT)
+    {
+        LOG_DEBUG("Zone sensor data sent %d", httpResponseCode);
+    }
+    else
+    {
+        LOG_WARN("Failed to send zone sensor data. Code: %d", httpResponseCode);
+    }
+    return outcome;
+}
+
+BatchResult RESTClient::sendZoneSensorBatch(
+    const String &zoneId,
+    const TelemetryBuffer &buffer,
+    int count,
+    const String &userId)
+{
+    return sendSamples(zoneId, [&buffer](int i) -> const ZoneSample & { return buffer.at(i); },
+                       min(count, buffer.size()), userId);
+}
 
-    doc["action"] = action;
-    doc["actuatorId"] = actuatorId;
-    doc["plantId"] = plantId;
-    doc["trigger"] = trigger;
-    doc["zone"] = zone;
+BatchResult RESTClient::sendZoneSensorBatch(
+    const String &zoneId,
+    const ZoneSample *samples,
+    int count,
+    const String &userId)
+{
+    return sendSamples(zoneId, [samples](int i) -> const ZoneSample & { return samples[i]; }, count, userId);
+}
 
-    if (triggerBy != "")
+BatchResult RESTClient::sendSamples(const String &zoneId, const PayloadSerializer::SampleSource &sampleAt, int count, const String &userId)
+{
+    BatchResult result = {0, 0};
+    if (!batchUploads)
     {
-        doc["triggerBy"] = triggerBy;
+        // One POST per sample on the kept-alive connection; stop at the first
+        // one worth retrying so the rest stay in order
+        for (int i = 0; i < count; i++)
+        {
+            PostOutcome outcome = postSample(zoneId, sampleAt(i), userId);
+            if (outcome == POST_RETRY)
+            {
+                break;
+            }
+            if (outcome == POST_SENT)
+            {
+                result.sent++;
+            }
+            else
+            {
+                result.rejected++;
+            }
+        }
+        return result;
     }
 
-    if (timestamp != "")
+    BufferPrint body(payload, sizeof(payload));
+    int written;
+    {
+        PROFILE_SCOPE(PHASE_SERIALIZE);
+        written = PayloadSerializer::sensorBatch(body, zoneId, sampleAt, count, userId, payloadFormat);
+    }
+    if (written <= 0)
+    {
+        LOG_WARN("No samples fit the payload buffer");
+        // The oldest sample alone is too large, it can never be sent
+        result.rejected = count > 0 ? 1 : 0;
+        return result;
+    }
+
+    int httpResponseCode = post(sensorBatchUrl.c_str(), body, PayloadSerializer::contentType(payloadFormat));
+    if (httpResponseCode == HTTP_CODE_NOT_FOUND)
+    {
+        LOG_WARN("Batch endpoint not served (404), posting samples one by one");
+        batchUploads = false;
+        return sendSamples(zoneId, sampleAt, count, userId);
+    }
+    PostOutcome outcome = classify(httpResponseCode);
+    if (outcome == POST_SENT)
+    {
+        LOG_INFO("Zone sensor batch sent (%d samples) %d", written, httpResponseCode);
+        result.sent = written;
+    }
+    else if (outcome == POST_REJECTED)
+    {
+        LOG_WARN("Zone sensor batch of %d samples rejected, dropped. Code: %d", written, httpResponseCode);
+        result.rejected = written;
+    }
+    else
+    {
+        LOG_WARN("Failed to send zone sensor batch. Code: %d", httpResponseCode);
+    }
+    return result;
+}
+
+void RESTClient::setBatchUploads(bool enabled)
+{
+    batchUploads = enabled;
+}
+
+bool RESTClient::usesBatchUploads() const
+{
+    return batchUploads;
+}
+
+PostOutcome RESTClient::classify(int httpResponseCode)
+{
+    if (httpResponseCode >= 200 && httpResponseCode < 300)
+    {
+        return POST_SENT;
+    }
+    // Transport errors are negative; 5xx and 429 are the server asking for a later retry
+    if (httpResponseCode <= 0 || httpResponseCode >= 500 || httpResponseCode == 429)
     {
-        doc["timestamp"] = timestamp;
+        return POST_RETRY;
     }
+    stats.rejected++;
+    return POST_REJECTED;
+}
+
+void RESTClient::setPayloadFormat(PayloadFormat format)
+{
+    payloadFormat = format;
+}
+
+PayloadFormat RESTClient::getPayloadFormat() const
+{
+    return payloadFormat;
+}
+
+int RESTClient::post(const char *endpoint, const BufferPrint &body, const char *contentType)
+{
+    PROFILE_SCOPE(PHASE_HTTP_POST);
+    unsigned long start = micros();
+    if (!beginRequest(endpoint))
+    {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    http.addHeader("Content-Type", contentType);
+    stats.bytesSent += body.length();
+
+    int httpResponseCode = http.POST((uint8_t *)body.data(), body.length());
+    endRequest(httpResponseCode);
+
+    uint32_t elapsed = micros() - start;
+    stats.lastPostUs = elapsed;
+    if (elapsed > stats.maxPostUs)
+    {
+        stats.maxPostUs = elapsed;
+    }
+    return httpResponseCode;
+}
+
+bool RESTClient::sendActuatorLog(
+    const String &action_name,
+    const String &action,
+    const String &actuatorId,
+    const String &plantId,
+    const String &trigger,
+    const String &zone,
+    const String &triggerBy,
+    const String &timestamp)
+{
+    char endpoint[URL_CAPACITY];
+    snprintf(endpoint, sizeof(endpoint), "%s%s", actionLogUrl.c_str(), action_name.c_str());
 
-    String requestBody;
-    serializeJson(doc, requestBody);
+    // Create the JSON payload
+    BufferPrint body(payload, sizeof(payload));
+    PayloadSerializer::actuatorLog(body, action.c_str(), actuatorId.c_str(), plantId.c_str(),
+                                   trigger.c_str(), zone.c_str(), triggerBy.c_str(), timestamp.c_str());
 
-    // Optional: Print the request payload for debugging
-    Serial.print("Sending Actuator Log: ");
-    Serial.println(requestBody);
+    // The body itself is too long for a log record, see PayloadSerializer::actuatorLog
+    LOG_DEBUG("Sending Actuator Log: %s, %u bytes", action_name, body.length());
 
-    int httpResponseCode = http.POST(requestBody);
+    int httpResponseCode = post(endpoint, body);
 
-    if (httpResponseCode > 0)
+    if (classify(httpResponseCode) == POST_SENT)
     {
-        String response = http.getString();
-        Serial.print("Log action sent successfully, response: ");
-        Serial.println(response);
-        http.end();
+        LOG_INFO("Log action sent successfully, response: %d", httpResponseCode);
         return true;
     }
     else
     {
-        Serial.print("POST failed, error: ");
-        Serial.println(httpResponseCode);
-        http.end();
+        LOG_WARN("POST failed, error: %d", httpResponseCode);
         return false;
     }
 }
@@ -6,7 +6,13 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <vector>
+#include <functional>
+#include <atomic>
 #include <utility> // for std::pair
+#include "TelemetryBuffer.h"
+#include "PayloadSerializer.h"
+#include "Profiler.h"
+#include "SensorSnapshot.h"
 
 struct PlantData 
 {
@@ -22,14 +28,70 @@ struct PlantData
     float max_airQuality;
 };
 
+// Outcome of a conditional plant refresh
+enum PlantFetchResult
+{
+    PLANTS_UPDATED,
+    PLANTS_NOT_MODIFIED,
+    PLANTS_FETCH_FAILED
+};
+
+// How a request ended. Only a 2xx is sent; transport errors, 5xx and 429
+// are worth retrying later, any other status never will be.
+enum PostOutcome : uint8_t
+{
+    POST_SENT,
+    POST_RETRY,
+    POST_REJECTED
+};
+
+// Samples of an upload the backend accepted, and those it refused for good.
+// The caller drops both; anything else is still to be sent.
+struct BatchResult
+{
+    int sent;
+    int rejected;
+};
+
+// Connection reuse counters; handshakes counts every new TLS session set up
+struct ConnectionStats
+{
+    uint32_t requests;
+    uint32_t handshakes;
+    uint32_t reusedRequests;
+    uint32_t failures;
+    uint32_t rejected;       // 4xx other than 429, the body was dropped
+    uint32_t bytesSent;      // request bodies
+    uint32_t lastPostUs;     // POST call, connection setup included
+    uint32_t maxPostUs;
+};
+
 class RESTClient 
 {
 public:
     RESTClient(const String &serverUrl, bool insecure = true);
 
+    typedef std::function<void(const PlantData &)> PlantCallback;
+
     // Returns a vector of <plantId, soilPin> pairs from a zone
     std::vector<PlantData> getPlantsByZone(const String &zoneId);
 
+    // Parses the zone's plants off the connection as the response arrives and
+    // hands them to onPlant one at a time, so there is no limit on the size
+    // of the response. A body that ends early fails the call, but the plants
+    // before the cut have already been handed out.
+    bool forEachPlantInZone(const String &zoneId, PlantCallback onPlant);
+
+    // Conditional GET of the zone's plants. etag is sent as If-None-Match; on a 304
+    // plants is left untouched. plants is only replaced by a complete, parsed list,
+    // and newEtag receives the ETag it was served with (empty if the server sent none).
+    PlantFetchResult fetchPlantsIfChanged(
+        const String &zoneId,
+        const String &etag,
+        std::vector<PlantData> &plants,
+        String &newEtag
+    );
+
     bool sendZoneSensorData(
         const String &zoneId,
         float temperature,
@@ -41,6 +103,42 @@ public:
         const String &timestamp = ""
     );
 
+    bool sendZoneSensorData(
+        const String &zoneId,
+        const SensorSnapshot &snapshot,
+        const String &userId = "",
+        const String &timestamp = ""
+    );
+
+    // Encoding of sensor uploads (JSON by default). CBOR batches go to the same
+    // endpoints with Content-Type application/cbor.
+    void setPayloadFormat(PayloadFormat format);
+    PayloadFormat getPayloadFormat() const;
+
+    // Batch uploads post several samples as one array to /api/v1/sensor-data/batch.
+    // Off by default; otherwise every sample is posted on its own to
+    // /api/v1/sensor-data. A 404 from the batch endpoint means the backend does
+    // not serve it: batching is switched off for good and the samples go one
+    // by one.
+    void setBatchUploads(bool enabled);
+    // Safe to call from the other core
+    bool usesBatchUploads() const;
+
+    // POST: the count oldest samples of buffer, as one batch or one by one.
+    // A batch may carry fewer samples if the payload buffer fills up.
+    BatchResult sendZoneSensorBatch(
+        const String &zoneId,
+        const TelemetryBuffer &buffer,
+        int count,
+        const String &userId = ""
+    );
+    BatchResult sendZoneSensorBatch(
+        const String &zoneId,
+        const ZoneSample *samples,
+        int count,
+        const String &userId = ""
+    );
+
     // POST: Actuator log
     bool sendActuatorLog(
         const String &action_name,
@@ -53,9 +151,38 @@ public:
         const String &timestamp = ""
     );
 
+    const ConnectionStats &getConnectionStats() const;
+    void printConnectionStats();
+
+    // Request bodies are serialized here instead of into heap Strings
+    static const size_t PAYLOAD_CAPACITY = 8192;
+    // Longest request URL, server and path parameters included
+    static const size_t URL_CAPACITY = 192;
+
 private:
     String serverUrl;
+    String sensorDataUrl;
+    String sensorBatchUrl;
+    String zonesUrl;         // + zone id + "/plants"
+    String actionLogUrl;     // + action name
     bool useInsecure;
+    PayloadFormat payloadFormat;
+    std::atomic<bool> batchUploads;
+    char payload[PAYLOAD_CAPACITY];
+
+    // One keep-alive TLS connection to serverUrl shared by every request
+    WiFiClientSecure client;
+    HTTPClient http;
+    ConnectionStats stats;
+
+    bool beginRequest(const char *endpoint);
+    PlantFetchResult streamPlants(const String &zoneId, const String &etag, PlantCallback onPlant, String *etagOut);
+    int post(const char *endpoint, const BufferPrint &body, const char *contentType = "application/json");
+    PostOutcome postSample(const String &zoneId, const ZoneSample &sample, const String &userId);
+    BatchResult sendSamples(const String &zoneId, const PayloadSerializer::SampleSource &sampleAt, int count, const String &userId);
+    // Counts rejected responses
+    PostOutcome classify(int httpResponseCode);
+    void endRequest(int httpResponseCode, bool drainBody = true);
 };
 
 #endif
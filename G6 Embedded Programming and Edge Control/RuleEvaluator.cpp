@@ -0,0 +1,142 @@
+#include "RuleEvaluator.h"
+#include "Log.h"
+
+static const char *ACTUATOR_NAMES[] = {"light", "fan"};
+
+RuleEvaluator::RuleEvaluator(ClockSource clock)
+{
+    this->clock = clock;
+    count = 0;
+    memset(actuators, 0, sizeof(actuators));
+}
+
+int RuleEvaluator::addRule(const char *name, Actuator actuator, Input input, Direction direction, float threshold, float hysteresis)
+{
+    if (count >= MAX_RULES || actuator >= ACTUATOR_COUNT)
+    {
+        LOG_WARN("Rule table full, rule not added");
+        return INVALID_RULE;
+    }
+
+    Rule &rule = rules[count];
+    rule.name = name;
+    rule.actuator = actuator;
+    rule.input = input;
+    rule.direction = direction;
+    rule.threshold = threshold;
+    rule.hysteresis = hysteresis < 0 ? 0 : hysteresis;
+    rule.active = false;
+    return count++;
+}
+
+void RuleEvaluator::setThreshold(int ruleId, float threshold)
+{
+    if (ruleId >= 0 && ruleId < count)
+    {
+        rules[ruleId].threshold = threshold;
+    }
+}
+
+void RuleEvaluator::setDwell(Actuator actuator, uint32_t minOnMs, uint32_t minOffMs)
+{
+    if (actuator < ACTUATOR_COUNT)
+    {
+        actuators[actuator].minOnMs = minOnMs;
+        actuators[actuator].minOffMs = minOffMs;
+    }
+}
+
+float RuleEvaluator::inputValue(const SensorSnapshot &snapshot, Input input)
+{
+    switch (input)
+    {
+    case TEMPERATURE:
+        return snapshot.temperature;
+    case HUMIDITY:
+        return snapshot.humidity;
+    case LIGHT_LEVEL:
+        return snapshot.light;
+    case AIR_QUALITY:
+        return snapshot.airQuality;
+    }
+    return NAN;
+}
+
+bool RuleEvaluator::applyHysteresis(const Rule &rule, float value)
+{
+    if (rule.direction == ON_AT_OR_BELOW)
+    {
+        // On at the threshold, off only above threshold + band
+        return rule.active ? value <= rule.threshold + rule.hysteresis : value <= rule.threshold;
+    }
+    // On above the threshold, off only at or below threshold - band
+    return rule.active ? value > rule.threshold - rule.hysteresis : value > rule.threshold;
+}
+
+bool RuleEvaluator::evaluate(const SensorSnapshot &snapshot)
+{
+    bool wanted[ACTUATOR_COUNT] = {false};
+
+    for (int i = 0; i < count; i++)
+    {
+        Rule &rule = rules[i];
+        float value = inputValue(snapshot, rule.input);
+        // A failed reading keeps the rule where it was
+        if (!isnan(value))
+        {
+            bool active = applyHysteresis(rule, value);
+            if (active != rule.active)
+            {
+                LOG_INFO("[RULE] %s: %.2f vs %.2f -> %s", rule.name, value, rule.threshold, active ? "ON" : "OFF");
+                rule.active = active;
+            }
+        }
+        wanted[rule.actuator] = wanted[rule.actuator] || rule.active;
+    }
+
+    bool changed = false;
+    uint32_t now = (uint32_t)clock();
+    for (int a = 0; a < ACTUATOR_COUNT; a++)
+    {
+        ActuatorState &state = actuators[a];
+        if (wanted[a] == state.on)
+        {
+            continue;
+        }
+
+        uint32_t dwell = state.on ? state.minOnMs : state.minOffMs;
+        if (state.changedOnce && now - state.changedAt < dwell)
+        {
+            state.stats.heldByDwell++;
+            continue;
+        }
+
+        state.on = wanted[a];
+        state.changedAt = now;
+        state.changedOnce = true;
+        state.stats.transitions++;
+        changed = true;
+    }
+    return changed;
+}
+
+bool RuleEvaluator::desiredState(Actuator actuator) const
+{
+    return actuator < ACTUATOR_COUNT && actuators[actuator].on;
+}
+
+const RuleEvaluator::ActuatorStats &RuleEvaluator::stats(Actuator actuator) const
+{
+    return actuators[actuator < ACTUATOR_COUNT ? actuator : 0].stats;
+}
+
+void RuleEvaluator::printStats()
+{
+    for (int a = 0; a < ACTUATOR_COUNT; a++)
+    {
+        LOG_INFO("[RULE] %s: %s, transitions: %lu, held by dwell: %lu", ACTUATOR_NAMES[a],
+                 actuators[a].on ? "ON" : "OFF",
+                 (unsigned long)actuators[a].stats.transitions,
+                 (unsigned long)actuators[a].stats.heldByDwell);
+    }
+}
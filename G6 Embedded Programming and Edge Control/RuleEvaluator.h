@@ -0,0 +1,96 @@
+#ifndef RULEEVALUATOR_H
+#define RULEEVALUATOR_H
+
+#include <Arduino.h>
+#include "Hal.h"
+#include "SensorSnapshot.h"
+
+// Edge rules for the zone actuators.
+//
+// Each rule compares one snapshot input with a threshold and asks for its
+// actuator to be on. A rule switches on at the threshold and only lets go
+// once the input is back past the threshold by its hysteresis band, so a
+// reading hovering at the limit does not flap. All rules of an actuator are
+// OR-ed into one desired state per evaluation, and that state may only
+// change after the actuator's minimum on/off dwell time.
+class RuleEvaluator
+{
+public:
+    typedef unsigned long (*ClockSource)();
+
+    enum Actuator : uint8_t
+    {
+        LIGHT,
+        FAN,
+        ACTUATOR_COUNT
+    };
+
+    enum Input : uint8_t
+    {
+        TEMPERATURE,
+        HUMIDITY,
+        LIGHT_LEVEL,
+        AIR_QUALITY
+    };
+
+    enum Direction : uint8_t
+    {
+        ON_AT_OR_BELOW,   // on while input <= threshold
+        ON_ABOVE          // on while input > threshold
+    };
+
+    struct ActuatorStats
+    {
+        uint32_t transitions;
+        uint32_t heldByDwell;   // a change was wanted but the dwell time had not passed
+    };
+
+    static const int MAX_RULES = 8;
+    static const int INVALID_RULE = -1;
+
+    explicit RuleEvaluator(ClockSource clock = Hal::millis);
+
+    int addRule(const char *name, Actuator actuator, Input input, Direction direction, float threshold, float hysteresis);
+    void setThreshold(int ruleId, float threshold);
+    void setDwell(Actuator actuator, uint32_t minOnMs, uint32_t minOffMs);
+
+    // Runs every rule against snapshot and updates the desired states.
+    // Returns true if any desired state changed.
+    bool evaluate(const SensorSnapshot &snapshot);
+    bool desiredState(Actuator actuator) const;
+
+    const ActuatorStats &stats(Actuator actuator) const;
+    void printStats();
+
+private:
+    struct Rule
+    {
+        const char *name;
+        Actuator actuator;
+        Input input;
+        Direction direction;
+        float threshold;
+        float hysteresis;
+        bool active;
+    };
+
+    struct ActuatorState
+    {
+        bool on;
+        bool changedOnce;
+        uint32_t changedAt;
+        uint32_t minOnMs;
+        uint32_t minOffMs;
+        ActuatorStats stats;
+    };
+
+    ClockSource clock;
+    Rule rules[MAX_RULES];
+    int count;
+    ActuatorState actuators[ACTUATOR_COUNT];
+
+    static float inputValue(const SensorSnapshot &snapshot, Input input);
+    static bool applyHysteresis(const Rule &rule, float value);
+};
+
+#endif
@@ -1,51 +1,268 @@
 #include "SensorModule.h"
+#include "Log.h"
 
-SensorModule::SensorModule(uint8_t dhtPin, uint8_t dhtType, uint8_t *soilPins, int numPlants)
-    : dht(dhtPin, dhtType), _soilPins(soilPins), _numPlants(numPlants) {}
+SensorModule::SensorModule(uint8_t dhtPin, uint8_t dhtType, uint8_t airQualityPin, uint8_t lightPin)
+    : dht(dhtPin, dhtType), soilFilterConfig(AnalogFilter::DEFAULT_CONFIG), airQualityFilter(airQualityPin), lightFilter(lightPin)
+{
+  memset(&snapshot, 0, sizeof(snapshot));
+  snapshot.temperature = NAN;
+  snapshot.humidity = NAN;
+  climateRead = false;
+  memset(&scanStats, 0, sizeof(scanStats));
+}
 
 void SensorModule::begin()
 {
   dht.begin();
+}
 
-  if (WiFi.status() == WL_CONNECTED)
+void SensorModule::attachMux(const AnalogMux::Config &config)
+{
+  mux.configure(config);
+}
+
+void SensorModule::setPlants(const std::vector<PlantData> &plantList)
+{
+  // Every plant is watered, but the snapshot (and so the uplink) only has
+  // room for the first MAX_SOIL
+  if (plantList.size() > (size_t)SensorSnapshot::MAX_SOIL)
+  {
+    LOG_WARN("%u plants, only the first %d are uploaded", (unsigned)plantList.size(), (int)SensorSnapshot::MAX_SOIL);
+  }
+
+  PlantTable fresh;
+  fresh.reserve(plantList.size());
+  for (const auto &plant : plantList)
+  {
+    int pin = plant.moisturePin;
+    if (AnalogMux::isMuxPin(pin) && !mux.isConfigured())
+    {
+      LOG_WARN("Plant %s is on mux pin %d but no mux is attached", plant.plantId, pin);
+    }
+    int index = fresh.add(plant.plantId, pin, plant.min_moisture, plant.max_moisture);
+    int previous = plants.indexOfPin(pin);
+    if (previous >= 0)
+    {
+      fresh.carryOver(index, plants, previous);
+      continue;
+    }
+    fresh.filter(index).configure(soilFilterConfig);
+    if (!AnalogMux::isMuxPin(pin))
+    {
+      Hal::pinMode(pin, INPUT);
+    }
+  }
+  plants.swap(fresh);
+}
+
+const PlantTable &SensorModule::getPlants() const
+{
+  return plants;
+}
+
+void SensorModule::configureFilters(const AnalogFilter::Config &config)
+{
+  soilFilterConfig = config;
+  for (int i = 0; i < plants.size(); i++)
+  {
+    plants.filter(i).configure(config);
+  }
+  airQualityFilter.configure(config);
+  lightFilter.configure(config);
+}
+
+void SensorModule::sampleAnalog()
+{
+  scanSoil();
+  airQualityFilter.sample();
+  lightFilter.sample();
+}
+
+int SensorModule::nextMuxPlant(int index) const
+{
+  if (!mux.isConfigured())
+  {
+    return -1;
+  }
+  for (; index < plants.size(); index++)
+  {
+    if (AnalogMux::isMuxPin(plants.getPin(index)))
+    {
+      return index;
+    }
+  }
+  return -1;
+}
+
+// Direct probes go through their own filter. Mux probes are pipelined: the
+// next channel is selected before the current reading is filtered, so the
+// filter step and the direct reads run while the mux output settles.
+void SensorModule::scanSoil()
+{
+  uint32_t start = Hal::micros();
+  uint32_t now = Hal::millis();
+  uint16_t muxPlants = 0;
+
+  int next = nextMuxPlant(0);
+  if (next >= 0)
+  {
+    mux.select(AnalogMux::channelOf(plants.getPin(next)));
+  }
+
+  for (int i = 0; i < plants.size(); i++)
   {
-    configTime(0, 0, "pool.ntp.org", "time.nist.gov");
-    Serial.println("Waiting for NTP time sync...");
+    if (!AnalogMux::isMuxPin(plants.getPin(i)))
+    {
+      plants.setReading(i, plants.filter(i).sample(), now);
+    }
+  }
 
-    struct tm timeinfo;
-    int retries = 0;
-    while (!getLocalTime(&timeinfo) && retries++ < 10)
+  while (next >= 0)
+  {
+    mux.waitSettled();
+    int current = next;
+    AnalogFilter &filter = plants.filter(current);
+    uint16_t raw = mux.read(filter.getConfig().oversample);
+    next = nextMuxPlant(current + 1);
+    if (next >= 0)
     {
-      Serial.print(".");
-      delay(1000);
+      mux.select(AnalogMux::channelOf(plants.getPin(next)));
     }
+    plants.setReading(current, filter.update(raw), now);
+    muxPlants++;
+  }
+
+  scanStats.scans++;
+  scanStats.lastUs = Hal::micros() - start;
+  if (scanStats.lastUs > scanStats.maxUs)
+  {
+    scanStats.maxUs = scanStats.lastUs;
+  }
+  scanStats.plants = plants.size();
+  scanStats.muxPlants = muxPlants;
+}
+
+const SensorModule::ScanStats &SensorModule::getScanStats() const
+{
+  return scanStats;
+}
 
-    Serial.println(retries < 10 ? "\nTime synchronized!" : "\nNTP sync failed.");
+void SensorModule::printFilterStats()
+{
+  Serial.printf("[ADC] cost us (last/max) air: %lu/%lu, light: %lu/%lu\n",
+                (unsigned long)airQualityFilter.getLastCostUs(), (unsigned long)airQualityFilter.getMaxCostUs(),
+                (unsigned long)lightFilter.getLastCostUs(), (unsigned long)lightFilter.getMaxCostUs());
+  if (scanStats.plants > 0)
+  {
+    Serial.printf("[SOIL] %u plants (%u on mux), scan us last/max: %lu/%lu, %lu us per plant\n",
+                  scanStats.plants, scanStats.muxPlants,
+                  (unsigned long)scanStats.lastUs, (unsigned long)scanStats.maxUs,
+                  (unsigned long)(scanStats.lastUs / scanStats.plants));
+  }
+  if (mux.isConfigured())
+  {
+    Serial.printf("[MUX] switches: %lu, settle wait us: %lu\n",
+                  (unsigned long)mux.getStats().switches, (unsigned long)mux.getStats().settleWaitUs);
   }
 }
 
-void SensorModule::addPlant(int plantIndex, int soilPin, const String &plantId)
+uint16_t SensorModule::soilValue(int index)
 {
-  if (plantIndex < MAX_PLANTS)
+  if (!plants.hasReading(index))
   {
-    plants[plantIndex] = {soilPin, plantId};
-    pinMode(soilPin, INPUT);
+    AnalogFilter &filter = plants.filter(index);
+    uint16_t raw = readProbe(plants.getPin(index), filter.getConfig().oversample);
+    plants.setReading(index, filter.update(raw), Hal::millis());
   }
+  return plants.getReading(index);
+}
+
+uint16_t SensorModule::readProbe(int pin, uint8_t oversample)
+{
+  if (!AnalogMux::isMuxPin(pin))
+  {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < oversample; i++)
+    {
+      sum += Hal::analogRead(pin);
+    }
+    return oversample > 0 ? (sum + oversample / 2) / oversample : Hal::analogRead(pin);
+  }
+  if (!mux.isConfigured())
+  {
+    return 0;
+  }
+  mux.select(AnalogMux::channelOf(pin));
+  mux.waitSettled();
+  return mux.read(oversample);
+}
+
+uint16_t SensorModule::filteredValue(AnalogFilter &filter)
+{
+  // Nothing sampled yet: take the first reading now
+  return filter.hasValue() ? filter.value() : filter.sample();
+}
+
+const SensorSnapshot &SensorModule::acquire()
+{
+  PROFILE_SCOPE(PHASE_SENSORS);
+  uint32_t now = Hal::millis();
+  snapshot.takenAtMs = now;
+
+  if (!climateRead || now - snapshot.climateAtMs >= DHT_MIN_INTERVAL_MS)
+  {
+    float temperature = readTemperature();
+    float humidity = readHumidity();
+    climateRead = true;
+    snapshot.climateAtMs = now;
+    if (!isnan(temperature))
+    {
+      snapshot.temperature = temperature;
+    }
+    if (!isnan(humidity))
+    {
+      snapshot.humidity = humidity;
+    }
+  }
+
+  snapshot.light = readLightLevel();
+  snapshot.airQuality = readAirQuality();
+
+  // The snapshot, and so the uplink, carries the first MAX_SOIL plants; the
+  // rest are looked up in the table when the watering check needs them
+  snapshot.soilCount = 0;
+  for (int i = 0; i < plants.size() && snapshot.soilCount < SensorSnapshot::MAX_SOIL; i++)
+  {
+    snapshot.soilPins[snapshot.soilCount] = plants.getPin(i);
+    snapshot.soilMoisture[snapshot.soilCount] = soilValue(i);
+    snapshot.soilCount++;
+  }
+  return snapshot;
+}
+
+const SensorSnapshot &SensorModule::lastSnapshot() const
+{
+  return snapshot;
 }
 
 float SensorModule::readSoilMoisture(int pin)
 {
-  return analogRead(pin);
+  int index = plants.indexOfPin(pin);
+  if (index >= 0)
+  {
+    return soilValue(index);
+  }
+  return readProbe(pin, 1);
 }
 
 float SensorModule::readAirQuality()
 {
-  return analogRead(MQ2_PIN);
+  return filteredValue(airQualityFilter);
 }
 
 float SensorModule::readLightLevel()
 {
-  return analogRead(LDR_PIN);
+  return filteredValue(lightFilter);
 }
 
 float SensorModule::readTemperature()
@@ -58,60 +275,49 @@ float SensorModule::readHumidity()
   return dht.readHumidity();
 }
 
-String SensorModule::getISO8601Time()
-{
-  struct tm timeinfo;
-  time_t now;
-
-  time(&now);                   // Get current time as time_t
-  now += 8 * 3600;              // Add 8 hours for UTC+8
-  gmtime_r(&now, &timeinfo);    // Convert to UTC+8 time
-
-  char buffer[30];
-  strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-
-  Serial.println("Timestamp (UTC+8): " + String(buffer));
-  return String(buffer);
-}
-
 void SensorModule::sendAllToCloud(const String &serverURL, const String &userId)
 {
-  float temperatureC = readTemperature();
-  float humidityPercentage = readHumidity();
-  float airQualityPpm = readAirQuality();
-  float lightLevel = readLightLevel();
-
-  for (int i = 0; i < MAX_PLANTS; i++)
-  {
-    float soilMoisture = readSoilMoisture(plants[i].soilPin);
-
-    String timestamp = getISO8601Time();
-    String json = "{";
-    json += "\"automation\":{\"fanOn\":false,\"lightOn\":false,\"waterOn\":false},";
-    json += "\"lastUpdated\":\"" + timestamp + "\",";
-    json += "\"plantId\":\"" + plants[i].plantId + "\",";
-    json += "\"profile\":{\"humidityMax\":100,\"humidityMin\":0,";
-    json += "\"lightMax\":1000,\"lightMin\":0,";
-    json += "\"moistureMax\":100,\"moistureMin\":0,";
-    json += "\"tempMax\":50,\"tempMin\":0},";
-    json += "\"sensorRecordId\":\"" + timestamp + "\",";
-    json += "\"sensors\":{";
-    json += "\"humidity\":" + String(humidityPercentage) + ",";
-    json += "\"light\":" + String(lightLevel) + ",";
-    json += "\"soilMoisture\":" + String(soilMoisture) + ",";
-    json += "\"temp\":" + String(temperatureC) + ",";
-    json += "\"airQuality\":" + String(airQualityPpm) + "},";
-    json += "\"userId\":\"" + userId + "\"}";
+  const SensorSnapshot &readings = acquire();
+
+  char timestamp[ClockService::TIMESTAMP_SIZE];
+  ClockService::timestamp(timestamp, sizeof(timestamp));
+
+  // One record per plant on the legacy endpoint, which takes a single
+  // object; the requests share one kept-alive connection
+  static char payload[512];
+  HTTPClient http;
+  http.setReuse(true);
+  String endpoint = serverURL + "/api/v1/sensor-data";
+  int sent = 0;
+  for (int i = 0; i < plants.size(); i++)
+  {
+    BufferPrint body(payload, sizeof(payload));
+    JsonWriter json(body);
+    float soilMoisture = soilValue(i);
+    PayloadSerializer::plantRecord(json, plants.getId(i).c_str(), userId.c_str(), timestamp,
+                                   readings.humidity, readings.light, soilMoisture, readings.temperature, readings.airQuality);
+    if (body.overflowed())
+    {
+      LOG_WARN("Plant %s payload too large, not sent", plants.getId(i));
+      continue;
+    }
 
-    HTTPClient http;
-    http.begin(serverURL + "/api/v1/sensor-data");
+    http.begin(endpoint);
     http.addHeader("Content-Type", "application/json");
+    int responseCode = http.POST((uint8_t *)body.data(), body.length());
+    if (responseCode >= 200 && responseCode < 300)
+    {
+      sent++;
+    } else
+    {
+      LOG_WARN("Plant %s not sent, response: %d", plants.getId(i), responseCode);
+    }
+  }
+  http.end();
 
-    int responseCode = http.POST(json);
-    Serial.printf("\nSent to %s | Response: %d\n", plants[i].plantId.c_str(), responseCode);
-
-    http.end();
-    delay(500);
+  if (plants.size() > 0)
+  {
+    LOG_INFO("Sent %d of %d plants", sent, plants.size());
   }
 }
 
@@ -166,18 +372,46 @@ bool SensorModule::fetchThresholdsFromAPI()
 bool SensorModule::checkAndTrigger(const String &sensorName, int sensorValue, float maxVal)
 {
   bool trigger = (sensorValue <= maxVal);
-  Serial.printf("%s Value: %d — Max: %.2f → %s\n",
-                sensorName.c_str(), sensorValue, maxVal,
-                trigger ? "ACTIVE" : "DEACTIVATED (Above Max)");
+  LOG_DEBUG("%s Value: %d — Max: %.2f → %s",
+            sensorName, sensorValue, maxVal,
+            trigger ? "ACTIVE" : "DEACTIVATED (Above Max)");
   return trigger;
 }
 
-bool SensorModule::shouldWater(const std::vector<PlantData> &plantList)
+int SensorModule::driestPlant(const std::vector<PlantData> &plantList, const SensorSnapshot &snapshot, float &moisturePercent)
 {
-  bool needsWater = false;
+  int driest = -1;
+  float largestDeficit = 0;
+
+  for (size_t i = 0; i < plantList.size(); i++)
+  {
+    float reading = snapshot.soilMoistureOf(plantList[i].moisturePin);
+    float percent = toPercent(plantList[i].moisturePin, isnan(reading) ? readSoilMoisture(plantList[i].moisturePin) : reading);
+    float deficit = plantList[i].min_moisture - percent;
+    if (deficit > largestDeficit)
+    {
+      largestDeficit = deficit;
+      driest = i;
+      moisturePercent = percent;
+    }
+  }
+  return driest;
+}
 
-  const int dryADC = 3900; // ADC value when dry
-  const int wetADC = 1200; // ADC value when fully wet
+float SensorModule::readMoisturePercent(int pin)
+{
+  return toPercent(pin, readSoilMoisture(pin));
+}
+
+float SensorModule::toPercent(int pin, float raw) const
+{
+  int index = plants.indexOfPin(pin);
+  return index >= 0 ? plants.toPercent(index, raw) : PayloadSerializer::toMoisturePercent(raw);
+}
+
+bool SensorModule::shouldWater(const std::vector<PlantData> &plantList, const SensorSnapshot &snapshot)
+{
+  bool needsWater = false;
 
   for (const auto &plant : plantList)
   {
@@ -185,18 +419,18 @@ bool SensorModule::shouldWater(const std::vector<PlantData> &plantList)
     float minThreshold = plant.min_moisture; // in %
     float maxThreshold = plant.max_moisture; // in %
 
-    // Convert raw ADC value to moisture percentage
-    int rawValue = analogRead(pin);
-    float moisturePercent = map(rawValue, dryADC, wetADC, 0, 100);
-    moisturePercent = constrain(moisturePercent, 0, 100);
+    // Convert raw ADC value to moisture percentage with the probe's calibration
+    float reading = snapshot.soilMoistureOf(pin);
+    int rawValue = isnan(reading) ? readSoilMoisture(pin) : (int)reading;
+    float moisturePercent = toPercent(pin, rawValue);
 
-    Serial.printf("[Moisture Check] Plant ID %s at Pin %d → Raw: %d, Converted: %.2f%% (Min: %.2f%%, Max: %.2f%%)\n",
-                  plant.plantId.c_str(), pin, rawValue, moisturePercent, minThreshold, maxThreshold);
+    LOG_DEBUG("[Moisture Check] Plant ID %s at Pin %d → Raw: %d, Converted: %.2f%% (Min: %.2f%%, Max: %.2f%%)",
+              plant.plantId, pin, rawValue, moisturePercent, minThreshold, maxThreshold);
 
     if (moisturePercent > maxThreshold)
     {
-      Serial.printf("[Too Wet] Plant ID %s is above max threshold (%.2f%%). Watering skipped.\n",
-                    plant.plantId.c_str(), moisturePercent);
+      LOG_INFO("[Too Wet] Plant ID %s is above max threshold (%.2f%%). Watering skipped.",
+               plant.plantId, moisturePercent);
       return false; // If any plant is too wet, skip watering
     }
 
@@ -208,10 +442,10 @@ bool SensorModule::shouldWater(const std::vector<PlantData> &plantList)
 
   if (needsWater)
   {
-    Serial.println("[Watering Triggered] At least one plant needs water, and none are overwatered.");
+    LOG_INFO("[Watering Triggered] At least one plant needs water, and none are overwatered.");
     return true;
   }
 
-  Serial.println("[No Watering] All moisture levels are within acceptable range.");
+  LOG_DEBUG("[No Watering] All moisture levels are within acceptable range.");
   return false;
 }
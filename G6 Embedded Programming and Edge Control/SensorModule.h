@@ -9,6 +9,14 @@
 #include <ArduinoJson.h> 
 #include <utility> // for std::pair
 #include "RESTClient.h"
+#include "PayloadSerializer.h"
+#include "AnalogFilter.h"
+#include "AnalogMux.h"
+#include "PlantTable.h"
+#include "SensorSnapshot.h"
+#include "ClockService.h"
+#include "Profiler.h"
+#include "Hal.h"
 
 // Sensor Pin Configuration
 #define DHT_PIN 16
@@ -19,14 +27,19 @@
 class SensorModule
 {
 public:
-    struct Plant
+    // Soil scan timing, over every plant of the zone
+    struct ScanStats
     {
-        int soilPin;
-        String plantId;
+        uint32_t scans;
+        uint32_t lastUs;
+        uint32_t maxUs;
+        uint16_t plants;        // probes in the last scan
+        uint16_t muxPlants;     // of which behind the multiplexer
     };
 
-    static const int MAX_PLANTS = 4;
-    SensorModule(uint8_t dhtPin, uint8_t dhtType, uint8_t *soilPins, int numPlants);
+    // The DHT11 must not be polled faster than 1 Hz
+    static const uint32_t DHT_MIN_INTERVAL_MS = 1000;
+    SensorModule(uint8_t dhtPin, uint8_t dhtType, uint8_t airQualityPin = MQ2_PIN, uint8_t lightPin = LDR_PIN);
     float lightMin = 0;
     float lightMax = 0;
     float airQualityMin = 0;
@@ -36,7 +49,23 @@ public:
     float soilMin  = 0;
     float soilMax  = 0;
     void begin();
-    void addPlant(int plantIndex, int soilPin, const String &plantId);
+    // Soil probes at pins AnalogMux::PIN_BASE and up are read through the mux
+    void attachMux(const AnalogMux::Config &config);
+    // Replaces the plant set. Probes that stay on the same pin keep their
+    // filter history and calibration.
+    void setPlants(const std::vector<PlantData> &plantList);
+    const PlantTable &getPlants() const;
+    // Same filter settings for every analog channel; clears their history
+    void configureFilters(const AnalogFilter::Config &config);
+    // One filter step on every analog channel. Call at a fixed rate; the
+    // read*() functions below return the filtered values.
+    void sampleAnalog();
+    void printFilterStats();
+    // Reads every sensor once into the shared snapshot. The DHT is only read
+    // again once DHT_MIN_INTERVAL_MS has passed; otherwise, or if the read
+    // fails, the last good temperature/humidity are carried over.
+    const SensorSnapshot &acquire();
+    const SensorSnapshot &lastSnapshot() const;
     void sendAllToCloud(const String &serverURL, const String &userId);
     bool fetchThresholdsFromAPI();
     bool checkAndTrigger(const String& sensorName, int sensorValue, float maxVal);
@@ -45,15 +74,35 @@ public:
     float readHumidity();
     float readAirQuality();
     float readLightLevel();
-    bool shouldWater(const std::vector<PlantData>& plantList);
-    Plant plants[MAX_PLANTS];
-    String getISO8601Time();
+    bool shouldWater(const std::vector<PlantData>& plantList, const SensorSnapshot &snapshot);
+    // Index of the plant furthest below its minimum moisture, -1 if none is
+    // below. moisturePercent receives that plant's reading.
+    int driestPlant(const std::vector<PlantData>& plantList, const SensorSnapshot &snapshot, float &moisturePercent);
+    // Filtered soil reading of pin as a percentage
+    float readMoisturePercent(int pin);
+    const ScanStats &getScanStats() const;
 
 private:
     DHT dht;
-    uint8_t *_soilPins;
-    int _numPlants;
+    PlantTable plants;
+    AnalogMux mux;
+    AnalogFilter::Config soilFilterConfig;
+    AnalogFilter airQualityFilter;
+    AnalogFilter lightFilter;
 
+    SensorSnapshot snapshot;
+    bool climateRead;
+    ScanStats scanStats;
+
+    static uint16_t filteredValue(AnalogFilter &filter);
+    void scanSoil();
+    // Next plant at or after index whose probe is behind the mux, -1 if none
+    int nextMuxPlant(int index) const;
+    // Filtered reading of plant index, read now if it has none yet
+    uint16_t soilValue(int index);
+    uint16_t readProbe(int pin, uint8_t oversample);
+    // Moisture % of a raw reading, through the calibration of the probe on pin
+    float toPercent(int pin, float raw) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef SENSORSNAPSHOT_H
+#define SENSORSNAPSHOT_H
+
+#include <Arduino.h>
+
+// Every sensor of the zone read once, at one point in time. Produced by
+// SensorModule::acquire() and handed to the upload, the rules and the
+// watering check so they all decide on the same values.
+struct SensorSnapshot
+{
+    static const int MAX_SOIL = 8;
+
+    uint32_t takenAtMs;
+    uint32_t climateAtMs;   // when temperature/humidity were last read from the DHT
+    float temperature;
+    float humidity;
+    float light;
+    float airQuality;
+    uint8_t soilCount;
+    uint8_t soilPins[MAX_SOIL];
+    float soilMoisture[MAX_SOIL];   // raw ADC
+
+    // Soil reading of pin, NAN if the pin is not part of the snapshot
+    float soilMoistureOf(int pin) const
+    {
+        for (int i = 0; i < soilCount; i++)
+        {
+            if (soilPins[i] == pin)
+            {
+                return soilMoisture[i];
+            }
+        }
+        return NAN;
+    }
+};
+
+#endif
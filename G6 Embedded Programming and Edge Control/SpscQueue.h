@@ -0,0 +1,76 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Lock-free ring buffer between exactly one producer task and one consumer
+// task, e.g. across the two ESP32 cores. Neither side ever blocks: push()
+// fails when the queue is full and pop() when it is empty.
+//
+// head is only written by the producer and tail only by the consumer; the
+// release/acquire pair on them publishes the slot contents. The indices run
+// freely and wrap at 2^32, which is why CAPACITY must be a power of two.
+template <typename T, size_t CAPACITY>
+class SpscQueue
+{
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0), dropped(0)
+    {
+    }
+
+    // Producer side
+    bool push(const T &item)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == CAPACITY)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (CAPACITY - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T &item)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t)
+        {
+            return false;
+        }
+        item = items[t & (CAPACITY - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Either side; only a snapshot while the other side is running
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+
+    // Pushes rejected because the queue was full
+    uint32_t getDropped() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    T items[CAPACITY];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> dropped;
+};
+
+#endif
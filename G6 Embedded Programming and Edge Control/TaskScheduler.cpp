@@ -0,0 +1,197 @@
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler(ClockSource clock)
+{
+  this->clock = clock;
+  count = 0;
+}
+
+uint32_t TaskScheduler::now() const
+{
+  return (uint32_t)clock();
+}
+
+int TaskScheduler::addTask(const char *name, uint32_t intervalMs, TaskCallback callback, uint32_t budgetMs)
+{
+  if (count >= MAX_TASKS || callback == nullptr)
+  {
+    Serial.println("Scheduler full, task not added");
+    return INVALID_TASK;
+  }
+
+  Task &task = tasks[count];
+  task.callback = callback;
+  task.intervalMs = intervalMs;
+  task.budgetMs = budgetMs;
+  task.dueAt = now();
+  task.armed = false;
+  memset(&task.stats, 0, sizeof(task.stats));
+  task.stats.name = name;
+  return count++;
+}
+
+int TaskScheduler::addPeriodic(const char *name, uint32_t intervalMs, TaskCallback callback, uint32_t budgetMs, uint32_t startDelayMs)
+{
+  if (intervalMs == 0)
+  {
+    return INVALID_TASK;
+  }
+  int id = addTask(name, intervalMs, callback, budgetMs > 0 ? budgetMs : intervalMs);
+  if (id != INVALID_TASK)
+  {
+    schedule(id, startDelayMs);
+  }
+  return id;
+}
+
+int TaskScheduler::addOneShot(const char *name, TaskCallback callback, uint32_t budgetMs)
+{
+  return addTask(name, 0, callback, budgetMs);
+}
+
+bool TaskScheduler::schedule(int taskId, uint32_t delayMs)
+{
+  if (taskId < 0 || taskId >= count)
+  {
+    return false;
+  }
+  tasks[taskId].dueAt = now() + delayMs;
+  tasks[taskId].armed = true;
+  return true;
+}
+
+void TaskScheduler::cancel(int taskId)
+{
+  if (taskId >= 0 && taskId < count)
+  {
+    tasks[taskId].armed = false;
+  }
+}
+
+bool TaskScheduler::isPending(int taskId) const
+{
+  return taskId >= 0 && taskId < count && tasks[taskId].armed;
+}
+
+void TaskScheduler::setInterval(int taskId, uint32_t intervalMs)
+{
+  if (taskId >= 0 && taskId < count && tasks[taskId].intervalMs > 0 && intervalMs > 0)
+  {
+    tasks[taskId].intervalMs = intervalMs;
+  }
+}
+
+void TaskScheduler::tick()
+{
+  for (int i = 0; i < count; i++)
+  {
+    Task &task = tasks[i];
+    uint32_t current = now();
+    // Signed difference keeps the comparison valid across millis() rollover
+    if (!task.armed || (int32_t)(current - task.dueAt) < 0)
+    {
+      continue;
+    }
+    runTask(task, current);
+  }
+}
+
+void TaskScheduler::runTask(Task &task, uint32_t startedAt)
+{
+  uint32_t late = startedAt - task.dueAt;
+  if (late > task.stats.maxLateMs)
+  {
+    task.stats.maxLateMs = late;
+  }
+
+  if (task.intervalMs > 0)
+  {
+    // Re-arm before running so the task may cancel or reschedule itself
+    task.dueAt += task.intervalMs;
+    if ((int32_t)(startedAt - task.dueAt) >= 0)
+    {
+      // Fell a whole period behind: skip the backlog instead of bursting
+      task.stats.missed++;
+      task.dueAt = startedAt + task.intervalMs;
+    }
+  }
+  else
+  {
+    task.armed = false;
+  }
+
+  task.callback();
+
+  uint32_t ran = now() - startedAt;
+  task.stats.runs++;
+  task.stats.lastRunMs = ran;
+  if (ran > task.stats.maxRunMs)
+  {
+    task.stats.maxRunMs = ran;
+  }
+  if (task.budgetMs > 0 && ran > task.budgetMs)
+  {
+    task.stats.overruns++;
+    Serial.printf("[SCHED] %s overran: %lu ms (budget %lu ms)\n",
+                  task.stats.name, (unsigned long)ran, (unsigned long)task.budgetMs);
+  }
+}
+
+uint32_t TaskScheduler::idleTime() const
+{
+  uint32_t current = now();
+  uint32_t idle = UINT32_MAX;
+  for (int i = 0; i < count; i++)
+  {
+    if (!tasks[i].armed)
+    {
+      continue;
+    }
+    int32_t remaining = (int32_t)(tasks[i].dueAt - current);
+    if (remaining <= 0)
+    {
+      return 0;
+    }
+    if ((uint32_t)remaining < idle)
+    {
+      idle = remaining;
+    }
+  }
+  return idle;
+}
+
+const TaskScheduler::TaskStats *TaskScheduler::stats(int taskId) const
+{
+  if (taskId < 0 || taskId >= count)
+  {
+    return nullptr;
+  }
+  return &tasks[taskId].stats;
+}
+
+int TaskScheduler::taskCount() const
+{
+  return count;
+}
+
+void TaskScheduler::printStats()
+{
+  Serial.println("[SCHED] task           runs  overruns  missed  max ms  max late ms");
+  for (int i = 0; i < count; i++)
+  {
+    const TaskStats &s = tasks[i].stats;
+    Serial.printf("[SCHED] %-14s %5lu  %8lu  %6lu  %6lu  %11lu\n",
+                  s.name, (unsigned long)s.runs, (unsigned long)s.overruns, (unsigned long)s.missed,
+                  (unsigned long)s.maxRunMs, (unsigned long)s.maxLateMs);
+  }
+}
+
+void TaskScheduler::resetStats()
+{
+  for (int i = 0; i < count; i++)
+  {
+    const char *name = tasks[i].stats.name;
+    memset(&tasks[i].stats, 0, sizeof(TaskStats));
+    tasks[i].stats.name = name;
+  }
+}
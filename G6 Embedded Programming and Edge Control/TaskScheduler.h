@@ -0,0 +1,73 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+// Cooperative millisecond-tick scheduler. Tasks must return quickly and never
+// call delay(); long work is split into steps that re-arm themselves.
+// The clock is injected so the scheduler can be driven by a virtual clock
+// when the module is exercised off-target.
+class TaskScheduler
+{
+  public:
+    typedef void (*TaskCallback)();
+    typedef unsigned long (*ClockSource)();
+
+    static const int MAX_TASKS = 12;
+    static const int INVALID_TASK = -1;
+
+    struct TaskStats
+    {
+      const char *name;
+      uint32_t runs;
+      uint32_t overruns;     // run took longer than its budget
+      uint32_t missed;       // periodic deadline slipped by a whole interval
+      uint32_t lastRunMs;
+      uint32_t maxRunMs;
+      uint32_t maxLateMs;
+    };
+
+    explicit TaskScheduler(ClockSource clock = Hal::millis);
+
+    // Periodic task, first run after startDelayMs. budgetMs = 0 uses the interval.
+    int addPeriodic(const char *name, uint32_t intervalMs, TaskCallback callback, uint32_t budgetMs = 0, uint32_t startDelayMs = 0);
+    // One-shot task, idle until schedule() arms it.
+    int addOneShot(const char *name, TaskCallback callback, uint32_t budgetMs = 0);
+
+    bool schedule(int taskId, uint32_t delayMs);
+    void cancel(int taskId);
+    bool isPending(int taskId) const;
+    void setInterval(int taskId, uint32_t intervalMs);
+
+    // Runs every task that is due. Call as often as possible from loop().
+    void tick();
+    uint32_t now() const;
+    // Milliseconds until the next due task, 0 if one is due already.
+    uint32_t idleTime() const;
+
+    const TaskStats *stats(int taskId) const;
+    int taskCount() const;
+    void printStats();
+    void resetStats();
+
+  private:
+    struct Task
+    {
+      TaskCallback callback;
+      uint32_t intervalMs;   // 0 for one-shot tasks
+      uint32_t budgetMs;
+      uint32_t dueAt;
+      bool armed;
+      TaskStats stats;
+    };
+
+    int addTask(const char *name, uint32_t intervalMs, TaskCallback callback, uint32_t budgetMs);
+    void runTask(Task &task, uint32_t startedAt);
+
+    ClockSource clock;
+    Task tasks[MAX_TASKS];
+    int count;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "TelemetryBuffer.h"
+#include "ClockService.h"
+
+void ZoneSample::setTimestamp(uint32_t epochSeconds)
+{
+    epoch = epochSeconds;
+    ClockService::format(epochSeconds, timestamp, sizeof(timestamp));
+}
+
+void ZoneSample::setReadings(const SensorSnapshot &snapshot)
+{
+    takenAtMs = snapshot.takenAtMs;
+    temperature = snapshot.temperature;
+    humidity = snapshot.humidity;
+    light = snapshot.light;
+    airQuality = snapshot.airQuality;
+    soilCount = snapshot.soilCount;
+    memcpy(soilPins, snapshot.soilPins, sizeof(soilPins));
+    memcpy(soilMoisture, snapshot.soilMoisture, sizeof(soilMoisture));
+    present = ALL_FIELDS;
+    keyframe = true;
+}
+
+TelemetryBuffer::TelemetryBuffer(int batchSize, uint32_t flushIntervalMs)
+{
+    head = 0;
+    count = 0;
+    overwritten = 0;
+    configure(batchSize, flushIntervalMs);
+}
+
+void TelemetryBuffer::configure(int batchSize, uint32_t flushIntervalMs)
+{
+    this->batchSize = constrain(batchSize, 1, CAPACITY);
+    this->flushIntervalMs = flushIntervalMs;
+}
+
+int TelemetryBuffer::getBatchSize() const
+{
+    return batchSize;
+}
+
+void TelemetryBuffer::push(const ZoneSample &sample)
+{
+    if (count == CAPACITY)
+    {
+        head = (head + 1) % CAPACITY;
+        count--;
+        overwritten++;
+    }
+    samples[(head + count) % CAPACITY] = sample;
+    count++;
+}
+
+bool TelemetryBuffer::shouldFlush(uint32_t nowMs) const
+{
+    if (count == 0)
+    {
+        return false;
+    }
+    if (count >= batchSize)
+    {
+        return true;
+    }
+    return nowMs - samples[head].takenAtMs >= flushIntervalMs;
+}
+
+int TelemetryBuffer::size() const
+{
+    return count;
+}
+
+bool TelemetryBuffer::isEmpty() const
+{
+    return count == 0;
+}
+
+const ZoneSample &TelemetryBuffer::at(int index) const
+{
+    return samples[(head + index) % CAPACITY];
+}
+
+void TelemetryBuffer::discard(int n)
+{
+    if (n > count)
+    {
+        n = count;
+    }
+    head = (head + n) % CAPACITY;
+    count -= n;
+}
+
+uint32_t TelemetryBuffer::getOverwritten() const
+{
+    return overwritten;
+}
@@ -0,0 +1,84 @@
+#ifndef TELEMETRYBUFFER_H
+#define TELEMETRYBUFFER_H
+
+#include <Arduino.h>
+#include "SensorSnapshot.h"
+#include "ClockService.h"
+
+// One zone snapshot as it is uploaded: zone sensors plus raw soil ADC by pin
+struct ZoneSample
+{
+    static const int MAX_SOIL = SensorSnapshot::MAX_SOIL;
+
+    // Bits of present: which readings the sample carries
+    static const uint16_t HAS_TEMPERATURE = 1 << 0;
+    static const uint16_t HAS_HUMIDITY = 1 << 1;
+    static const uint16_t HAS_LIGHT = 1 << 2;
+    static const uint16_t HAS_AIR_QUALITY = 1 << 3;
+    static const uint8_t SOIL_SHIFT = 4;      // soil entry i is bit SOIL_SHIFT + i
+    static const uint16_t ALL_FIELDS = 0x0FFF;
+
+    uint32_t takenAtMs;
+    uint32_t epoch;
+    char timestamp[ClockService::TIMESTAMP_SIZE];
+    float temperature;
+    float humidity;
+    float light;
+    float airQuality;
+    uint8_t soilCount;
+    uint8_t soilPins[MAX_SOIL];
+    float soilMoisture[MAX_SOIL];
+    // A keyframe carries every reading; a delta only those in present,
+    // the rest are unchanged since the previous sample sent
+    uint16_t present;
+    bool keyframe;
+
+    bool has(uint16_t field) const
+    {
+        return (present & field) != 0;
+    }
+    bool hasSoil(int index) const
+    {
+        return has(1 << (SOIL_SHIFT + index));
+    }
+
+    // Sets epoch and the ISO-8601 text sent to the backend (empty for an unsynced clock)
+    void setTimestamp(uint32_t epochSeconds);
+    // Copies the readings of snapshot, timestamp excluded, as a keyframe
+    void setReadings(const SensorSnapshot &snapshot);
+};
+
+// Fixed-size ring of samples waiting to be uploaded as one batch.
+// When full the oldest sample is overwritten.
+class TelemetryBuffer
+{
+public:
+    static const int CAPACITY = 32;
+
+    TelemetryBuffer(int batchSize = 10, uint32_t flushIntervalMs = 300000);
+
+    void configure(int batchSize, uint32_t flushIntervalMs);
+    int getBatchSize() const;
+
+    void push(const ZoneSample &sample);
+    // True once batchSize samples are waiting or the oldest is flushIntervalMs old
+    bool shouldFlush(uint32_t nowMs) const;
+
+    int size() const;
+    bool isEmpty() const;
+    // 0 is the oldest sample
+    const ZoneSample &at(int index) const;
+    // Removes the count oldest samples, e.g. after they were uploaded
+    void discard(int count);
+    uint32_t getOverwritten() const;
+
+private:
+    ZoneSample samples[CAPACITY];
+    int head;
+    int count;
+    int batchSize;
+    uint32_t flushIntervalMs;
+    uint32_t overwritten;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "Zone.h"
+#include "Log.h"
+#include "Profiler.h"
+
+Zone::Zone(uint8_t index, const ZoneConfig &config, Adafruit_MQTT &mqtt, const char *telemetryTopicPrefix,
+           int batchSize, uint32_t flushIntervalMs)
+    : index(index),
+      config(config),
+      id(config.id),
+      feedbackFeed(&mqtt, config.feedbackTopic),
+      actuator(*config.actuators, nullptr, &feedbackFeed, nullptr, id),
+      sensor(nullptr),
+      plantCache(config.plantNamespace),
+      lightRule(RuleEvaluator::INVALID_RULE),
+      airQualityRule(RuleEvaluator::INVALID_RULE),
+      temperatureRule(RuleEvaluator::INVALID_RULE),
+      pump([this](bool on) { actuator.setPump(on, true); }),
+      wateringPin(-1),
+      telemetry(batchSize, flushIntervalMs),
+      mqttTelemetry(mqtt, telemetryTopicPrefix, id, FORMAT_CBOR)
+{
+}
+
+void Zone::createSensor(uint8_t dhtType)
+{
+    sensor = new SensorModule(config.dhtPin, dhtType, config.airQualityPin, config.lightPin);
+    if (config.soilMux != nullptr)
+    {
+        sensor->attachMux(*config.soilMux);
+    }
+}
+
+void Zone::applyPlants()
+{
+    sensor->setPlants(plants);
+
+    if (plants.size() > 0)
+    {
+        rules.setThreshold(lightRule, plants[0].max_light);
+        rules.setThreshold(airQualityRule, plants[0].max_airQuality);
+        rules.setThreshold(temperatureRule, plants[0].max_temperature);
+        for (const auto &p : plants)
+        {
+            // Two records, so a long plant id still leaves room for every threshold
+            LOG_INFO("[PLANT] %s %s on pin %d: moisture %.1f-%.1f%%, temperature %.1f-%.1f", id, p.plantId,
+                     p.moisturePin, p.min_moisture, p.max_moisture, p.min_temperature, p.max_temperature);
+            LOG_INFO("[PLANT] %s %s: light %.0f-%.0f, air quality %.0f-%.0f", id, p.plantId, p.min_light, p.max_light,
+                     p.min_airQuality, p.max_airQuality);
+        }
+    }
+}
+
+void Zone::control()
+{
+    // One acquisition for the whole rule pass so every decision sees the same values
+    const SensorSnapshot &snapshot = sensor->acquire();
+    {
+        PROFILE_SCOPE(PHASE_RULES);
+        rules.evaluate(snapshot);
+
+        // Only the merged state is written; unchanged outputs publish nothing
+        actuator.setLight(rules.desiredState(RuleEvaluator::LIGHT), true);
+        actuator.setFan(rules.desiredState(RuleEvaluator::FAN), true);
+    }
+
+    // A watering cycle is running, the pump controller owns the pump
+    if (pump.isActive())
+    {
+        return;
+    }
+
+    if (actuator.isPumpOn())
+    {
+        // Switched on by a command: keep it on only while the soil still asks for water
+        if (sensor->shouldWater(plants, snapshot))
+        {
+            LOG_INFO("[CHECK] %s: pump on manually, still needs water, keeping it on", id);
+        }
+        else
+        {
+            LOG_INFO("[CHECK] %s: pump on manually, moisture OK now, turning it off", id);
+            actuator.setPump(false, true);
+        }
+    }
+    else if (sensor->shouldWater(plants, snapshot))
+    {
+        // Water towards the middle of the driest plant's range
+        float moisture = 0;
+        int driest = sensor->driestPlant(plants, snapshot, moisture);
+        if (driest >= 0)
+        {
+            float target = (plants[driest].min_moisture + plants[driest].max_moisture) / 2;
+            LOG_INFO("[PUMP] %s: watering %s, pulsing to %.1f%%", id, plants[driest].plantId, target);
+            wateringPin = plants[driest].moisturePin;
+            pump.start(moisture, target);
+        }
+    }
+    else
+    {
+        LOG_DEBUG("[PUMP] %s: moisture OK, pump off", id);
+        actuator.setPump(false, true);
+    }
+}
+
+bool Zone::updatePump()
+{
+    if (pump.isActive())
+    {
+        pump.update(sensor->readMoisturePercent(wateringPin));
+    }
+    return pump.takeFinished();
+}
@@ -0,0 +1,73 @@
+#ifndef ZONE_H
+#define ZONE_H
+
+#include <Arduino.h>
+#include <vector>
+#include <Adafruit_MQTT.h>
+#include "ActuatorModule.h"
+#include "SensorModule.h"
+#include "RuleEvaluator.h"
+#include "PumpController.h"
+#include "TelemetryBuffer.h"
+#include "DeltaReporter.h"
+#include "MqttTelemetry.h"
+#include "PlantCache.h"
+
+// Wiring and names of one grow tray
+struct ZoneConfig
+{
+    const char *id;                // zone id known to the backend, at most 7 characters (offline queue records)
+    uint8_t dhtPin;
+    uint8_t airQualityPin;
+    uint8_t lightPin;
+    ActuatorOutputs *actuators;    // channel set of the tray, see ActuatorRoles.h
+    const char *feedbackTopic;
+    const char *plantNamespace;    // NVS namespace of the plant cache, at most 15 characters
+    const AnalogMux::Config *soilMux;   // nullptr: every probe is wired to its own ADC pin
+};
+
+// Everything the node keeps per tray: sensors, plant set and thresholds,
+// actuators, rules, pump and uplink buffers, and the control pass over them.
+// The tasks in main.ino run the same code over each zone in turn; only the
+// MQTT session, the REST client and the offline queue (whose records carry
+// the zone id) are shared.
+class Zone
+{
+public:
+    Zone(uint8_t index, const ZoneConfig &config, Adafruit_MQTT &mqtt, const char *telemetryTopicPrefix,
+         int batchSize, uint32_t flushIntervalMs);
+
+    // Builds the sensor module on the zone's pins and multiplexer
+    void createSensor(uint8_t dhtType);
+    // Pushes the plant set into the sensor module and the rule thresholds
+    void applyPlants();
+    // One rule pass: reads every sensor once, switches light and fan by the
+    // rules and starts watering the driest plant when the soil asks for it
+    void control();
+    // Feeds the running watering cycle; true once a cycle has just finished
+    bool updatePump();
+
+    const uint8_t index;
+    const ZoneConfig config;
+    const String id;
+
+    Adafruit_MQTT_Publish feedbackFeed;
+    ActuatorModule actuator;
+    SensorModule *sensor;
+    std::vector<PlantData> plants;
+    PlantCache plantCache;
+
+    RuleEvaluator rules;
+    int lightRule;
+    int airQualityRule;
+    int temperatureRule;
+
+    PumpController pump;
+    int wateringPin;           // soil sensor followed by the running watering cycle
+
+    TelemetryBuffer telemetry;
+    DeltaReporter deltaReporter;
+    MqttTelemetry mqttTelemetry;
+};
+
+#endif
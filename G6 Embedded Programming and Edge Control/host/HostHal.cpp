@@ -0,0 +1,160 @@
+#include "Hal.h"
+#include "HostHal.h"
+
+// Host implementation of Hal, linked instead of the ESP32 Hal.cpp
+
+namespace
+{
+    uint64_t clockUs = 0;
+    uint32_t microsStep = 0;
+    uint8_t modes[HostHal::PIN_COUNT];
+    uint8_t levels[HostHal::PIN_COUNT];
+    uint16_t analogValues[HostHal::PIN_COUNT];
+    HostHal::AnalogScript analogScript;
+    uint32_t analogReadCount = 0;
+    uint32_t digitalWriteCount = 0;
+    uint32_t image = 0x600DF00D;
+}
+
+// Bounds of the host executable's read-only data, from the GNU linker
+extern "C" char etext;
+extern "C" char edata;
+
+void HostHal::reset()
+{
+    clockUs = 0;
+    microsStep = 0;
+    memset(modes, 0, sizeof(modes));
+    memset(levels, 0, sizeof(levels));
+    memset(analogValues, 0, sizeof(analogValues));
+    analogScript = nullptr;
+    analogReadCount = 0;
+    digitalWriteCount = 0;
+}
+
+uint64_t HostHal::nowUs()
+{
+    return clockUs;
+}
+
+void HostHal::setUs(uint64_t us)
+{
+    clockUs = us;
+}
+
+void HostHal::advanceUs(uint64_t us)
+{
+    clockUs += us;
+}
+
+void HostHal::advanceMs(uint32_t ms)
+{
+    clockUs += (uint64_t)ms * 1000;
+}
+
+void HostHal::setMicrosStep(uint32_t us)
+{
+    microsStep = us;
+}
+
+void HostHal::setAnalog(uint8_t pin, uint16_t value)
+{
+    if (pin < PIN_COUNT)
+    {
+        analogValues[pin] = value;
+    }
+}
+
+void HostHal::setAnalogScript(const AnalogScript &script)
+{
+    analogScript = script;
+}
+
+uint8_t HostHal::pinModeOf(uint8_t pin)
+{
+    return pin < PIN_COUNT ? modes[pin] : 0;
+}
+
+uint8_t HostHal::outputOf(uint8_t pin)
+{
+    return pin < PIN_COUNT ? levels[pin] : LOW;
+}
+
+void HostHal::setInput(uint8_t pin, uint8_t value)
+{
+    if (pin < PIN_COUNT)
+    {
+        levels[pin] = value;
+    }
+}
+
+uint32_t HostHal::analogReads()
+{
+    return analogReadCount;
+}
+
+uint32_t HostHal::digitalWrites()
+{
+    return digitalWriteCount;
+}
+
+void HostHal::setImageId(uint32_t id)
+{
+    image = id;
+}
+
+unsigned long Hal::millis()
+{
+    return (unsigned long)(uint32_t)(clockUs / 1000);
+}
+
+unsigned long Hal::micros()
+{
+    clockUs += microsStep;
+    return (unsigned long)(uint32_t)clockUs;
+}
+
+void Hal::pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < HostHal::PIN_COUNT)
+    {
+        modes[pin] = mode;
+    }
+}
+
+void Hal::digitalWrite(uint8_t pin, uint8_t value)
+{
+    digitalWriteCount++;
+    if (pin < HostHal::PIN_COUNT)
+    {
+        levels[pin] = value ? HIGH : LOW;
+    }
+}
+
+int Hal::digitalRead(uint8_t pin)
+{
+    return pin < HostHal::PIN_COUNT ? levels[pin] : LOW;
+}
+
+uint16_t Hal::analogRead(uint8_t pin)
+{
+    analogReadCount++;
+    if (analogScript)
+    {
+        return analogScript(pin, clockUs);
+    }
+    return pin < HostHal::PIN_COUNT ? analogValues[pin] : 0;
+}
+
+void Hal::imageId(uint8_t *id, size_t size)
+{
+    memset(id, 0, size);
+    memcpy(id, &image, min(size, sizeof(image)));
+}
+
+bool Hal::isRodata(const void *address)
+{
+    // .rodata sits between the end of .text and the end of .data
+    const char *p = (const char *)address;
+    return p >= &etext && p < &edata;
+}
@@ -0,0 +1,46 @@
+#ifndef HOSTHAL_H
+#define HOSTHAL_H
+
+#include <Arduino.h>
+#include <functional>
+
+// Controls of the host implementation of Hal (HostHal.cpp).
+//
+// Time is virtual: it only moves when a test or the benchmark advances it,
+// or when the code under test calls delay(). Each Hal::micros() call can
+// also move it by a fixed step, so busy-waits on the clock terminate.
+// ADC pins return a fixed value or whatever a script returns for the
+// current time; digital outputs are recorded and read back.
+namespace HostHal
+{
+    typedef std::function<uint16_t(uint8_t pin, uint64_t nowUs)> AnalogScript;
+
+    static const uint8_t PIN_COUNT = 128;
+
+    // Clock back to 0, pins low, no scripts, no step
+    void reset();
+
+    uint64_t nowUs();
+    void setUs(uint64_t us);
+    void advanceUs(uint64_t us);
+    void advanceMs(uint32_t ms);
+    // Virtual time each Hal::micros() call adds, 0 by default
+    void setMicrosStep(uint32_t us);
+
+    void setAnalog(uint8_t pin, uint16_t value);
+    // Overrides setAnalog() for every pin while set; pass nullptr to clear
+    void setAnalogScript(const AnalogScript &script);
+
+    uint8_t pinModeOf(uint8_t pin);
+    uint8_t outputOf(uint8_t pin);
+    void setInput(uint8_t pin, uint8_t value);
+
+    uint32_t analogReads();
+    uint32_t digitalWrites();
+
+    // What Hal::imageId() reports, as if another build had been flashed;
+    // reset() does not change it, like a watchdog reset on the node
+    void setImageId(uint32_t id);
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new of the benchmark it is included in and
+// counts every heap allocation. Include it from one file per executable.
+static uint64_t allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *block = malloc(size != 0 ? size : 1);
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void *block) noexcept
+{
+    free(block);
+}
+
+void operator delete(void *block, size_t) noexcept
+{
+    free(block);
+}
+
+#endif
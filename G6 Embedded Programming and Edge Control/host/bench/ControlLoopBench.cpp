@@ -0,0 +1,400 @@
+#include <chrono>
+#include <vector>
+#include "AllocationCounter.h"
+#include "HostHal.h"
+#include "ActuatorRoles.h"
+#include "Log.h"
+#include "PayloadSerializer.h"
+#include "TaskScheduler.h"
+#include "Zone.h"
+
+// The control side of the node over N zones on the virtual clock: real
+// Zone objects (SensorModule, ActuatorModule, rules, PumpController, delta
+// filter and telemetry buffer) driven by TaskScheduler with main.ino's task
+// periods and the same per-zone task bodies. DHT readings and the ADC are
+// scripted; the soil dries slowly and wets while that zone's pump runs.
+// Uploads stop at the encoded CBOR batch, the network side is not run.
+//
+//   ControlLoopBench [seconds] [zones]
+//
+// Prints host time per simulated second in total, per zone and per task,
+// and heap allocations after warm-up; the control path is meant to stay at
+// 0 allocations.
+
+// main.ino's control periods and settings
+static const uint32_t ANALOG_SAMPLE_INTERVAL_MS = 100;
+static const uint32_t ACTUATOR_INTERVAL_MS = 100;
+static const uint32_t PUMP_CONTROL_INTERVAL_MS = 250;
+static const uint32_t RULES_INTERVAL_MS = 30000;
+static const uint32_t SAMPLE_INTERVAL_MS = 15000;
+static const AnalogFilter::Config ADC_FILTER = {8, 5, 3};
+static const PumpController::Config PUMP_CONFIG = {1000, 8000, 20000, 6, 2.0f, 0.3f, 25};
+static const int TELEMETRY_BATCH_SIZE = 20;
+static const uint32_t TELEMETRY_FLUSH_INTERVAL_MS = 300000;
+
+static const uint32_t EPOCH = 1709294400;
+static const int PLANTS = 4;
+
+// Each zone gets six ADC pins from FIRST_PIN on: four soil probes, the LDR
+// and the MQ2. They stay below AnalogMux::PIN_BASE, so no zone uses the mux.
+static const int FIRST_PIN = 4;
+static const int PINS_PER_ZONE = PLANTS + 2;
+static const int MAX_ZONES = (AnalogMux::PIN_BASE - FIRST_PIN) / PINS_PER_ZONE;
+
+enum BenchTask
+{
+    TASK_ADC,
+    TASK_ACTUATORS,
+    TASK_PUMP,
+    TASK_RULES,
+    TASK_SAMPLE,
+    TASK_COUNT
+};
+
+static const char *const TASK_NAMES[TASK_COUNT] = {"adc", "actuators", "pump", "rules", "sample"};
+
+struct TaskCost
+{
+    uint32_t runs;
+    double us;
+};
+
+static TaskCost taskCosts[TASK_COUNT];
+static bool measuring = false;
+
+// Adds the host time of one task run to its TaskCost once warm-up is over
+class TaskTimer
+{
+public:
+    explicit TaskTimer(BenchTask task) : task(task), start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~TaskTimer()
+    {
+        if (measuring)
+        {
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+            taskCosts[task].runs++;
+            taskCosts[task].us += elapsed.count();
+        }
+    }
+
+private:
+    BenchTask task;
+    std::chrono::steady_clock::time_point start;
+};
+
+static std::vector<Zone *> zones;
+// Moisture per probe in raw ADC counts (higher is drier)
+static float soilRaw[MAX_ZONES][PLANTS];
+
+static char payload[2048];
+static uint32_t feedbackBytes = 0;
+static uint32_t batches = 0;
+static uint32_t batchBytes = 0;
+static uint32_t pumpCycles = 0;
+
+static uint8_t zonePin(int zone, int channel)
+{
+    return (uint8_t)(FIRST_PIN + zone * PINS_PER_ZONE + channel);
+}
+
+// Deterministic noise, a few counts either way
+static uint16_t noise(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state % 24;
+}
+
+static uint16_t readAdc(uint8_t pin, uint64_t nowUs)
+{
+    static uint32_t state = 12345;
+    int offset = pin - FIRST_PIN;
+    if (offset < 0 || offset >= (int)zones.size() * PINS_PER_ZONE)
+    {
+        return 0;
+    }
+    int zone = offset / PINS_PER_ZONE;
+    int channel = offset % PINS_PER_ZONE;
+    uint32_t seconds = (uint32_t)(nowUs / 1000000);
+    if (channel == PLANTS)
+    {
+        // Day and night over a 600 s period, staggered per zone
+        return ((seconds + zone * 100) / 300) % 2 == 0 ? 2400 + noise(state) : 300 + noise(state);
+    }
+    if (channel == PLANTS + 1)
+    {
+        return 1500 + noise(state);
+    }
+    return (uint16_t)soilRaw[zone][channel] + noise(state);
+}
+
+// The soil dries slowly and gains while the pump runs on the watered probe
+static void moveSoil(uint32_t elapsedMs)
+{
+    float seconds = elapsedMs / 1000.0f;
+    for (size_t z = 0; z < zones.size(); z++)
+    {
+        for (int i = 0; i < PLANTS; i++)
+        {
+            soilRaw[z][i] = min(soilRaw[z][i] + 0.4f * seconds, 3850.0f);
+        }
+        int watered = zones[z]->wateringPin - zonePin(z, 0);
+        if (zones[z]->actuator.isPumpOn() && watered >= 0 && watered < PLANTS)
+        {
+            soilRaw[z][watered] = max(soilRaw[z][watered] - 25.0f * seconds, 1300.0f);
+        }
+    }
+}
+
+// The task bodies below are main.ino's, without the network hand-off
+
+static void analogTask()
+{
+    TaskTimer timer(TASK_ADC);
+    for (Zone *zone : zones)
+    {
+        zone->sensor->sampleAnalog();
+    }
+}
+
+static void actuatorTask()
+{
+    TaskTimer timer(TASK_ACTUATORS);
+    for (Zone *zone : zones)
+    {
+        zone->actuator.update();
+    }
+}
+
+static void pumpTask()
+{
+    TaskTimer timer(TASK_PUMP);
+    for (Zone *zone : zones)
+    {
+        if (zone->updatePump())
+        {
+            pumpCycles++;
+        }
+    }
+}
+
+static void rulesTask()
+{
+    TaskTimer timer(TASK_RULES);
+    for (Zone *zone : zones)
+    {
+        zone->control();
+    }
+}
+
+static void sampleTask()
+{
+    TaskTimer timer(TASK_SAMPLE);
+    uint32_t nowMs = Hal::millis();
+    for (Zone *zone : zones)
+    {
+        ZoneSample sample;
+        sample.setReadings(zone->sensor->acquire());
+        sample.setTimestamp(EPOCH + nowMs / 1000);
+        if (zone->deltaReporter.filter(sample))
+        {
+            zone->telemetry.push(sample);
+        }
+        if (zone->telemetry.shouldFlush(nowMs))
+        {
+            BufferPrint out(payload, sizeof(payload));
+            int sent = PayloadSerializer::sensorBatch(out, zone->id.c_str(), zone->telemetry,
+                                                      zone->telemetry.size(), "user1", FORMAT_CBOR);
+            zone->telemetry.discard(sent > 0 ? sent : zone->telemetry.size());
+            batchBytes += out.length();
+            batches++;
+        }
+    }
+}
+
+static PlantData makePlant(int zone, int index)
+{
+    PlantData plant = {};
+    char id[16];
+    snprintf(id, sizeof(id), "z%dp%d", zone, index);
+    plant.plantId = id;
+    plant.moisturePin = zonePin(zone, index);
+    plant.min_moisture = 35;
+    plant.max_moisture = 70;
+    plant.min_temperature = 15;
+    plant.max_temperature = 30;
+    plant.min_light = 0;
+    plant.max_light = 1000;
+    plant.min_airQuality = 0;
+    plant.max_airQuality = 400;
+    return plant;
+}
+
+// Discards log text; the formatting work is still done
+class NullPrint : public Print
+{
+public:
+    size_t write(uint8_t) override
+    {
+        return 1;
+    }
+    size_t write(const uint8_t *, size_t size) override
+    {
+        return size;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    long seconds = argc > 1 ? atol(argv[1]) : 100000;
+    if (seconds < 1)
+    {
+        seconds = 1;
+    }
+    int zoneCount = argc > 2 ? atoi(argv[2]) : 1;
+    if (zoneCount < 1 || zoneCount > MAX_ZONES)
+    {
+        fprintf(stderr, "zones must be 1..%d\n", MAX_ZONES);
+        return 1;
+    }
+    const long WARMUP = min(seconds / 10, 1000L);
+
+    Serial.setQuiet(true);
+    HostHal::reset();
+    HostHal::setAnalogScript(readAdc);
+    NullPrint logSink;
+    Logger::begin(logSink);
+
+    // Built as setup() builds the zones; zone 1 gets the first bank layout,
+    // the others the second tray's
+    Adafruit_MQTT mqtt;
+    std::vector<ActuatorOutputs *> banks;
+    std::vector<ZoneConfig> configs(zoneCount);
+    std::vector<std::string> names;
+    for (int z = 0; z < zoneCount; z++)
+    {
+        names.push_back("zone" + std::to_string(z + 1));
+    }
+    for (int z = 0; z < zoneCount; z++)
+    {
+        if (z == 0)
+        {
+            banks.push_back(new ActuatorBank<Zone1Actuators>());
+        }
+        else
+        {
+            banks.push_back(new ActuatorBank<Zone2Actuators>());
+        }
+        configs[z] = {names[z].c_str(), (uint8_t)z, zonePin(z, PLANTS + 1), zonePin(z, PLANTS), banks[z],
+                      "feedback", "plants", nullptr};
+
+        for (int i = 0; i < PLANTS; i++)
+        {
+            soilRaw[z][i] = 2200 + 400 * ((z + i) % 4);
+        }
+        DHT::setReading(z, 24, 55);
+
+        Zone *zone = new Zone(z, configs[z], mqtt, "telemetry-", TELEMETRY_BATCH_SIZE, TELEMETRY_FLUSH_INTERVAL_MS);
+        zones.push_back(zone);
+        zone->actuator.begin();
+        zone->createSensor(DHT11);
+        zone->sensor->begin();
+        zone->sensor->configureFilters(ADC_FILTER);
+        zone->lightRule = zone->rules.addRule("light", RuleEvaluator::LIGHT, RuleEvaluator::LIGHT_LEVEL,
+                                              RuleEvaluator::ON_AT_OR_BELOW, 0, 100);
+        zone->airQualityRule = zone->rules.addRule("air quality", RuleEvaluator::FAN, RuleEvaluator::AIR_QUALITY,
+                                                   RuleEvaluator::ON_AT_OR_BELOW, 0, 100);
+        zone->temperatureRule = zone->rules.addRule("temperature", RuleEvaluator::FAN, RuleEvaluator::TEMPERATURE,
+                                                    RuleEvaluator::ON_ABOVE, 0, 1.0f);
+        zone->rules.setDwell(RuleEvaluator::LIGHT, 300000, 300000);
+        zone->rules.setDwell(RuleEvaluator::FAN, 60000, 60000);
+        zone->pump.configure(PUMP_CONFIG);
+        for (int i = 0; i < PLANTS; i++)
+        {
+            zone->plants.push_back(makePlant(z, i));
+        }
+        zone->applyPlants();
+        zone->actuator.setFeedbackPublisher([](const uint8_t *, size_t length) {
+            feedbackBytes += length;
+            return true;
+        });
+    }
+
+    TaskScheduler scheduler;
+    scheduler.addPeriodic("adc", ANALOG_SAMPLE_INTERVAL_MS, analogTask);
+    scheduler.addPeriodic("actuators", ACTUATOR_INTERVAL_MS, actuatorTask);
+    scheduler.addPeriodic("rules", RULES_INTERVAL_MS, rulesTask, 2000);
+    scheduler.addPeriodic("sample", SAMPLE_INTERVAL_MS, sampleTask, 2000);
+    scheduler.addPeriodic("pump", PUMP_CONTROL_INTERVAL_MS, pumpTask, 1000);
+
+    uint64_t allocationsAtStart = 0;
+    uint32_t logRecords = 0;
+    std::chrono::steady_clock::time_point start;
+
+    for (long second = 0; second < WARMUP + seconds; second++)
+    {
+        if (second == WARMUP)
+        {
+            allocationsAtStart = allocations;
+            measuring = true;
+            start = std::chrono::steady_clock::now();
+        }
+        if (second % 60 == 0)
+        {
+            for (int z = 0; z < zoneCount; z++)
+            {
+                DHT::setReading(z, 24 + (second / 600 + z) % 10, 55);
+            }
+        }
+
+        // Run every task due within this second, stepping the clock between them
+        uint32_t end = Hal::millis() + 1000;
+        while (true)
+        {
+            scheduler.tick();
+            uint32_t step = min(scheduler.idleTime(), end - (uint32_t)Hal::millis());
+            if (step == 0)
+            {
+                break;
+            }
+            HostHal::advanceMs(step);
+            moveSoil(step);
+        }
+
+        logRecords += Logger::drain(logSink);
+    }
+
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t allocated = allocations - allocationsAtStart;
+
+    printf("[BENCH] control loop, %d zones x %d plants, %ld s after %ld s warm-up\n", zoneCount, PLANTS, seconds,
+           WARMUP);
+    printf("[BENCH] %.3f us per simulated second, %.3f per zone, %.4f allocations/s (%llu total)\n",
+           elapsed.count() / seconds, elapsed.count() / seconds / zoneCount, (double)allocated / seconds,
+           (unsigned long long)allocated);
+    for (int t = 0; t < TASK_COUNT; t++)
+    {
+        const TaskCost &cost = taskCosts[t];
+        printf("[BENCH]   %-9s %7lu runs, %8.3f us/run, %8.3f us/run/zone\n", TASK_NAMES[t], (unsigned long)cost.runs,
+               cost.runs > 0 ? cost.us / cost.runs : 0.0, cost.runs > 0 ? cost.us / cost.runs / zoneCount : 0.0);
+    }
+    printf("[BENCH] batches: %lu, batch bytes: %lu, feedback bytes: %lu, pump cycles: %lu, log records: %lu, "
+           "log dropped: %lu\n",
+           (unsigned long)batches, (unsigned long)batchBytes, (unsigned long)feedbackBytes, (unsigned long)pumpCycles,
+           (unsigned long)logRecords, (unsigned long)Logger::getDropped());
+
+    for (Zone *zone : zones)
+    {
+        delete zone->sensor;
+        delete zone;
+    }
+    for (ActuatorOutputs *bank : banks)
+    {
+        delete bank;
+    }
+    return 0;
+}
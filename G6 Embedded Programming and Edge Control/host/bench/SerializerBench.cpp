@@ -0,0 +1,142 @@
+#include <chrono>
+#include "AllocationCounter.h"
+#include "PayloadSerializer.h"
+#include "TelemetryBuffer.h"
+
+// Encode throughput of every uplink payload the node builds, each written
+// into a fixed buffer as the upload, feedback and log paths do.
+//
+//   SerializerBench [iterations]
+//
+// Prints per payload its size, encode time, bytes per second and heap
+// allocations per payload; every serializer is meant to stay at 0. The
+// payloads with a CBOR encoding are then run again in CBOR and compared.
+
+static const uint32_t EPOCH = 1709294400;
+static const int BATCH = 10;
+static const int PLANTS = 4;
+
+struct Result
+{
+    size_t bytes;
+    double usPerPayload;
+    double allocationsPerPayload;
+};
+
+static char payload[4096];
+// Keeps the compiler from dropping the encodes
+static volatile uint8_t sink;
+
+static void compare(const char *name, const Result &json, const Result &cbor)
+{
+    printf("[BENCH] %-20s CBOR is %5.1f%% of the JSON size, %5.1f%% of its encode time\n", name,
+           100.0 * cbor.bytes / json.bytes, 100.0 * cbor.usPerPayload / json.usPerPayload);
+}
+
+template <typename Encode>
+static Result measure(const char *name, long iterations, Encode encode)
+{
+    Result result = {0, 0, 0};
+    uint64_t allocationsAtStart = allocations;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++)
+    {
+        BufferPrint out(payload, sizeof(payload));
+        encode(out);
+        result.bytes = out.length();
+        sink = out.data()[out.length() / 2];
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    result.usPerPayload = elapsed.count() / iterations;
+    result.allocationsPerPayload = (double)(allocations - allocationsAtStart) / iterations;
+
+    printf("[BENCH] %-20s %5lu bytes %9.3f us %9.1f MB/s %7.4f allocations\n", name, (unsigned long)result.bytes,
+           result.usPerPayload, result.bytes / result.usPerPayload, result.allocationsPerPayload);
+    return result;
+}
+
+// Readings as they come off the sensors; in the delta batch every sample
+// after the first carries only a changed temperature and one probe
+static void fillBuffer(TelemetryBuffer &buffer, bool deltas)
+{
+    for (int i = 0; i < BATCH; i++)
+    {
+        ZoneSample sample;
+        memset(&sample, 0, sizeof(sample));
+        sample.takenAtMs = i * 15000;
+        sample.temperature = 24.5f + i * 0.1f;
+        sample.humidity = 61.2f;
+        sample.light = 1834;
+        sample.airQuality = 412;
+        sample.soilCount = PLANTS;
+        for (int p = 0; p < PLANTS; p++)
+        {
+            sample.soilPins[p] = 32 + p;
+            sample.soilMoisture[p] = 2400 + 150 * p + i;
+        }
+        sample.present = ZoneSample::ALL_FIELDS;
+        sample.keyframe = true;
+        if (deltas && i > 0)
+        {
+            sample.present = ZoneSample::HAS_TEMPERATURE | (1 << ZoneSample::SOIL_SHIFT);
+            sample.keyframe = false;
+        }
+        sample.setTimestamp(EPOCH + i * 15);
+        buffer.push(sample);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 200000;
+    if (iterations < 1)
+    {
+        iterations = 1;
+    }
+
+    // Built once, as the node keeps them for its whole uptime
+    const String zone("zone1");
+    const String user("user1");
+    TelemetryBuffer keyframes(BATCH);
+    fillBuffer(keyframes, false);
+    TelemetryBuffer deltas(BATCH);
+    fillBuffer(deltas, true);
+    const ActuatorTransition transitions[] = {{"pump ON", true}, {"fan OFF", false}};
+    char timestamp[ClockService::TIMESTAMP_SIZE];
+    PayloadSerializer::formatTimestamp(EPOCH, timestamp, sizeof(timestamp));
+
+    printf("[BENCH] serializers, %ld iterations, batches of %d samples with %d probes\n", iterations, BATCH, PLANTS);
+
+    Result jsonBatch = measure("sensor batch", iterations, [&](BufferPrint &out) {
+        PayloadSerializer::sensorBatch(out, zone, keyframes, BATCH, user, FORMAT_JSON);
+    });
+    Result jsonDeltas = measure("sensor delta batch", iterations, [&](BufferPrint &out) {
+        PayloadSerializer::sensorBatch(out, zone, deltas, BATCH, user, FORMAT_JSON);
+    });
+    Result jsonFeedback = measure("actuator feedback", iterations, [&](BufferPrint &out) {
+        PayloadSerializer::actuatorFeedbackBatch(out, "zone1", EPOCH, transitions, 2);
+    });
+    measure("actuator log", iterations, [&](BufferPrint &out) {
+        PayloadSerializer::actuatorLog(out, "ON", "pump", "p1", "moisture", "zone1", "SYSTEM", timestamp);
+    });
+    measure("plant record", iterations, [&](BufferPrint &out) {
+        JsonWriter json(out);
+        PayloadSerializer::plantRecord(json, "p1", "user1", timestamp, 61.2f, 1834, 47.5f, 24.5f, 412);
+    });
+
+    Result cborBatch = measure("sensor batch CBOR", iterations, [&](BufferPrint &out) {
+        PayloadSerializer::sensorBatch(out, zone, keyframes, BATCH, user, FORMAT_CBOR);
+    });
+    Result cborDeltas = measure("sensor delta CBOR", iterations, [&](BufferPrint &out) {
+        PayloadSerializer::sensorBatch(out, zone, deltas, BATCH, user, FORMAT_CBOR);
+    });
+    Result cborFeedback = measure("feedback CBOR", iterations, [&](BufferPrint &out) {
+        CborWriter cbor(out);
+        PayloadSerializer::actuatorFeedbackBatch(cbor, "zone1", (uint64_t)EPOCH * 1000, transitions, 2);
+    });
+
+    compare("sensor batch", jsonBatch, cborBatch);
+    compare("sensor delta batch", jsonDeltas, cborDeltas);
+    compare("actuator feedback", jsonFeedback, cborFeedback);
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include "Adafruit_MQTT.h"
+
+Adafruit_MQTT::Adafruit_MQTT(const char *, uint16_t, const char *, const char *, const char *)
+{
+    isConnected = false;
+    connectResult = 0;
+    publishFails = false;
+    connectCalls = 0;
+}
+
+int8_t Adafruit_MQTT::connect()
+{
+    connectCalls++;
+    isConnected = connectResult == 0;
+    return connectResult;
+}
+
+int8_t Adafruit_MQTT::connect(const char *, const char *)
+{
+    return connect();
+}
+
+bool Adafruit_MQTT::connected()
+{
+    return isConnected;
+}
+
+bool Adafruit_MQTT::disconnect()
+{
+    isConnected = false;
+    return true;
+}
+
+const __FlashStringHelper *Adafruit_MQTT::connectErrorString(int8_t code)
+{
+    switch (code)
+    {
+    case 0:
+        return F("Connected");
+    case -1:
+        return F("Connection failed");
+    case 5:
+        return F("Connection refused - not authorized");
+    default:
+        return F("Unknown error");
+    }
+}
+
+bool Adafruit_MQTT::ping(uint8_t)
+{
+    return isConnected;
+}
+
+void Adafruit_MQTT::setKeepAliveInterval(uint16_t)
+{
+}
+
+bool Adafruit_MQTT::publish(const char *topic, const char *payload, uint8_t qos)
+{
+    return publish(topic, (uint8_t *)payload, (uint16_t)strlen(payload), qos);
+}
+
+bool Adafruit_MQTT::publish(const char *topic, uint8_t *payload, uint16_t length, uint8_t qos)
+{
+    // Fixed header, topic length, topic and payload share one packet buffer
+    if (!isConnected || publishFails || length + strlen(topic) + 5 > MAXBUFFERSIZE)
+    {
+        return false;
+    }
+    Message message;
+    message.topic = topic;
+    message.payload.assign(payload, payload + length);
+    message.qos = qos;
+    messages.push_back(message);
+    return true;
+}
+
+bool Adafruit_MQTT::subscribe(Adafruit_MQTT_Subscribe *subscription)
+{
+    if (subscriptions.size() >= MAXSUBSCRIPTIONS)
+    {
+        return false;
+    }
+    subscriptions.push_back(subscription);
+    return true;
+}
+
+bool Adafruit_MQTT::unsubscribe(Adafruit_MQTT_Subscribe *subscription)
+{
+    for (size_t i = 0; i < subscriptions.size(); i++)
+    {
+        if (subscriptions[i] == subscription)
+        {
+            subscriptions.erase(subscriptions.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+Adafruit_MQTT_Subscribe *Adafruit_MQTT::readSubscription(int16_t)
+{
+    while (isConnected && !incoming.empty())
+    {
+        std::pair<std::string, std::string> next = incoming.front();
+        incoming.erase(incoming.begin());
+        for (size_t i = 0; i < subscriptions.size(); i++)
+        {
+            Adafruit_MQTT_Subscribe *subscription = subscriptions[i];
+            if (next.first == subscription->topic)
+            {
+                subscription->datalen = (uint16_t)min(next.second.size(), (size_t)SUBSCRIPTIONDATALEN - 1);
+                memcpy(subscription->lastread, next.second.data(), subscription->datalen);
+                subscription->lastread[subscription->datalen] = 0;
+                return subscription;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void Adafruit_MQTT::processPackets(int16_t)
+{
+}
+
+void Adafruit_MQTT::setConnectResult(int8_t code)
+{
+    connectResult = code;
+}
+
+void Adafruit_MQTT::setPublishFails(bool fails)
+{
+    publishFails = fails;
+}
+
+void Adafruit_MQTT::dropConnection()
+{
+    isConnected = false;
+}
+
+void Adafruit_MQTT::deliver(const char *topic, const char *payload)
+{
+    incoming.push_back(std::make_pair(std::string(topic), std::string(payload)));
+}
+
+const std::vector<Adafruit_MQTT::Message> &Adafruit_MQTT::published() const
+{
+    return messages;
+}
+
+void Adafruit_MQTT::clearPublished()
+{
+    messages.clear();
+}
+
+uint32_t Adafruit_MQTT::getConnectCalls() const
+{
+    return connectCalls;
+}
+
+Adafruit_MQTT_Publish::Adafruit_MQTT_Publish(Adafruit_MQTT *mqtt, const char *topic, uint8_t qos)
+    : topic(topic), qos(qos), mqtt(mqtt)
+{
+}
+
+bool Adafruit_MQTT_Publish::publish(const char *payload)
+{
+    return mqtt->publish(topic, payload, qos);
+}
+
+bool Adafruit_MQTT_Publish::publish(uint8_t *payload, uint16_t length)
+{
+    return mqtt->publish(topic, payload, length, qos);
+}
+
+bool Adafruit_MQTT_Publish::publish(int32_t value)
+{
+    char text[12];
+    snprintf(text, sizeof(text), "%ld", (long)value);
+    return publish(text);
+}
+
+bool Adafruit_MQTT_Publish::publish(uint32_t value)
+{
+    char text[12];
+    snprintf(text, sizeof(text), "%lu", (unsigned long)value);
+    return publish(text);
+}
+
+bool Adafruit_MQTT_Publish::publish(double value, uint8_t precision)
+{
+    char text[24];
+    snprintf(text, sizeof(text), "%.*f", (int)precision, value);
+    return publish(text);
+}
+
+Adafruit_MQTT_Subscribe::Adafruit_MQTT_Subscribe(Adafruit_MQTT *, const char *topic, uint8_t qos)
+    : topic(topic), qos(qos), datalen(0)
+{
+    memset(lastread, 0, sizeof(lastread));
+}
@@ -0,0 +1,100 @@
+#ifndef HOST_ADAFRUIT_MQTT_H
+#define HOST_ADAFRUIT_MQTT_H
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+// Host stand-in for the Adafruit MQTT client with the library's buffer
+// limits. Nothing goes on the wire: connects succeed unless a test makes
+// them fail, and publishes are kept for inspection. A publish that would
+// not fit the library's packet buffer fails, as it does on the node.
+#define MAXBUFFERSIZE (150)
+#define SUBSCRIPTIONDATALEN 100
+#define MAXSUBSCRIPTIONS 5
+#define MQTT_QOS_0 0
+#define MQTT_QOS_1 1
+
+class Adafruit_MQTT_Subscribe;
+
+class Adafruit_MQTT
+{
+public:
+    struct Message
+    {
+        std::string topic;
+        std::vector<uint8_t> payload;
+        uint8_t qos;
+    };
+
+    Adafruit_MQTT(const char *server = "", uint16_t port = 1883, const char *clientId = "", const char *user = "",
+                  const char *password = "");
+    virtual ~Adafruit_MQTT() {}
+
+    // 0 on success, as in the library
+    int8_t connect();
+    int8_t connect(const char *user, const char *password);
+    bool connected();
+    bool disconnect();
+    const __FlashStringHelper *connectErrorString(int8_t code);
+    bool ping(uint8_t tries = 1);
+    void setKeepAliveInterval(uint16_t seconds);
+
+    bool publish(const char *topic, const char *payload, uint8_t qos = 0);
+    bool publish(const char *topic, uint8_t *payload, uint16_t length, uint8_t qos = 0);
+
+    bool subscribe(Adafruit_MQTT_Subscribe *subscription);
+    bool unsubscribe(Adafruit_MQTT_Subscribe *subscription);
+    Adafruit_MQTT_Subscribe *readSubscription(int16_t timeoutMs = 0);
+    void processPackets(int16_t timeoutMs);
+
+    // Host only
+    void setConnectResult(int8_t code);
+    void setPublishFails(bool fails);
+    void dropConnection();
+    // Queues payload for the subscription on topic; readSubscription() delivers it
+    void deliver(const char *topic, const char *payload);
+    const std::vector<Message> &published() const;
+    void clearPublished();
+    uint32_t getConnectCalls() const;
+
+private:
+    bool isConnected;
+    int8_t connectResult;
+    bool publishFails;
+    uint32_t connectCalls;
+    std::vector<Message> messages;
+    std::vector<Adafruit_MQTT_Subscribe *> subscriptions;
+    std::vector<std::pair<std::string, std::string>> incoming;
+};
+
+class Adafruit_MQTT_Publish
+{
+public:
+    Adafruit_MQTT_Publish(Adafruit_MQTT *mqtt, const char *topic, uint8_t qos = 0);
+
+    bool publish(const char *payload);
+    bool publish(uint8_t *payload, uint16_t length);
+    bool publish(int32_t value);
+    bool publish(uint32_t value);
+    bool publish(double value, uint8_t precision = 2);
+
+    const char *topic;
+    uint8_t qos;
+
+private:
+    Adafruit_MQTT *mqtt;
+};
+
+class Adafruit_MQTT_Subscribe
+{
+public:
+    Adafruit_MQTT_Subscribe(Adafruit_MQTT *mqtt, const char *topic, uint8_t qos = 0);
+
+    const char *topic;
+    uint8_t qos;
+    uint8_t lastread[SUBSCRIPTIONDATALEN];
+    uint16_t datalen;
+};
+
+#endif
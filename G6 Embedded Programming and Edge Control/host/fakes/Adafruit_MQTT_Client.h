@@ -0,0 +1,28 @@
+#ifndef HOST_ADAFRUIT_MQTT_CLIENT_H
+#define HOST_ADAFRUIT_MQTT_CLIENT_H
+
+#include <Adafruit_MQTT.h>
+#include <Client.h>
+
+// The fake Adafruit_MQTT keeps everything in memory, so the client only has
+// to take the library's constructor arguments
+class Adafruit_MQTT_Client : public Adafruit_MQTT
+{
+public:
+    Adafruit_MQTT_Client(Client *client, const char *server, uint16_t port, const char *user = "",
+                         const char *password = "")
+        : Adafruit_MQTT(server, port, "", user, password), client(client)
+    {
+    }
+
+    Adafruit_MQTT_Client(Client *client, const char *server, uint16_t port, const char *clientId, const char *user,
+                         const char *password)
+        : Adafruit_MQTT(server, port, clientId, user, password), client(client)
+    {
+    }
+
+private:
+    Client *client;
+};
+
+#endif
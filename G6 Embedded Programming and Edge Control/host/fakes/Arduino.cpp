@@ -0,0 +1,246 @@
+#include <Arduino.h>
+#include "Hal.h"
+#include "HostHal.h"
+
+HardwareSerial Serial;
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+    while (size-- > 0 && write(*buffer++) == 1)
+    {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == 10)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%ld", value);
+        return write(buffer);
+    }
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    if (base < 2 || base > 16)
+    {
+        base = 10;
+    }
+    char buffer[8 * sizeof(value) + 1];
+    char *digit = buffer + sizeof(buffer) - 1;
+    *digit = '\0';
+    do
+    {
+        *--digit = "0123456789ABCDEF"[value % base];
+        value /= base;
+    } while (value > 0);
+    return write(digit);
+}
+
+size_t Print::print(double value, int decimals)
+{
+    // Same output as the core's printFloat for the ranges the modules print
+    if (isnan(value))
+    {
+        return write("nan");
+    }
+    if (isinf(value))
+    {
+        return write("inf");
+    }
+    if (value > 4294967040.0 || value < -4294967040.0)
+    {
+        return write("ovf");
+    }
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    return write(buffer);
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0)
+    {
+        return 0;
+    }
+    return write((const uint8_t *)buffer, min((size_t)length, sizeof(buffer) - 1));
+}
+
+bool Stream::findUntil(const char *target, const char *terminator)
+{
+    size_t targetLength = strlen(target);
+    size_t terminatorLength = terminator != nullptr ? strlen(terminator) : 0;
+    size_t matched = 0;
+    size_t terminatorMatched = 0;
+    if (targetLength == 0)
+    {
+        return true;
+    }
+    int c;
+    while ((c = read()) >= 0)
+    {
+        matched = c == target[matched] ? matched + 1 : (c == target[0] ? 1 : 0);
+        if (matched == targetLength)
+        {
+            return true;
+        }
+        if (terminatorLength > 0)
+        {
+            terminatorMatched = c == terminator[terminatorMatched] ? terminatorMatched + 1 : (c == terminator[0] ? 1 : 0);
+            if (terminatorMatched == terminatorLength)
+            {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+    int c;
+    while (count < length && (c = read()) >= 0)
+    {
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readString()
+{
+    std::string text;
+    int c;
+    while ((c = read()) >= 0)
+    {
+        text += (char)c;
+    }
+    return String(text);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (!quiet)
+    {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (!quiet)
+    {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+unsigned long millis()
+{
+    return Hal::millis();
+}
+
+unsigned long micros()
+{
+    return Hal::micros();
+}
+
+void delay(uint32_t ms)
+{
+    HostHal::advanceUs((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    HostHal::advanceUs(us);
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    Hal::pinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    Hal::digitalWrite(pin, value);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return Hal::digitalRead(pin);
+}
+
+uint16_t analogRead(uint8_t pin)
+{
+    return Hal::analogRead(pin);
+}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh)
+{
+    return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+// Fixed-seed generator so runs are reproducible
+static uint32_t randomState = 1;
+
+uint32_t esp_random()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+long random(long max)
+{
+    return max > 0 ? (long)(esp_random() % (uint32_t)max) : 0;
+}
+
+long random(long min, long max)
+{
+    return min < max ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed)
+{
+    randomState = seed != 0 ? (uint32_t)seed : 1;
+}
+
+void configTime(long, int, const char *, const char *, const char *)
+{
+}
+
+bool getLocalTime(struct tm *info, uint32_t)
+{
+    time_t now = time(nullptr);
+    return localtime_r(&now, info) != nullptr;
+}
+
+void portENTER_CRITICAL(portMUX_TYPE *mux)
+{
+    int unlocked = 0;
+    while (!mux->owner.compare_exchange_weak(unlocked, 1, std::memory_order_acquire))
+    {
+        unlocked = 0;
+    }
+}
+
+void portEXIT_CRITICAL(portMUX_TYPE *mux)
+{
+    mux->owner.store(0, std::memory_order_release);
+}
@@ -0,0 +1,251 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-in for the parts of the ESP32 Arduino core the G6 modules use.
+// Time, GPIO and ADC go through Hal, which the host build implements with a
+// virtual clock and scripted inputs (HostHal.h). FreeRTOS critical sections
+// become a spinlock, RTC memory ordinary memory.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string>
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+class __FlashStringHelper;
+#define F(text) (reinterpret_cast<const __FlashStringHelper *>(text))
+
+class String
+{
+public:
+    String() {}
+    String(const char *text) : text(text != nullptr ? text : "") {}
+    String(const std::string &text) : text(text) {}
+    String(const __FlashStringHelper *text) : text(reinterpret_cast<const char *>(text)) {}
+    explicit String(char c) : text(1, c) {}
+    explicit String(int value) : text(std::to_string(value)) {}
+    explicit String(unsigned int value) : text(std::to_string(value)) {}
+    explicit String(long value) : text(std::to_string(value)) {}
+    explicit String(unsigned long value) : text(std::to_string(value)) {}
+    explicit String(float value, unsigned int decimals = 2) : text(formatFloat(value, decimals)) {}
+    explicit String(double value, unsigned int decimals = 2) : text(formatFloat(value, decimals)) {}
+
+    const char *c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    bool isEmpty() const { return text.empty(); }
+    bool reserve(unsigned int size) { text.reserve(size); return true; }
+
+    String &operator+=(const String &other) { text += other.text; return *this; }
+    String &operator+=(const char *other) { text += other; return *this; }
+    String &operator+=(char c) { text += c; return *this; }
+    bool concat(const String &other) { text += other.text; return true; }
+
+    bool operator==(const String &other) const { return text == other.text; }
+    bool operator==(const char *other) const { return text == other; }
+    bool operator!=(const String &other) const { return text != other.text; }
+    bool operator!=(const char *other) const { return text != other; }
+    bool operator<(const String &other) const { return text < other.text; }
+    bool equals(const String &other) const { return text == other.text; }
+    bool equalsIgnoreCase(const String &other) const
+    {
+        return text.size() == other.text.size() && strcasecmp(text.c_str(), other.text.c_str()) == 0;
+    }
+    char operator[](unsigned int index) const { return index < text.size() ? text[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    int indexOf(char c, unsigned int from = 0) const { return position(text.find(c, from)); }
+    int indexOf(const char *part, unsigned int from = 0) const { return position(text.find(part, from)); }
+    int lastIndexOf(char c) const { return position(text.rfind(c)); }
+    bool startsWith(const String &prefix) const { return text.compare(0, prefix.text.size(), prefix.text) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return text.size() >= suffix.text.size() &&
+               text.compare(text.size() - suffix.text.size(), suffix.text.size(), suffix.text) == 0;
+    }
+    String substring(unsigned int from) const { return from < text.size() ? String(text.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        return from < to && from < text.size() ? String(text.substr(from, to - from)) : String();
+    }
+    long toInt() const { return atol(text.c_str()); }
+    float toFloat() const { return (float)atof(text.c_str()); }
+    void toCharArray(char *buffer, unsigned int size) const
+    {
+        if (size == 0)
+        {
+            return;
+        }
+        strncpy(buffer, text.c_str(), size - 1);
+        buffer[size - 1] = '\0';
+    }
+
+private:
+    std::string text;
+
+    static int position(size_t found) { return found == std::string::npos ? -1 : (int)found; }
+    static std::string formatFloat(double value, unsigned int decimals)
+    {
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+        return buffer;
+    }
+};
+
+inline String operator+(const String &a, const String &b)
+{
+    String result(a);
+    result += b;
+    return result;
+}
+
+inline String operator+(const String &a, const char *b)
+{
+    String result(a);
+    result += b;
+    return result;
+}
+
+inline String operator+(const char *a, const String &b)
+{
+    String result(a);
+    result += b;
+    return result;
+}
+
+class Print
+{
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *text) { return text != nullptr ? write((const uint8_t *)text, strlen(text)) : 0; }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char *text) { return write(text); }
+    size_t print(const String &text) { return write(text.c_str()); }
+    size_t print(const __FlashStringHelper *text) { return write(reinterpret_cast<const char *>(text)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value, int base = 10) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = 10) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = 10);
+    size_t print(unsigned long value, int base = 10);
+    size_t print(double value, int decimals = 2);
+
+    template <typename T>
+    size_t println(const T &value)
+    {
+        return print(value) + println();
+    }
+    template <typename T>
+    size_t println(const T &value, int format)
+    {
+        return print(value, format) + println();
+    }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    // Reads never wait on the host: the data is either there or not
+    void setTimeout(unsigned long timeoutMs) { this->timeoutMs = timeoutMs; }
+    bool find(const char *target) { return findUntil(target, nullptr); }
+    bool findUntil(const char *target, const char *terminator);
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    String readString();
+
+protected:
+    unsigned long timeoutMs = 1000;
+};
+
+// Serial writes to stdout; setQuiet() mutes it, e.g. for benchmarks
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    int availableForWrite() override { return 128; }
+    operator bool() const { return true; }
+
+    void setQuiet(bool quiet) { this->quiet = quiet; }
+
+private:
+    bool quiet = false;
+};
+
+extern HardwareSerial Serial;
+
+// Core functions, answered by the host Hal
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+// SNTP is not started on the host; the system clock is already set
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2 = nullptr,
+                const char *server3 = nullptr);
+bool getLocalTime(struct tm *info, uint32_t ms = 5000);
+
+// FreeRTOS critical sections: a spinlock, enough for the host threads
+struct portMUX_TYPE
+{
+    std::atomic<int> owner;
+};
+#define portMUX_INITIALIZER_UNLOCKED {{0}}
+void portENTER_CRITICAL(portMUX_TYPE *mux);
+void portEXIT_CRITICAL(portMUX_TYPE *mux);
+
+#endif
@@ -0,0 +1,632 @@
+#include "ArduinoJson.h"
+
+namespace HostJson
+{
+    Node *Node::member(const char *key)
+    {
+        if (type != OBJECT)
+        {
+            return nullptr;
+        }
+        for (auto &entry : members)
+        {
+            if (entry.first == key)
+            {
+                return &entry.second;
+            }
+        }
+        return nullptr;
+    }
+
+    Node &Node::memberOrAdd(const char *key)
+    {
+        Node *existing = member(key);
+        if (existing != nullptr)
+        {
+            return *existing;
+        }
+        if (type != OBJECT)
+        {
+            clear();
+            type = OBJECT;
+        }
+        members.push_back(std::make_pair(std::string(key), Node()));
+        return members.back().second;
+    }
+
+    Node *Node::element(size_t index)
+    {
+        if (type != ARRAY || index >= elements.size())
+        {
+            return nullptr;
+        }
+        auto it = elements.begin();
+        std::advance(it, index);
+        return &*it;
+    }
+
+    void Node::clear()
+    {
+        type = NONE;
+        boolean = false;
+        number = 0;
+        text.clear();
+        members.clear();
+        elements.clear();
+    }
+
+    static void appendString(std::string &out, const std::string &text)
+    {
+        out += '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+            }
+            out += c;
+        }
+        out += '"';
+    }
+
+    std::string Node::serialize() const
+    {
+        switch (type)
+        {
+        case BOOLEAN:
+            return boolean ? "true" : "false";
+        case NUMBER:
+        {
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%.9g", number);
+            return buffer;
+        }
+        case TEXT:
+        {
+            std::string out;
+            appendString(out, text);
+            return out;
+        }
+        case OBJECT:
+        {
+            std::string out = "{";
+            for (const auto &entry : members)
+            {
+                if (out.size() > 1)
+                {
+                    out += ',';
+                }
+                appendString(out, entry.first);
+                out += ':';
+                out += entry.second.serialize();
+            }
+            return out + "}";
+        }
+        case ARRAY:
+        {
+            std::string out = "[";
+            for (const auto &element : elements)
+            {
+                if (out.size() > 1)
+                {
+                    out += ',';
+                }
+                out += element.serialize();
+            }
+            return out + "]";
+        }
+        default:
+            return "null";
+        }
+    }
+
+    static double numeric(const Node *node)
+    {
+        if (node == nullptr)
+        {
+            return 0;
+        }
+        if (node->type == Node::NUMBER)
+        {
+            return node->number;
+        }
+        if (node->type == Node::BOOLEAN)
+        {
+            return node->boolean ? 1 : 0;
+        }
+        return 0;
+    }
+
+    void read(const Node *node, bool &value)
+    {
+        value = numeric(node) != 0;
+    }
+
+    void read(const Node *node, int &value)
+    {
+        value = (int)numeric(node);
+    }
+
+    void read(const Node *node, long &value)
+    {
+        value = (long)numeric(node);
+    }
+
+    void read(const Node *node, unsigned int &value)
+    {
+        value = (unsigned int)numeric(node);
+    }
+
+    void read(const Node *node, unsigned long &value)
+    {
+        value = (unsigned long)numeric(node);
+    }
+
+    void read(const Node *node, unsigned char &value)
+    {
+        value = (unsigned char)numeric(node);
+    }
+
+    void read(const Node *node, float &value)
+    {
+        value = (float)numeric(node);
+    }
+
+    void read(const Node *node, double &value)
+    {
+        value = numeric(node);
+    }
+
+    void read(const Node *node, const char *&value)
+    {
+        value = node != nullptr && node->type == Node::TEXT ? node->text.c_str() : nullptr;
+    }
+
+    void read(const Node *node, String &value)
+    {
+        if (node != nullptr && node->type == Node::TEXT)
+        {
+            value = String(node->text);
+        }
+        else
+        {
+            value = String(node != nullptr ? node->serialize() : std::string("null"));
+        }
+    }
+
+    // Input one byte at a time; -1 at the end
+    class Reader
+    {
+    public:
+        virtual ~Reader() {}
+        virtual int read() = 0;
+    };
+
+    class TextReader : public Reader
+    {
+    public:
+        TextReader(const char *text, size_t length) : text(text), length(length), position(0) {}
+        int read() override { return position < length ? (uint8_t)text[position++] : -1; }
+
+    private:
+        const char *text;
+        size_t length;
+        size_t position;
+    };
+
+    class StreamReader : public Reader
+    {
+    public:
+        explicit StreamReader(Stream &stream) : stream(stream) {}
+        int read() override
+        {
+            uint8_t c;
+            return stream.readBytes(&c, 1) == 1 ? c : -1;
+        }
+
+    private:
+        Stream &stream;
+    };
+
+    static const int NESTING_LIMIT = 10;
+
+    class Parser
+    {
+    public:
+        explicit Parser(Reader &reader) : reader(reader), pending(-2) {}
+
+        DeserializationError::Code parse(Node &root, const Node *filter)
+        {
+            int c = skipSpace();
+            if (c < 0)
+            {
+                return DeserializationError::EmptyInput;
+            }
+            pending = c;
+            return value(root, filter, 0);
+        }
+
+    private:
+        Reader &reader;
+        int pending;
+
+        int next()
+        {
+            if (pending != -2)
+            {
+                int c = pending;
+                pending = -2;
+                return c;
+            }
+            return reader.read();
+        }
+
+        int skipSpace()
+        {
+            int c;
+            do
+            {
+                c = next();
+            } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+            return c;
+        }
+
+        // filter: nullptr keeps everything below, otherwise only the members it names
+        DeserializationError::Code value(Node &out, const Node *filter, int depth)
+        {
+            int c = skipSpace();
+            if (c < 0)
+            {
+                return DeserializationError::IncompleteInput;
+            }
+            if (c == '{')
+            {
+                return object(out, filter, depth + 1);
+            }
+            if (c == '[')
+            {
+                return array(out, filter, depth + 1);
+            }
+            if (c == '"')
+            {
+                out.type = Node::TEXT;
+                return string(out.text);
+            }
+            if (c == '-' || (c >= '0' && c <= '9'))
+            {
+                std::string digits(1, (char)c);
+                while ((c = next()) >= 0 && strchr("0123456789+-.eE", c) != nullptr)
+                {
+                    digits += (char)c;
+                }
+                pending = c;
+                char *end = nullptr;
+                out.type = Node::NUMBER;
+                out.number = strtod(digits.c_str(), &end);
+                return *end == '\0' ? DeserializationError::Ok : DeserializationError::InvalidInput;
+            }
+            const char *word = c == 't' ? "true" : c == 'f' ? "false" : c == 'n' ? "null" : nullptr;
+            if (word == nullptr)
+            {
+                return DeserializationError::InvalidInput;
+            }
+            for (const char *p = word + 1; *p; p++)
+            {
+                int d = next();
+                if (d < 0)
+                {
+                    return DeserializationError::IncompleteInput;
+                }
+                if (d != *p)
+                {
+                    return DeserializationError::InvalidInput;
+                }
+            }
+            if (c != 'n')
+            {
+                out.type = Node::BOOLEAN;
+                out.boolean = c == 't';
+            }
+            return DeserializationError::Ok;
+        }
+
+        DeserializationError::Code object(Node &out, const Node *filter, int depth)
+        {
+            if (depth > NESTING_LIMIT)
+            {
+                return DeserializationError::TooDeep;
+            }
+            out.type = Node::OBJECT;
+            int c = skipSpace();
+            if (c == '}')
+            {
+                return DeserializationError::Ok;
+            }
+            while (true)
+            {
+                if (c < 0)
+                {
+                    return DeserializationError::IncompleteInput;
+                }
+                if (c != '"')
+                {
+                    return DeserializationError::InvalidInput;
+                }
+                std::string key;
+                DeserializationError::Code error = string(key);
+                if (error != DeserializationError::Ok)
+                {
+                    return error;
+                }
+                c = skipSpace();
+                if (c != ':')
+                {
+                    return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+                }
+
+                const Node *memberFilter = nullptr;
+                bool keep = true;
+                if (filter != nullptr)
+                {
+                    memberFilter = const_cast<Node *>(filter)->member(key.c_str());
+                    keep = memberFilter != nullptr && !(memberFilter->type == Node::BOOLEAN && !memberFilter->boolean);
+                    if (memberFilter != nullptr && memberFilter->type != Node::OBJECT)
+                    {
+                        // true keeps the whole value
+                        memberFilter = nullptr;
+                    }
+                }
+                Node skipped;
+                Node &target = keep ? out.memberOrAdd(key.c_str()) : skipped;
+                error = value(target, memberFilter, depth);
+                if (error != DeserializationError::Ok)
+                {
+                    return error;
+                }
+
+                c = skipSpace();
+                if (c == '}')
+                {
+                    return DeserializationError::Ok;
+                }
+                if (c != ',')
+                {
+                    return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+                }
+                c = skipSpace();
+            }
+        }
+
+        DeserializationError::Code array(Node &out, const Node *filter, int depth)
+        {
+            if (depth > NESTING_LIMIT)
+            {
+                return DeserializationError::TooDeep;
+            }
+            out.type = Node::ARRAY;
+            int c = skipSpace();
+            if (c == ']')
+            {
+                return DeserializationError::Ok;
+            }
+            pending = c;
+            while (true)
+            {
+                out.elements.push_back(Node());
+                DeserializationError::Code error = value(out.elements.back(), filter, depth);
+                if (error != DeserializationError::Ok)
+                {
+                    return error;
+                }
+                c = skipSpace();
+                if (c == ']')
+                {
+                    return DeserializationError::Ok;
+                }
+                if (c != ',')
+                {
+                    return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+                }
+            }
+        }
+
+        DeserializationError::Code string(std::string &out)
+        {
+            while (true)
+            {
+                int c = next();
+                if (c < 0)
+                {
+                    return DeserializationError::IncompleteInput;
+                }
+                if (c == '"')
+                {
+                    return DeserializationError::Ok;
+                }
+                if (c == '\\')
+                {
+                    c = next();
+                    if (c < 0)
+                    {
+                        return DeserializationError::IncompleteInput;
+                    }
+                    switch (c)
+                    {
+                    case 'n':
+                        c = '\n';
+                        break;
+                    case 't':
+                        c = '\t';
+                        break;
+                    case 'r':
+                        c = '\r';
+                        break;
+                    case 'b':
+                        c = '\b';
+                        break;
+                    case 'f':
+                        c = '\f';
+                        break;
+                    case 'u':
+                    {
+                        // Only the ASCII range is needed here
+                        char hex[5] = {0};
+                        for (int i = 0; i < 4; i++)
+                        {
+                            int h = next();
+                            if (h < 0)
+                            {
+                                return DeserializationError::IncompleteInput;
+                            }
+                            hex[i] = (char)h;
+                        }
+                        c = (int)strtol(hex, nullptr, 16) & 0x7F;
+                        break;
+                    }
+                    default:
+                        break;
+                    }
+                }
+                out += (char)c;
+            }
+        }
+    };
+
+    static DeserializationError deserialize(JsonDocument &doc, Reader &reader, const Node *filter)
+    {
+        doc.clear();
+        Parser parser(reader);
+        DeserializationError::Code code = parser.parse(doc.getRoot(), filter);
+        return DeserializationError(code);
+    }
+}
+
+JsonVariant JsonVariant::operator[](const char *key) const
+{
+    if (node == nullptr)
+    {
+        return JsonVariant();
+    }
+    if (writable)
+    {
+        return JsonVariant(&node->memberOrAdd(key), true);
+    }
+    return JsonVariant(node->member(key), false);
+}
+
+JsonVariant JsonVariant::operator[](int index) const
+{
+    return JsonVariant(node != nullptr ? node->element(index) : nullptr, writable);
+}
+
+const JsonVariant &JsonVariant::operator=(bool value) const
+{
+    if (node != nullptr && writable)
+    {
+        node->clear();
+        node->type = HostJson::Node::BOOLEAN;
+        node->boolean = value;
+    }
+    return *this;
+}
+
+const JsonVariant &JsonVariant::operator=(const char *value) const
+{
+    if (node != nullptr && writable)
+    {
+        node->clear();
+        if (value != nullptr)
+        {
+            node->type = HostJson::Node::TEXT;
+            node->text = value;
+        }
+    }
+    return *this;
+}
+
+const JsonVariant &JsonVariant::setNumber(double value) const
+{
+    if (node != nullptr && writable)
+    {
+        node->clear();
+        node->type = HostJson::Node::NUMBER;
+        node->number = value;
+    }
+    return *this;
+}
+
+JsonObject JsonVariant::createNestedObject(const char *key) const
+{
+    if (node == nullptr || !writable)
+    {
+        return JsonObject();
+    }
+    HostJson::Node &child = node->memberOrAdd(key);
+    child.clear();
+    child.type = HostJson::Node::OBJECT;
+    return JsonObject(&child, true);
+}
+
+const char *DeserializationError::c_str() const
+{
+    static const char *const NAMES[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+    return NAMES[value];
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const char *input)
+{
+    return deserializeJson(doc, input, input != nullptr ? strlen(input) : 0);
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length)
+{
+    HostJson::TextReader reader(input, length);
+    return HostJson::deserialize(doc, reader, nullptr);
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const uint8_t *input, size_t length)
+{
+    return deserializeJson(doc, (const char *)input, length);
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const String &input)
+{
+    return deserializeJson(doc, input.c_str(), input.length());
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, Stream &input)
+{
+    HostJson::StreamReader reader(input);
+    return HostJson::deserialize(doc, reader, nullptr);
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, Stream &input, DeserializationOption::Filter filter)
+{
+    HostJson::StreamReader reader(input);
+    return HostJson::deserialize(doc, reader, filter.node);
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const char *input, DeserializationOption::Filter filter)
+{
+    HostJson::TextReader reader(input, input != nullptr ? strlen(input) : 0);
+    return HostJson::deserialize(doc, reader, filter.node);
+}
+
+size_t serializeJson(const JsonDocument &doc, Print &out)
+{
+    std::string text = doc.getRoot().serialize();
+    return out.write((const uint8_t *)text.data(), text.size());
+}
+
+size_t serializeJson(const JsonDocument &doc, char *buffer, size_t size)
+{
+    std::string text = doc.getRoot().serialize();
+    if (size == 0)
+    {
+        return 0;
+    }
+    size_t length = min(text.size(), size - 1);
+    memcpy(buffer, text.data(), length);
+    buffer[length] = '\0';
+    return length;
+}
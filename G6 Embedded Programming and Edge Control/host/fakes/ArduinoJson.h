@@ -0,0 +1,208 @@
+#ifndef HOST_ARDUINOJSON_H
+#define HOST_ARDUINOJSON_H
+
+#include <Arduino.h>
+#include <list>
+#include <string>
+#include <utility>
+
+// Host stand-in for the part of ArduinoJson 6 the G6 modules use: documents
+// built with operator[] and createNestedObject(), deserializeJson() from a
+// string or a Stream (with a filter), as<T>() and implicit conversions.
+//
+// Values live in std containers, so the capacity of StaticJsonDocument is
+// not enforced. deserializeJson() on a Stream reads exactly up to the end of
+// one value and leaves the rest in the stream, as the library does; reads
+// go through readBytes(), so they honour the stream timeout.
+namespace HostJson
+{
+    struct Node
+    {
+        enum Type : uint8_t
+        {
+            NONE,
+            BOOLEAN,
+            NUMBER,
+            TEXT,
+            OBJECT,
+            ARRAY
+        };
+
+        Type type = NONE;
+        bool boolean = false;
+        double number = 0;
+        std::string text;
+        // std::list keeps member addresses stable while siblings are added
+        std::list<std::pair<std::string, Node>> members;
+        std::list<Node> elements;
+
+        // nullptr if this is not an object or has no such member
+        Node *member(const char *key);
+        // Adds the member (turning a null node into an object) if missing
+        Node &memberOrAdd(const char *key);
+        Node *element(size_t index);
+        void clear();
+        std::string serialize() const;
+    };
+
+    void read(const Node *node, bool &value);
+    void read(const Node *node, int &value);
+    void read(const Node *node, long &value);
+    void read(const Node *node, unsigned int &value);
+    void read(const Node *node, unsigned long &value);
+    void read(const Node *node, unsigned char &value);
+    void read(const Node *node, float &value);
+    void read(const Node *node, double &value);
+    void read(const Node *node, const char *&value);
+    void read(const Node *node, String &value);
+}
+
+class JsonObject;
+
+class JsonVariant
+{
+public:
+    JsonVariant() : node(nullptr), writable(false) {}
+    JsonVariant(HostJson::Node *node, bool writable) : node(node), writable(writable) {}
+
+    JsonVariant operator[](const char *key) const;
+    JsonVariant operator[](const String &key) const { return (*this)[key.c_str()]; }
+    JsonVariant operator[](int index) const;
+
+    template <typename T>
+    T as() const
+    {
+        T value;
+        HostJson::read(node, value);
+        return value;
+    }
+
+    template <typename T>
+    operator T() const
+    {
+        return as<T>();
+    }
+
+    template <typename T>
+    T operator|(T fallback) const
+    {
+        return isNull() ? fallback : as<T>();
+    }
+
+    bool isNull() const { return node == nullptr || node->type == HostJson::Node::NONE; }
+
+    const JsonVariant &operator=(bool value) const;
+    const JsonVariant &operator=(int value) const { return setNumber(value); }
+    const JsonVariant &operator=(long value) const { return setNumber(value); }
+    const JsonVariant &operator=(unsigned int value) const { return setNumber(value); }
+    const JsonVariant &operator=(unsigned long value) const { return setNumber(value); }
+    const JsonVariant &operator=(double value) const { return setNumber(value); }
+    const JsonVariant &operator=(const char *value) const;
+    const JsonVariant &operator=(const String &value) const { return *this = value.c_str(); }
+
+    JsonObject createNestedObject(const char *key) const;
+
+protected:
+    HostJson::Node *node;
+    bool writable;
+
+    const JsonVariant &setNumber(double value) const;
+};
+
+class JsonObject : public JsonVariant
+{
+public:
+    JsonObject() {}
+    JsonObject(HostJson::Node *node, bool writable) : JsonVariant(node, writable) {}
+};
+
+class JsonDocument
+{
+public:
+    JsonDocument() {}
+    JsonDocument(const JsonDocument &) = delete;
+    JsonDocument &operator=(const JsonDocument &) = delete;
+
+    JsonVariant operator[](const char *key) { return JsonVariant(&root, true)[key]; }
+    JsonVariant operator[](const char *key) const { return JsonVariant(const_cast<HostJson::Node *>(&root), false)[key]; }
+    JsonVariant operator[](const String &key) { return (*this)[key.c_str()]; }
+    JsonVariant operator[](const String &key) const { return (*this)[key.c_str()]; }
+    JsonVariant operator[](int index) const { return JsonVariant(const_cast<HostJson::Node *>(&root), false)[index]; }
+
+    template <typename T>
+    T as() const
+    {
+        return JsonVariant(const_cast<HostJson::Node *>(&root), false).as<T>();
+    }
+
+    JsonObject createNestedObject(const char *key) { return JsonVariant(&root, true).createNestedObject(key); }
+    bool isNull() const { return root.type == HostJson::Node::NONE; }
+    void clear() { root.clear(); }
+    bool overflowed() const { return false; }
+
+    // Host only
+    HostJson::Node &getRoot() { return root; }
+    const HostJson::Node &getRoot() const { return root; }
+
+private:
+    HostJson::Node root;
+};
+
+template <size_t Capacity>
+class StaticJsonDocument : public JsonDocument
+{
+};
+
+class DynamicJsonDocument : public JsonDocument
+{
+public:
+    explicit DynamicJsonDocument(size_t) {}
+};
+
+class DeserializationError
+{
+public:
+    enum Code
+    {
+        Ok,
+        EmptyInput,
+        IncompleteInput,
+        InvalidInput,
+        NoMemory,
+        TooDeep
+    };
+
+    DeserializationError(Code code = Ok) : value(code) {}
+
+    explicit operator bool() const { return value != Ok; }
+    bool operator==(Code code) const { return value == code; }
+    bool operator!=(Code code) const { return value != code; }
+    Code code() const { return value; }
+    const char *c_str() const;
+
+private:
+    Code value;
+};
+
+namespace DeserializationOption
+{
+    class Filter
+    {
+    public:
+        explicit Filter(const JsonDocument &filter) : node(&filter.getRoot()) {}
+        const HostJson::Node *node;
+    };
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const char *input);
+DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length);
+DeserializationError deserializeJson(JsonDocument &doc, const uint8_t *input, size_t length);
+DeserializationError deserializeJson(JsonDocument &doc, const String &input);
+DeserializationError deserializeJson(JsonDocument &doc, Stream &input);
+DeserializationError deserializeJson(JsonDocument &doc, Stream &input, DeserializationOption::Filter filter);
+DeserializationError deserializeJson(JsonDocument &doc, const char *input, DeserializationOption::Filter filter);
+
+size_t serializeJson(const JsonDocument &doc, Print &out);
+size_t serializeJson(const JsonDocument &doc, char *buffer, size_t size);
+
+#endif
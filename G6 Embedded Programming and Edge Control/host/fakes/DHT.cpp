@@ -0,0 +1,58 @@
+#include "DHT.h"
+#include <map>
+
+namespace
+{
+    struct Reading
+    {
+        float temperature;
+        float humidity;
+        uint32_t reads;
+    };
+
+    std::map<uint8_t, Reading> &readings()
+    {
+        static std::map<uint8_t, Reading> table;
+        return table;
+    }
+}
+
+DHT::DHT(uint8_t pin, uint8_t type, uint8_t count) : pin(pin)
+{
+}
+
+float DHT::readTemperature(bool fahrenheit, bool force)
+{
+    auto found = readings().find(pin);
+    if (found == readings().end())
+    {
+        return NAN;
+    }
+    found->second.reads++;
+    float celsius = found->second.temperature;
+    return fahrenheit ? celsius * 1.8f + 32 : celsius;
+}
+
+float DHT::readHumidity(bool force)
+{
+    auto found = readings().find(pin);
+    return found != readings().end() ? found->second.humidity : NAN;
+}
+
+void DHT::setReading(uint8_t pin, float temperature, float humidity)
+{
+    Reading &reading = readings()[pin];
+    reading.temperature = temperature;
+    reading.humidity = humidity;
+}
+
+void DHT::clearReadings()
+{
+    readings().clear();
+}
+
+uint32_t DHT::getReads(uint8_t pin)
+{
+    auto found = readings().find(pin);
+    return found != readings().end() ? found->second.reads : 0;
+}
@@ -0,0 +1,30 @@
+#ifndef HOST_DHT_H
+#define HOST_DHT_H
+
+#include <Arduino.h>
+
+#define DHT11 11
+#define DHT22 22
+
+// Host stand-in for the Adafruit DHT driver. Readings come from a table per
+// pin set with setReading(); a pin with no reading returns NAN, as a sensor
+// that does not answer does. Reads are counted to check the polling rate.
+class DHT
+{
+public:
+    DHT(uint8_t pin, uint8_t type, uint8_t count = 6);
+
+    void begin(uint8_t usecMaxCycles = 55) {}
+    float readTemperature(bool fahrenheit = false, bool force = false);
+    float readHumidity(bool force = false);
+
+    // Host only
+    static void setReading(uint8_t pin, float temperature, float humidity);
+    static void clearReadings();
+    static uint32_t getReads(uint8_t pin);
+
+private:
+    uint8_t pin;
+};
+
+#endif
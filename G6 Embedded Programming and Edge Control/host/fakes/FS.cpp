@@ -0,0 +1,254 @@
+#include "FS.h"
+
+using namespace fs;
+
+size_t File::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size)
+{
+    if (!data || !writable)
+    {
+        return 0;
+    }
+    if (offset + size > data->size())
+    {
+        data->resize(offset + size);
+    }
+    memcpy(data->data() + offset, buffer, size);
+    offset += size;
+    return size;
+}
+
+int File::available()
+{
+    return data && offset < data->size() ? (int)(data->size() - offset) : 0;
+}
+
+int File::read()
+{
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek()
+{
+    return available() > 0 ? (*data)[offset] : -1;
+}
+
+size_t File::read(uint8_t *buffer, size_t size)
+{
+    size_t count = min(size, (size_t)available());
+    if (count > 0)
+    {
+        memcpy(buffer, data->data() + offset, count);
+        offset += count;
+    }
+    return count;
+}
+
+bool File::seek(uint32_t position, SeekMode mode)
+{
+    if (!data)
+    {
+        return false;
+    }
+    size_t base = mode == SeekSet ? 0 : (mode == SeekCur ? offset : data->size());
+    if (base + position > data->size())
+    {
+        return false;
+    }
+    offset = base + position;
+    return true;
+}
+
+size_t File::position() const
+{
+    return offset;
+}
+
+size_t File::size() const
+{
+    return data ? data->size() : 0;
+}
+
+void File::close()
+{
+    owner = nullptr;
+    data.reset();
+    directory = false;
+}
+
+File::operator bool() const
+{
+    return owner != nullptr;
+}
+
+bool File::isDirectory() const
+{
+    return directory;
+}
+
+File File::openNextFile(const char *mode)
+{
+    if (!directory || owner == nullptr)
+    {
+        return File();
+    }
+    std::string entry = owner->entryOf(filePath, nextEntry);
+    if (entry.empty())
+    {
+        return File();
+    }
+    nextEntry++;
+    return owner->open(entry.c_str(), mode);
+}
+
+const char *File::name() const
+{
+    return fileName.c_str();
+}
+
+const char *File::path() const
+{
+    return filePath.c_str();
+}
+
+File FS::open(const char *path, const char *mode, bool create)
+{
+    File file;
+    std::string name(path);
+    if (directories.count(name) > 0)
+    {
+        file.owner = this;
+        file.filePath = name;
+        file.fileName = name.substr(name.rfind('/') + 1);
+        file.directory = true;
+        return file;
+    }
+
+    bool writing = mode[0] == 'w' || mode[0] == 'a';
+    std::map<std::string, std::shared_ptr<FileData>>::iterator found = files.find(name);
+    if (found == files.end())
+    {
+        // Like LittleFS, the parent directory has to exist unless create is set
+        if (!writing || (!create && parentOf(name) != "" && directories.count(parentOf(name)) == 0))
+        {
+            return file;
+        }
+        found = files.insert(std::make_pair(name, std::make_shared<FileData>())).first;
+    }
+    if (mode[0] == 'w')
+    {
+        found->second->clear();
+    }
+
+    file.owner = this;
+    file.filePath = name;
+    file.fileName = name.substr(name.rfind('/') + 1);
+    file.data = found->second;
+    file.writable = writing || strchr(mode, '+') != nullptr;
+    file.offset = mode[0] == 'a' ? found->second->size() : 0;
+    return file;
+}
+
+File FS::open(const String &path, const char *mode, bool create)
+{
+    return open(path.c_str(), mode, create);
+}
+
+bool FS::exists(const char *path)
+{
+    return files.count(path) > 0 || directories.count(path) > 0;
+}
+
+bool FS::exists(const String &path)
+{
+    return exists(path.c_str());
+}
+
+bool FS::remove(const char *path)
+{
+    return files.erase(path) > 0;
+}
+
+bool FS::remove(const String &path)
+{
+    return remove(path.c_str());
+}
+
+bool FS::rename(const char *from, const char *to)
+{
+    std::map<std::string, std::shared_ptr<FileData>>::iterator found = files.find(from);
+    if (found == files.end())
+    {
+        return false;
+    }
+    files[to] = found->second;
+    files.erase(found);
+    return true;
+}
+
+bool FS::rename(const String &from, const String &to)
+{
+    return rename(from.c_str(), to.c_str());
+}
+
+bool FS::mkdir(const char *path)
+{
+    if (files.count(path) > 0)
+    {
+        return false;
+    }
+    directories[path] = true;
+    return true;
+}
+
+bool FS::mkdir(const String &path)
+{
+    return mkdir(path.c_str());
+}
+
+bool FS::rmdir(const char *path)
+{
+    if (!entryOf(path, 0).empty())
+    {
+        return false;
+    }
+    return directories.erase(path) > 0;
+}
+
+bool FS::rmdir(const String &path)
+{
+    return rmdir(path.c_str());
+}
+
+size_t FS::usedBytes() const
+{
+    size_t total = 0;
+    for (std::map<std::string, std::shared_ptr<FileData>>::const_iterator it = files.begin(); it != files.end(); ++it)
+    {
+        total += it->second->size();
+    }
+    return total;
+}
+
+std::string FS::entryOf(const std::string &directory, size_t index) const
+{
+    for (std::map<std::string, std::shared_ptr<FileData>>::const_iterator it = files.begin(); it != files.end(); ++it)
+    {
+        if (parentOf(it->first) == directory && index-- == 0)
+        {
+            return it->first;
+        }
+    }
+    return std::string();
+}
+
+std::string FS::parentOf(const std::string &path)
+{
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos || slash == 0 ? std::string() : path.substr(0, slash);
+}
@@ -0,0 +1,97 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Host stand-in for the core's fs::FS: a file system held in memory, with
+// the open modes and directory iteration OfflineQueue relies on. Each FS
+// object is its own empty volume, so a test can keep one alive across a
+// simulated reboot or start from scratch.
+namespace fs
+{
+    enum SeekMode
+    {
+        SeekSet = 0,
+        SeekCur = 1,
+        SeekEnd = 2
+    };
+
+    typedef std::vector<uint8_t> FileData;
+
+    class FS;
+
+    class File : public Stream
+    {
+    public:
+        File() {}
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t *buffer, size_t size) override;
+        using Print::write;
+        int available() override;
+        int read() override;
+        int peek() override;
+        size_t read(uint8_t *buffer, size_t size);
+        bool seek(uint32_t position, SeekMode mode = SeekSet);
+        size_t position() const;
+        size_t size() const;
+        void close();
+        operator bool() const;
+
+        bool isDirectory() const;
+        File openNextFile(const char *mode = "r");
+        const char *name() const;
+        const char *path() const;
+
+    private:
+        friend class FS;
+
+        FS *owner = nullptr;
+        std::string filePath;
+        std::string fileName;
+        std::shared_ptr<FileData> data;   // null for a directory
+        bool directory = false;
+        bool writable = false;
+        size_t offset = 0;
+        size_t nextEntry = 0;
+    };
+
+    class FS
+    {
+    public:
+        File open(const char *path, const char *mode = "r", bool create = false);
+        File open(const String &path, const char *mode = "r", bool create = false);
+        bool exists(const char *path);
+        bool exists(const String &path);
+        bool remove(const char *path);
+        bool remove(const String &path);
+        bool rename(const char *from, const char *to);
+        bool rename(const String &from, const String &to);
+        bool mkdir(const char *path);
+        bool mkdir(const String &path);
+        bool rmdir(const char *path);
+        bool rmdir(const String &path);
+
+        // Host only: total bytes stored in files
+        size_t usedBytes() const;
+
+    private:
+        friend class File;
+
+        std::map<std::string, std::shared_ptr<FileData>> files;
+        std::map<std::string, bool> directories;
+
+        // Path of the index-th entry directly inside directory, empty past the last
+        std::string entryOf(const std::string &directory, size_t index) const;
+        static std::string parentOf(const std::string &path);
+    };
+}
+
+using fs::File;
+using fs::FS;
+
+#endif
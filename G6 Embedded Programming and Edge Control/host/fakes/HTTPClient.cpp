@@ -0,0 +1,286 @@
+#include "HTTPClient.h"
+
+namespace
+{
+    struct Queued
+    {
+        int code;
+        std::string body;
+        std::vector<std::pair<std::string, std::string>> headers;
+        size_t chunkSize;
+    };
+
+    std::deque<Queued> &responses()
+    {
+        static std::deque<Queued> queue;
+        return queue;
+    }
+
+    std::vector<HTTPClient::Request> &recorded()
+    {
+        static std::vector<HTTPClient::Request> list;
+        return list;
+    }
+
+    bool sameName(const std::string &a, const char *b)
+    {
+        return strcasecmp(a.c_str(), b) == 0;
+    }
+
+    // Reads one CRLF-terminated line of the chunk framing
+    std::string readLine(WiFiClient &client)
+    {
+        std::string line;
+        int c;
+        while ((c = client.read()) >= 0 && c != '\n')
+        {
+            if (c != '\r')
+            {
+                line += (char)c;
+            }
+        }
+        return line;
+    }
+}
+
+HTTPClient::HTTPClient() : client(nullptr), bodyPending(false)
+{
+    response.code = 0;
+    response.chunkSize = 0;
+}
+
+bool HTTPClient::begin(WiFiClient &client, const char *url)
+{
+    this->client = &client;
+    request = Request();
+    request.url = url;
+    response = Response();
+    bodyPending = false;
+    return strncmp(url, "http", 4) == 0;
+}
+
+bool HTTPClient::begin(const char *url)
+{
+    return begin(ownClient, url);
+}
+
+void HTTPClient::end()
+{
+    if (client != nullptr)
+    {
+        // As the library does, whatever is left of the body is skipped
+        while (client->read() >= 0)
+        {
+        }
+    }
+    bodyPending = false;
+}
+
+void HTTPClient::addHeader(const String &name, const String &value)
+{
+    request.headers.push_back(std::make_pair(std::string(name.c_str()), std::string(value.c_str())));
+}
+
+void HTTPClient::collectHeaders(const char *headerKeys[], size_t count)
+{
+    collected.assign(headerKeys, headerKeys + count);
+}
+
+String HTTPClient::header(const char *name)
+{
+    bool wanted = false;
+    for (const std::string &key : collected)
+    {
+        wanted = wanted || sameName(key, name);
+    }
+    if (wanted)
+    {
+        for (const auto &entry : response.headers)
+        {
+            if (sameName(entry.first, name))
+            {
+                return String(entry.second);
+            }
+        }
+    }
+    return String();
+}
+
+int HTTPClient::GET()
+{
+    return send("GET", "");
+}
+
+int HTTPClient::POST(uint8_t *payload, size_t size)
+{
+    return send("POST", std::string((const char *)payload, size));
+}
+
+int HTTPClient::POST(const String &payload)
+{
+    return send("POST", payload.c_str());
+}
+
+int HTTPClient::send(const char *method, const std::string &body)
+{
+    request.method = method;
+    request.body = body;
+    recorded().push_back(request);
+
+    if (client == nullptr)
+    {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    if (!client->connected() && !client->connect(request.url.c_str(), 443))
+    {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    if (responses().empty())
+    {
+        client->stop();
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    Queued next = responses().front();
+    responses().pop_front();
+    if (next.code <= 0)
+    {
+        client->stop();
+        return next.code;
+    }
+
+    response.code = next.code;
+    response.body = next.body;
+    response.headers = next.headers;
+    response.chunkSize = next.chunkSize;
+    if (next.chunkSize > 0)
+    {
+        response.headers.push_back(std::make_pair(std::string("Transfer-Encoding"), std::string("chunked")));
+    }
+    else
+    {
+        response.headers.push_back(std::make_pair(std::string("Content-Length"), std::to_string(next.body.size())));
+    }
+
+    std::string wire;
+    if (next.chunkSize > 0)
+    {
+        for (size_t offset = 0; offset < next.body.size(); offset += next.chunkSize)
+        {
+            size_t length = min(next.chunkSize, next.body.size() - offset);
+            char size[16];
+            snprintf(size, sizeof(size), "%zx\r\n", length);
+            wire += size;
+            wire.append(next.body, offset, length);
+            wire += "\r\n";
+        }
+        wire += "0\r\n\r\n";
+    }
+    else
+    {
+        wire = next.body;
+    }
+    client->feed((const uint8_t *)wire.data(), wire.size());
+    bodyPending = true;
+    return next.code;
+}
+
+int HTTPClient::getSize()
+{
+    return response.chunkSize > 0 ? -1 : (int)response.body.size();
+}
+
+WiFiClient &HTTPClient::getStream()
+{
+    return client != nullptr ? *client : ownClient;
+}
+
+WiFiClient *HTTPClient::getStreamPtr()
+{
+    return client;
+}
+
+int HTTPClient::writeToStream(Stream *stream)
+{
+    if (client == nullptr || !bodyPending)
+    {
+        return HTTPC_ERROR_CONNECTION_LOST;
+    }
+    bodyPending = false;
+
+    int written = 0;
+    if (response.chunkSize == 0)
+    {
+        int c;
+        for (size_t i = 0; i < response.body.size() && (c = client->read()) >= 0; i++)
+        {
+            stream->write((uint8_t)c);
+            written++;
+        }
+        return written;
+    }
+
+    while (true)
+    {
+        std::string line = readLine(*client);
+        if (line.empty())
+        {
+            return HTTPC_ERROR_CONNECTION_LOST;
+        }
+        size_t length = strtoul(line.c_str(), nullptr, 16);
+        if (length == 0)
+        {
+            readLine(*client);
+            return written;
+        }
+        for (size_t i = 0; i < length; i++)
+        {
+            int c = client->read();
+            if (c < 0)
+            {
+                return HTTPC_ERROR_CONNECTION_LOST;
+            }
+            stream->write((uint8_t)c);
+            written++;
+        }
+        readLine(*client);
+    }
+}
+
+String HTTPClient::getString()
+{
+    class StringStream : public Stream
+    {
+    public:
+        std::string text;
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+        size_t write(uint8_t c) override
+        {
+            text += (char)c;
+            return 1;
+        }
+        using Print::write;
+    } sink;
+    writeToStream(&sink);
+    return String(sink.text);
+}
+
+void HTTPClient::respond(int code, const std::string &body,
+                         const std::vector<std::pair<std::string, std::string>> &headers, size_t chunkSize)
+{
+    Queued next = {code, body, headers, chunkSize};
+    responses().push_back(next);
+}
+
+const std::vector<HTTPClient::Request> &HTTPClient::requests()
+{
+    return recorded();
+}
+
+void HTTPClient::reset()
+{
+    responses().clear();
+    recorded().clear();
+}
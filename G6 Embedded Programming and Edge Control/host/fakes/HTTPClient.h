@@ -0,0 +1,91 @@
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NO_CONTENT 204
+#define HTTP_CODE_NOT_MODIFIED 304
+#define HTTP_CODE_NOT_FOUND 404
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-11)
+
+// Host stand-in for the ESP32 HTTPClient. Requests never leave the process:
+// each GET or POST takes the next response queued with respond() (shared by
+// every instance, like a server would be) and is recorded for inspection.
+//
+// A response body is fed into the WiFiClient given to begin(), chunk-encoded
+// if the response is chunked, so getStream() behaves like the socket does on
+// the node. writeToStream() and getString() hand out the decoded body.
+class HTTPClient
+{
+public:
+    struct Request
+    {
+        std::string method;
+        std::string url;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+    };
+
+    HTTPClient();
+
+    bool begin(WiFiClient &client, const char *url);
+    bool begin(WiFiClient &client, const String &url) { return begin(client, url.c_str()); }
+    bool begin(const char *url);
+    bool begin(const String &url) { return begin(url.c_str()); }
+    void end();
+    void setReuse(bool reuse) {}
+    void setTimeout(uint16_t timeoutMs) {}
+
+    void addHeader(const String &name, const String &value);
+    void collectHeaders(const char *headerKeys[], size_t count);
+    String header(const char *name);
+
+    int GET();
+    int POST(uint8_t *payload, size_t size);
+    int POST(const String &payload);
+
+    // Body length from Content-Length, -1 for a chunked body
+    int getSize();
+    WiFiClient &getStream();
+    WiFiClient *getStreamPtr();
+    // Decoded body into stream; the byte count, or a negative error
+    int writeToStream(Stream *stream);
+    String getString();
+
+    // Host only
+    // A code <= 0 fails the request as a transport error and sends nothing
+    static void respond(int code, const std::string &body = "",
+                        const std::vector<std::pair<std::string, std::string>> &headers = {},
+                        size_t chunkSize = 0);
+    static const std::vector<Request> &requests();
+    // Drops the queued responses and recorded requests
+    static void reset();
+
+private:
+    struct Response
+    {
+        int code;
+        std::string body;
+        std::vector<std::pair<std::string, std::string>> headers;
+        size_t chunkSize;
+    };
+
+    WiFiClient *client;
+    WiFiClient ownClient;
+    Request request;
+    Response response;
+    bool bodyPending;
+    std::vector<std::string> collected;
+
+    int send(const char *method, const std::string &body);
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "Preferences.h"
+
+namespace
+{
+    std::map<std::string, std::map<std::string, std::string>> &store()
+    {
+        static std::map<std::string, std::map<std::string, std::string>> namespaces;
+        return namespaces;
+    }
+
+    uint32_t &writes()
+    {
+        static uint32_t count = 0;
+        return count;
+    }
+}
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+    // NVS namespace names are at most 15 characters
+    if (name == nullptr || strlen(name) > 15)
+    {
+        return false;
+    }
+    if (readOnly && store().find(name) == store().end())
+    {
+        // Opening a namespace that was never written fails read-only
+        return false;
+    }
+    entries = &store()[name];
+    this->readOnly = readOnly;
+    return true;
+}
+
+void Preferences::end()
+{
+    entries = nullptr;
+}
+
+bool Preferences::clear()
+{
+    if (entries == nullptr || readOnly)
+    {
+        return false;
+    }
+    entries->clear();
+    writes()++;
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    if (entries == nullptr || readOnly)
+    {
+        return false;
+    }
+    writes()++;
+    return entries->erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    return find(key) != nullptr;
+}
+
+const std::string *Preferences::find(const char *key) const
+{
+    if (entries == nullptr)
+    {
+        return nullptr;
+    }
+    auto found = entries->find(key);
+    return found != entries->end() ? &found->second : nullptr;
+}
+
+size_t Preferences::put(const char *key, const void *value, size_t length)
+{
+    if (entries == nullptr || readOnly)
+    {
+        return 0;
+    }
+    (*entries)[key].assign((const char *)value, length);
+    writes()++;
+    return length;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length)
+{
+    return put(key, value, length);
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    const std::string *value = find(key);
+    return value != nullptr ? value->size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength)
+{
+    const std::string *value = find(key);
+    if (value == nullptr || value->size() > maxLength)
+    {
+        return 0;
+    }
+    memcpy(buffer, value->data(), value->size());
+    return value->size();
+}
+
+size_t Preferences::putString(const char *key, const String &value)
+{
+    return put(key, value.c_str(), value.length());
+}
+
+String Preferences::getString(const char *key, const String &defaultValue)
+{
+    const std::string *value = find(key);
+    return value != nullptr ? String(*value) : defaultValue;
+}
+
+size_t Preferences::putFloat(const char *key, float value)
+{
+    return put(key, &value, sizeof(value));
+}
+
+float Preferences::getFloat(const char *key, float defaultValue)
+{
+    const std::string *value = find(key);
+    if (value == nullptr || value->size() != sizeof(float))
+    {
+        return defaultValue;
+    }
+    float result;
+    memcpy(&result, value->data(), sizeof(result));
+    return result;
+}
+
+void Preferences::reset()
+{
+    store().clear();
+    writes() = 0;
+}
+
+uint32_t Preferences::getWrites()
+{
+    return writes();
+}
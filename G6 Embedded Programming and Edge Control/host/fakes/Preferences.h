@@ -0,0 +1,43 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+
+// Host stand-in for the NVS-backed Preferences. Every namespace lives in one
+// process-wide store, so what one instance writes the next one reads back, as
+// across reboots on the node; reset() plays a flash erase. Writes through a
+// read-only handle fail, and writes are counted to check flash wear.
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false);
+    void end();
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putBytes(const char *key, const void *value, size_t length);
+    size_t getBytesLength(const char *key);
+    size_t getBytes(const char *key, void *buffer, size_t maxLength);
+    size_t putString(const char *key, const String &value);
+    String getString(const char *key, const String &defaultValue = String());
+    size_t putFloat(const char *key, float value);
+    float getFloat(const char *key, float defaultValue = NAN);
+
+    // Host only
+    static void reset();
+    static uint32_t getWrites();
+
+private:
+    typedef std::map<std::string, std::string> Entries;
+
+    Entries *entries = nullptr;
+    bool readOnly = true;
+
+    const std::string *find(const char *key) const;
+    size_t put(const char *key, const void *value, size_t length);
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "WiFi.h"
+
+WiFiClass WiFi;
+
+IPAddress::IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+    octets[0] = a;
+    octets[1] = b;
+    octets[2] = c;
+    octets[3] = d;
+}
+
+String IPAddress::toString() const
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+    return String(text);
+}
+
+wl_status_t WiFiClass::begin(const char *, const char *)
+{
+    beginCalls++;
+    return linkStatus;
+}
+
+wl_status_t WiFiClass::status()
+{
+    return linkStatus;
+}
+
+bool WiFiClass::reconnect()
+{
+    beginCalls++;
+    return linkStatus == WL_CONNECTED;
+}
+
+bool WiFiClass::disconnect(bool)
+{
+    linkStatus = WL_DISCONNECTED;
+    return true;
+}
+
+bool WiFiClass::setAutoReconnect(bool)
+{
+    return true;
+}
+
+IPAddress WiFiClass::localIP()
+{
+    return linkStatus == WL_CONNECTED ? IPAddress(192, 168, 4, 2) : IPAddress();
+}
+
+int8_t WiFiClass::RSSI()
+{
+    return linkStatus == WL_CONNECTED ? -60 : 0;
+}
+
+void WiFiClass::setStatus(wl_status_t status)
+{
+    linkStatus = status;
+}
+
+uint32_t WiFiClass::getBeginCalls() const
+{
+    return beginCalls;
+}
+
+int WiFiClient::connect(const char *, uint16_t)
+{
+    open = WiFi.status() == WL_CONNECTED;
+    return open ? 1 : 0;
+}
+
+size_t WiFiClient::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+    if (!open || WiFi.status() != WL_CONNECTED)
+    {
+        return 0;
+    }
+    output.append((const char *)buffer, size);
+    return size;
+}
+
+int WiFiClient::available()
+{
+    return (int)(input.size() - inputOffset);
+}
+
+int WiFiClient::read()
+{
+    return available() > 0 ? (uint8_t)input[inputOffset++] : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size)
+{
+    size_t count = min(size, (size_t)available());
+    memcpy(buffer, input.data() + inputOffset, count);
+    inputOffset += count;
+    return (int)count;
+}
+
+int WiFiClient::peek()
+{
+    return available() > 0 ? (uint8_t)input[inputOffset] : -1;
+}
+
+void WiFiClient::stop()
+{
+    open = false;
+}
+
+uint8_t WiFiClient::connected()
+{
+    return open && WiFi.status() == WL_CONNECTED ? 1 : 0;
+}
+
+WiFiClient::operator bool()
+{
+    return connected() != 0;
+}
+
+void WiFiClient::feed(const uint8_t *buffer, size_t size)
+{
+    input.append((const char *)buffer, size);
+}
+
+const std::string &WiFiClient::sent() const
+{
+    return output;
+}
+
+void WiFiClient::clearSent()
+{
+    output.clear();
+}
@@ -0,0 +1,82 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <string>
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class IPAddress
+{
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0);
+    String toString() const;
+
+private:
+    uint8_t octets[4];
+};
+
+// Host stand-in for the WiFi station. The link state is whatever the test
+// sets with setStatus(); begin() and reconnect() are only counted.
+class WiFiClass
+{
+public:
+    wl_status_t begin(const char *ssid, const char *password = nullptr);
+    wl_status_t status();
+    bool reconnect();
+    bool disconnect(bool wifiOff = false);
+    bool setAutoReconnect(bool autoReconnect);
+    IPAddress localIP();
+    int8_t RSSI();
+
+    // Host only
+    void setStatus(wl_status_t status);
+    uint32_t getBeginCalls() const;
+
+private:
+    wl_status_t linkStatus = WL_DISCONNECTED;
+    uint32_t beginCalls = 0;
+};
+
+extern WiFiClass WiFi;
+
+// TCP client that connects while WiFi is up and keeps what is written to it.
+// Bytes queued with feed() are returned by the reads.
+class WiFiClient : public Client
+{
+public:
+    int connect(const char *host, uint16_t port) override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size) override;
+    int peek() override;
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override;
+    void setNoDelay(bool) {}
+
+    // Host only
+    void feed(const uint8_t *buffer, size_t size);
+    const std::string &sent() const;
+    void clearSent();
+
+private:
+    bool open = false;
+    std::string output;
+    std::string input;
+    size_t inputOffset = 0;
+};
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef HOST_WIFICLIENTSECURE_H
+#define HOST_WIFICLIENTSECURE_H
+
+#include <WiFi.h>
+
+// No TLS on the host: the secure client is the plain fake client
+class WiFiClientSecure : public WiFiClient
+{
+public:
+    void setInsecure() {}
+    void setCACert(const char *rootCA) {}
+    void setHandshakeTimeout(unsigned long seconds) {}
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "HostTest.h"
+#include "ActuatorModule.h"
+
+// The feed main.ino publishes zone 1 feedback on
+static const char *FEEDBACK_TOPIC = "SmartGrow/feeds/group-1.actuator-feedback";
+
+static void firstCommandIsAppliedAtOnce()
+{
+    ActuatorBank<Zone1Actuators> outputs;
+    ActuatorModule actuator(outputs, nullptr, nullptr, nullptr, "zone1");
+    actuator.begin();
+
+    actuator.handleCommand("{\"light\":\"ON\"}", Hal::micros());
+    CHECK(actuator.isOn(ACTUATOR_LIGHT));
+    CHECK_EQUAL(HIGH, HostHal::outputOf(LIGHT_PIN));
+    CHECK_EQUAL(1, actuator.getCommandStats().applied);
+}
+
+static void commandsAreSpacedApart()
+{
+    ActuatorBank<Zone1Actuators> outputs;
+    ActuatorModule actuator(outputs, nullptr, nullptr, nullptr, "zone1");
+    actuator.begin();
+
+    // Applied in channel order: light now, fan one spacing later
+    actuator.handleCommand("{\"fan\":\"ON\",\"light\":\"ON\"}", Hal::micros());
+    CHECK(actuator.isOn(ACTUATOR_LIGHT));
+    CHECK(!actuator.isOn(ACTUATOR_FAN));
+    CHECK(actuator.hasPendingCommands());
+
+    HostHal::advanceMs(4999);
+    actuator.update();
+    CHECK(!actuator.isOn(ACTUATOR_FAN));
+    HostHal::advanceMs(1);
+    actuator.update();
+    CHECK(actuator.isOn(ACTUATOR_FAN));
+    CHECK_EQUAL(HIGH, HostHal::outputOf(FAN_PIN_2));
+    CHECK(!actuator.hasPendingCommands());
+}
+
+static void newerCommandReplacesAQueuedOne()
+{
+    ActuatorBank<Zone1Actuators> outputs;
+    ActuatorModule actuator(outputs, nullptr, nullptr, nullptr, "zone1");
+    actuator.begin();
+
+    actuator.handleCommand("{\"light\":\"ON\"}", Hal::micros());
+    actuator.handleCommand("{\"pump\":\"ON\"}", Hal::micros());
+    actuator.handleCommand("{\"pump\":\"OFF\"}", Hal::micros());
+    CHECK_EQUAL(1, actuator.getCommandStats().coalesced);
+
+    HostHal::advanceMs(5000);
+    actuator.update();
+    CHECK(!actuator.isPumpOn());
+    CHECK(!actuator.hasPendingCommands());
+}
+
+static void malformedCommandsAreIgnored()
+{
+    ActuatorBank<Zone1Actuators> outputs;
+    ActuatorModule actuator(outputs, nullptr, nullptr, nullptr, "zone1");
+    actuator.begin();
+
+    actuator.handleCommand("{\"light\":", Hal::micros());
+    actuator.handleCommand("{\"heater\":\"ON\"}", Hal::micros());
+    CHECK_EQUAL(0, actuator.getCommandStats().received);
+    CHECK(!actuator.isOn(ACTUATOR_LIGHT));
+}
+
+static void oneTransitionFitsTheFeedbackTopic()
+{
+    Adafruit_MQTT mqtt;
+    mqtt.connect();
+    Adafruit_MQTT_Publish feed(&mqtt, FEEDBACK_TOPIC);
+    ActuatorBank<Zone1Actuators> outputs;
+    ActuatorModule actuator(outputs, nullptr, &feed, nullptr, "zone1");
+    actuator.begin();
+    ClockService::update();
+
+    actuator.setLight(true);
+    actuator.update();
+    CHECK_EQUAL(0, actuator.getFeedbackStats().oversized);
+    CHECK_EQUAL(1, mqtt.published().size());
+
+    // The fake refuses what the library's packet buffer cannot hold
+    const std::vector<uint8_t> &payload = mqtt.published()[0].payload;
+    CHECK(payload.size() + strlen(FEEDBACK_TOPIC) + 5 <= MAXBUFFERSIZE);
+    std::string text(payload.begin(), payload.end());
+    CHECK(text.find("\"tr\":[[\"light ON\",1]]") != std::string::npos);
+}
+
+static void longZoneNamesStillFit()
+{
+    Adafruit_MQTT mqtt;
+    mqtt.connect();
+    Adafruit_MQTT_Publish feed(&mqtt, FEEDBACK_TOPIC);
+    ActuatorBank<Zone1Actuators> outputs;
+    // Longest id ActuatorModule keeps
+    ActuatorModule actuator(outputs, nullptr, &feed, nullptr, "greenhouse-east");
+    actuator.begin();
+    ClockService::update();
+
+    // Every channel switched in one cycle, the longest actions included
+    actuator.setLight(true);
+    actuator.setFan(true);
+    actuator.setPump(true);
+    actuator.setLight(false, false);
+    actuator.setFan(false, false);
+    actuator.setPump(false, false);
+    actuator.update();
+
+    CHECK_EQUAL(0, actuator.getFeedbackStats().oversized);
+    CHECK_EQUAL(0, actuator.getFeedbackStats().publishFailures);
+    CHECK(mqtt.published().size() >= 1);
+    for (const auto &message : mqtt.published())
+    {
+        CHECK(message.payload.size() + strlen(FEEDBACK_TOPIC) + 5 <= MAXBUFFERSIZE);
+    }
+}
+
+int main()
+{
+    RUN_TEST(firstCommandIsAppliedAtOnce);
+    RUN_TEST(commandsAreSpacedApart);
+    RUN_TEST(newerCommandReplacesAQueuedOne);
+    RUN_TEST(malformedCommandsAreIgnored);
+    RUN_TEST(oneTransitionFitsTheFeedbackTopic);
+    RUN_TEST(longZoneNamesStillFit);
+    return HostTest::finish();
+}
@@ -0,0 +1,175 @@
+#include <vector>
+#include "HostTest.h"
+#include "AnalogFilter.h"
+
+static const uint8_t PIN = 34;
+static const AnalogFilter::Config NODE_CONFIG = {8, 5, 3};
+
+// Deterministic noise in [-spread, spread]
+static int noise(uint32_t &state, int spread)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (int)(state % (2 * spread + 1)) - spread;
+}
+
+static double variance(const std::vector<int> &values)
+{
+    double mean = 0;
+    for (int v : values)
+    {
+        mean += v;
+    }
+    mean /= values.size();
+    double sum = 0;
+    for (int v : values)
+    {
+        sum += (v - mean) * (v - mean);
+    }
+    return sum / values.size();
+}
+
+// Counts reads, so oversampling can be checked without the clock moving
+static uint32_t reads = 0;
+
+static uint16_t alternatingReader(uint8_t pin)
+{
+    return reads++ % 2 == 0 ? 1000 : 1100;
+}
+
+static void noiseVarianceIsReduced()
+{
+    uint32_t state = 7;
+    HostHal::setAnalogScript([&state](uint8_t, uint64_t) { return (uint16_t)(2000 + noise(state, 80)); });
+    AnalogFilter filter(PIN);
+    filter.configure(NODE_CONFIG);
+
+    std::vector<int> raw;
+    std::vector<int> filtered;
+    for (int i = 0; i < 500; i++)
+    {
+        raw.push_back(Hal::analogRead(PIN));
+        uint16_t value = filter.sample();
+        if (i >= 50)
+        {
+            filtered.push_back(value);
+        }
+    }
+
+    // Uniform noise of +-80 has a variance of about 2150
+    CHECK(variance(raw) > 1500);
+    CHECK(variance(filtered) < variance(raw) / 100);
+    for (int v : filtered)
+    {
+        CHECK(v >= 1980 && v <= 2020);
+    }
+}
+
+static void singleTickSpikesAreDropped()
+{
+    AnalogFilter filter(PIN);
+    filter.configure(NODE_CONFIG);
+
+    // A relay switching next to the probe: one reading in ten is far off
+    uint32_t state = 3;
+    int worst = 0;
+    for (int i = 0; i < 300; i++)
+    {
+        uint16_t reading = 1500 + noise(state, 10);
+        if (i % 10 == 5)
+        {
+            reading = i % 20 == 5 ? 4095 : 0;
+        }
+        int value = filter.update(reading);
+        if (i >= 10)
+        {
+            worst = max(worst, abs(value - 1500));
+        }
+    }
+    CHECK(worst <= 10);
+}
+
+static void stepResponseSettlesWithoutOvershoot()
+{
+    AnalogFilter filter(PIN);
+    filter.configure(NODE_CONFIG);
+    for (int i = 0; i < 20; i++)
+    {
+        filter.update(1000);
+    }
+    CHECK_EQUAL(1000, filter.value());
+
+    // The median holds the old level until most of its window has the new one
+    CHECK_EQUAL(1000, filter.update(3000));
+    CHECK_EQUAL(1000, filter.update(3000));
+
+    int previous = 1000;
+    int ticksTo99Percent = -1;
+    for (int tick = 3; tick <= 60; tick++)
+    {
+        int value = filter.update(3000);
+        CHECK(value >= previous);
+        CHECK(value <= 3000);
+        if (ticksTo99Percent < 0 && value >= 2980)
+        {
+            ticksTo99Percent = tick;
+        }
+        previous = value;
+    }
+    // 2 ticks of median delay, then the EMA closes 1/8 of the gap per tick
+    CHECK(ticksTo99Percent >= 30 && ticksTo99Percent <= 40);
+    CHECK(filter.value() >= 2995);
+}
+
+static void oversamplingAveragesBackToBackReads()
+{
+    reads = 0;
+    AnalogFilter filter(PIN, alternatingReader);
+    filter.configure({8, 1, 0});
+    CHECK_EQUAL(1050, filter.sample());
+    CHECK_EQUAL(8, reads);
+}
+
+static void disabledStagesPassReadingsThrough()
+{
+    AnalogFilter filter(PIN);
+    filter.configure({1, 1, 0});
+    CHECK_EQUAL(1234, filter.update(1234));
+    CHECK_EQUAL(4000, filter.update(4000));
+    CHECK_EQUAL(7, filter.update(7));
+}
+
+static void invalidConfigIsClamped()
+{
+    AnalogFilter filter(PIN);
+    filter.configure({0, 6, 20});
+    CHECK_EQUAL(1, filter.getConfig().oversample);
+    CHECK_EQUAL(5, filter.getConfig().medianWindow);
+    CHECK_EQUAL(AnalogFilter::MAX_EMA_SHIFT, filter.getConfig().emaShift);
+}
+
+static void attachClearsTheHistory()
+{
+    AnalogFilter filter(PIN);
+    filter.configure(NODE_CONFIG);
+    filter.update(500);
+    CHECK(filter.hasValue());
+
+    filter.attach(PIN + 1);
+    CHECK(!filter.hasValue());
+    // Starts from the first reading on the new pin, not from the old level
+    CHECK_EQUAL(3000, filter.update(3000));
+}
+
+int main()
+{
+    RUN_TEST(noiseVarianceIsReduced);
+    RUN_TEST(singleTickSpikesAreDropped);
+    RUN_TEST(stepResponseSettlesWithoutOvershoot);
+    RUN_TEST(oversamplingAveragesBackToBackReads);
+    RUN_TEST(disabledStagesPassReadingsThrough);
+    RUN_TEST(invalidConfigIsClamped);
+    RUN_TEST(attachClearsTheHistory);
+    return HostTest::finish();
+}
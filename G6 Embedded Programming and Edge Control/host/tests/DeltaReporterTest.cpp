@@ -0,0 +1,211 @@
+#include <map>
+#include <vector>
+#include <ArduinoJson.h>
+#include "HostTest.h"
+#include "DeltaReporter.h"
+#include "PayloadSerializer.h"
+
+static const uint32_t SAMPLE_INTERVAL_MS = 15000;
+
+// What the backend keeps per zone: the last keyframe with every delta since
+// applied on top, soil by pin
+struct BackendState
+{
+    float temperature;
+    float humidity;
+    float light;
+    float airQuality;
+    std::map<int, float> soilPercent;
+};
+
+// Deterministic noise in [-spread, spread]
+static float noise(uint32_t &state, float spread)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state % 2001) / 1000.0f * spread - spread;
+}
+
+// A zone over several hours at the sampling period: slow climate drift with
+// sensor noise, day and night on the LDR, an air quality event, soil drying
+// between waterings, and a fifth plant added halfway through
+static std::vector<ZoneSample> zoneTrace(int count)
+{
+    std::vector<ZoneSample> samples;
+    uint32_t state = 99;
+    float soil[5] = {2500, 2700, 3000, 2200, 1800};
+    for (int i = 0; i < count; i++)
+    {
+        SensorSnapshot snapshot = {};
+        snapshot.takenAtMs = i * SAMPLE_INTERVAL_MS;
+        snapshot.temperature = 23 + 3 * sinf(i / 80.0f) + noise(state, 0.1f);
+        snapshot.humidity = 60 - 5 * sinf(i / 80.0f) + noise(state, 0.4f);
+        snapshot.light = ((i / 100) % 2 == 0 ? 2600 : 250) + noise(state, 20);
+        snapshot.airQuality = (i >= 300 && i < 330 ? 900 : 300) + noise(state, 20);
+        snapshot.soilCount = i < count / 2 ? 4 : 5;
+        for (int p = 0; p < snapshot.soilCount; p++)
+        {
+            soil[p] = i % 200 == 100 + 20 * p ? 1500 : min(soil[p] + 3 + noise(state, 2), 3800.0f);
+            snapshot.soilPins[p] = 32 + p;
+            snapshot.soilMoisture[p] = soil[p] + noise(state, 10);
+        }
+        ZoneSample sample;
+        memset(&sample, 0, sizeof(sample));
+        sample.setReadings(snapshot);
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+// Applies one uploaded sample as the backend does: a keyframe replaces the
+// state, a delta overwrites the readings it carries
+static void apply(BackendState &state, JsonVariant message)
+{
+    bool delta = message["delta"] | false;
+    JsonVariant sensors = message["zoneSensors"];
+    if (!delta)
+    {
+        state.soilPercent.clear();
+    }
+    if (!delta || !sensors["temp"].isNull())
+        state.temperature = sensors["temp"];
+    if (!delta || !sensors["humidity"].isNull())
+        state.humidity = sensors["humidity"];
+    if (!delta || !sensors["light"].isNull())
+        state.light = sensors["light"];
+    if (!delta || !sensors["airQuality"].isNull())
+        state.airQuality = sensors["airQuality"];
+    JsonVariant soil = message["soilMoistureByPin"];
+    for (int i = 0; !soil[i].isNull(); i++)
+    {
+        state.soilPercent[soil[i]["pin"].as<int>()] = soil[i]["soilMoisture"].as<float>();
+    }
+}
+
+// |value - rebuilt| within the deadband the reporter used, plus the two
+// decimals of the JSON encoding
+static bool withinBand(float value, float rebuilt, const DeltaReporter::Deadband &band)
+{
+    float allowed = max(band.absolute, band.relative * fabsf(rebuilt)) + 0.01f;
+    return fabsf(value - rebuilt) <= allowed;
+}
+
+static int mismatches(const ZoneSample &truth, const BackendState &state, const DeltaReporter::Config &config)
+{
+    int count = 0;
+    count += !withinBand(truth.temperature, state.temperature, config.temperature);
+    count += !withinBand(truth.humidity, state.humidity, config.humidity);
+    count += !withinBand(truth.light, state.light, config.light);
+    count += !withinBand(truth.airQuality, state.airQuality, config.airQuality);
+    count += (int)state.soilPercent.size() != truth.soilCount;
+    for (int p = 0; p < truth.soilCount; p++)
+    {
+        auto rebuilt = state.soilPercent.find(truth.soilPins[p]);
+        if (rebuilt == state.soilPercent.end())
+        {
+            count++;
+            continue;
+        }
+        // The soil band is in raw counts, the wire carries percent
+        float percent = PayloadSerializer::toMoisturePercent(truth.soilMoisture[p]);
+        float bandPercent = PayloadSerializer::toMoisturePercent(truth.soilMoisture[p] - config.soil.absolute) - percent;
+        count += fabsf(percent - rebuilt->second) > fabsf(bandPercent) + 0.01f;
+    }
+    return count;
+}
+
+static void backendRebuildsEverySampleFromDeltasAndKeyframes()
+{
+    const DeltaReporter::Config &config = DeltaReporter::DEFAULT_CONFIG;
+    DeltaReporter reporter(config);
+    std::vector<ZoneSample> trace = zoneTrace(480);
+
+    // Filter and upload as the node does, in batches of the buffer's size
+    std::vector<ZoneSample> sent;
+    std::vector<int> lastSentBefore;    // per trace sample, index into sent
+    for (ZoneSample sample : trace)
+    {
+        if (reporter.filter(sample))
+        {
+            sent.push_back(sample);
+        }
+        lastSentBefore.push_back((int)sent.size() - 1);
+    }
+
+    std::vector<BackendState> rebuilt;
+    BackendState state = {};
+    static char payload[8192];
+    for (size_t first = 0; first < sent.size(); first += 10)
+    {
+        int count = min((int)(sent.size() - first), 10);
+        BufferPrint out(payload, sizeof(payload));
+        CHECK_EQUAL(count, PayloadSerializer::sensorBatch(out, "zone1", &sent[first], count, "user1"));
+
+        DynamicJsonDocument doc(8192);
+        CHECK(!deserializeJson(doc, out.c_str()));
+        for (int i = 0; i < count; i++)
+        {
+            apply(state, doc[i]);
+            rebuilt.push_back(state);
+        }
+    }
+    CHECK_EQUAL(sent.size(), rebuilt.size());
+
+    // Every sample, sent or suppressed, is what the backend holds at its time
+    int wrong = 0;
+    for (size_t i = 0; i < trace.size(); i++)
+    {
+        wrong += mismatches(trace[i], rebuilt[lastSentBefore[i]], config);
+    }
+    CHECK_EQUAL(0, wrong);
+
+    // And the deltas saved most of the values
+    const DeltaStats &stats = reporter.getStats();
+    CHECK_EQUAL(trace.size(), stats.samples);
+    CHECK(stats.keyframes >= 480 * SAMPLE_INTERVAL_MS / config.keyframeIntervalMs);
+    CHECK(stats.deltas > 0 && stats.suppressed > 0);
+    CHECK(stats.valuesOut < stats.valuesIn / 2);
+}
+
+static void newPlantForcesAKeyframe()
+{
+    DeltaReporter reporter;
+    std::vector<ZoneSample> trace = zoneTrace(480);
+    for (int i = 0; i < 240; i++)
+    {
+        reporter.filter(trace[i]);
+    }
+    // Sample 240 is the first with five probes
+    ZoneSample sample = trace[240];
+    CHECK(reporter.filter(sample));
+    CHECK(sample.keyframe);
+    CHECK_EQUAL(ZoneSample::ALL_FIELDS, sample.present);
+}
+
+static void forcedKeyframeCarriesEverything()
+{
+    DeltaReporter reporter;
+    std::vector<ZoneSample> trace = zoneTrace(3);
+    ZoneSample first = trace[0];
+    CHECK(reporter.filter(first));
+    CHECK(first.keyframe);
+
+    // The same readings again: nothing to send
+    ZoneSample same = trace[0];
+    same.takenAtMs = SAMPLE_INTERVAL_MS;
+    CHECK(!reporter.filter(same));
+
+    reporter.forceKeyframe();
+    same.takenAtMs = 2 * SAMPLE_INTERVAL_MS;
+    CHECK(reporter.filter(same));
+    CHECK(same.keyframe);
+}
+
+int main()
+{
+    RUN_TEST(backendRebuildsEverySampleFromDeltasAndKeyframes);
+    RUN_TEST(newPlantForcesAKeyframe);
+    RUN_TEST(forcedKeyframeCarriesEverything);
+    return HostTest::finish();
+}
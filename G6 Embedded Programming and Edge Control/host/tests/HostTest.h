@@ -0,0 +1,86 @@
+#ifndef HOSTTEST_H
+#define HOSTTEST_H
+
+#include <Arduino.h>
+#include <DHT.h>
+#include <HTTPClient.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include "HostHal.h"
+
+// Minimal test runner for the host tests: each test is a function, CHECK
+// records a failure and lets the test go on, the exit code is the number
+// of failed checks so ctest sees a failure.
+
+namespace HostTest
+{
+    inline int &failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline const char *&current()
+    {
+        static const char *name = "";
+        return name;
+    }
+
+    // Return value of main()
+    inline int finish()
+    {
+        printf("%s\n", failures() == 0 ? "OK" : "FAILED");
+        return failures();
+    }
+}
+
+#define CHECK(condition)                                                                                       \
+    do                                                                                                         \
+    {                                                                                                          \
+        if (!(condition))                                                                                      \
+        {                                                                                                      \
+            printf("FAIL %s (%s:%d): %s\n", HostTest::current(), __FILE__, __LINE__, #condition);              \
+            HostTest::failures()++;                                                                            \
+        }                                                                                                      \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                                                          \
+    do                                                                                                         \
+    {                                                                                                          \
+        long long expectedValue = (long long)(expected);                                                       \
+        long long actualValue = (long long)(actual);                                                           \
+        if (expectedValue != actualValue)                                                                      \
+        {                                                                                                      \
+            printf("FAIL %s (%s:%d): %s == %s, expected %lld, got %lld\n", HostTest::current(), __FILE__,      \
+                   __LINE__, #expected, #actual, expectedValue, actualValue);                                  \
+            HostTest::failures()++;                                                                            \
+        }                                                                                                      \
+    } while (0)
+
+#define CHECK_TEXT(expected, actual)                                                                           \
+    do                                                                                                         \
+    {                                                                                                          \
+        if (strcmp((expected), (actual)) != 0)                                                                 \
+        {                                                                                                      \
+            printf("FAIL %s (%s:%d): expected \"%s\", got \"%s\"\n", HostTest::current(), __FILE__, __LINE__,  \
+                   (expected), (actual));                                                                      \
+            HostTest::failures()++;                                                                            \
+        }                                                                                                      \
+    } while (0)
+
+// Every test starts on a fresh virtual clock, WiFi down, no server
+// responses, an erased NVS, silent DHTs and quiet Serial
+#define RUN_TEST(test)                                                                                         \
+    do                                                                                                         \
+    {                                                                                                          \
+        HostTest::current() = #test;                                                                           \
+        HostHal::reset();                                                                                      \
+        WiFi.setStatus(WL_DISCONNECTED);                                                                       \
+        HTTPClient::reset();                                                                                   \
+        Preferences::reset();                                                                                  \
+        DHT::clearReadings();                                                                                  \
+        Serial.setQuiet(true);                                                                                 \
+        test();                                                                                                \
+    } while (0)
+
+#endif
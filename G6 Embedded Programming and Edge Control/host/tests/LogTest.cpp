@@ -0,0 +1,88 @@
+#include "HostTest.h"
+#include "Log.h"
+#include "PayloadSerializer.h"
+
+// The ring is static like the RTC copy on the node, so a second
+// Logger::begin() plays the part of the boot after a reset.
+
+static const uint32_t IMAGE = 0x600DF00D;
+
+// Empties whatever an earlier test left in the ring
+static void freshRing()
+{
+    char text[2048];
+    BufferPrint out(text, sizeof(text));
+    HostHal::setImageId(IMAGE);
+    Logger::begin(out);
+    Logger::drain(out, 1000);
+}
+
+static void recordsAreFormattedOnDrain()
+{
+    freshRing();
+    HostHal::advanceMs(1234);
+    LOG_INFO("[PUMP] pulse %u: %lu ms (%.1f%%) %s %d", 3u, 800UL, 41.25, String("zone1"), -7);
+
+    char text[256];
+    BufferPrint out(text, sizeof(text));
+    CHECK_EQUAL(1, Logger::drain(out));
+    CHECK_TEXT("[I 1234] [PUMP] pulse 3: 800 ms (41.2%) zone1 -7\r\n", out.c_str());
+    CHECK_EQUAL(0, Logger::getPending());
+}
+
+static void sameImagePrintsTheOldRecordsAfterAReset()
+{
+    freshRing();
+    LOG_WARN("before the reset %d", 1);
+
+    char text[512];
+    BufferPrint out(text, sizeof(text));
+    Logger::begin(out);
+    CHECK(strstr(out.c_str(), "[W 0] before the reset 1") != nullptr);
+    CHECK(strstr(out.c_str(), "LOGDUMP") == nullptr);
+    CHECK_EQUAL(0, Logger::getPending());
+}
+
+static void anotherImageOnlyGetsTheRawDump()
+{
+    freshRing();
+    LOG_WARN("before the update %d", 2);
+
+    char text[512];
+    BufferPrint out(text, sizeof(text));
+    HostHal::setImageId(0x0BADC0DE);
+    Logger::begin(out);
+    CHECK(strstr(out.c_str(), "left by image 0df00d6000000000") != nullptr);
+    CHECK(strstr(out.c_str(), "LOGDUMP ") != nullptr);
+    CHECK(strstr(out.c_str(), "before the update") == nullptr);
+    CHECK_EQUAL(0, Logger::getPending());
+
+    // The ring now belongs to the new image
+    LOG_WARN("after the update");
+    out.reset();
+    Logger::begin(out);
+    CHECK(strstr(out.c_str(), "after the update") != nullptr);
+    HostHal::setImageId(IMAGE);
+}
+
+static void formatOutsideRodataIsNotRead()
+{
+    freshRing();
+    char format[] = "from the stack %d";
+    LOG_ERROR(format, 5);
+
+    char text[256];
+    BufferPrint out(text, sizeof(text));
+    CHECK_EQUAL(1, Logger::drain(out));
+    CHECK(strstr(out.c_str(), "not in rodata") != nullptr);
+    CHECK(strstr(out.c_str(), "from the stack") == nullptr);
+}
+
+int main()
+{
+    RUN_TEST(recordsAreFormattedOnDrain);
+    RUN_TEST(sameImagePrintsTheOldRecordsAfterAReset);
+    RUN_TEST(anotherImageOnlyGetsTheRawDump);
+    RUN_TEST(formatOutsideRodataIsNotRead);
+    return HostTest::finish();
+}
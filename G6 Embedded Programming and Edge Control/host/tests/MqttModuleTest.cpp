@@ -0,0 +1,84 @@
+#include <Adafruit_MQTT_Client.h>
+#include "HostTest.h"
+#include "MqttModule.h"
+
+static WiFiClient client;
+
+static void nothingIsTriedWhileWiFiIsDown()
+{
+    Adafruit_MQTT_Client mqtt(&client, "broker", 1883, "user", "key");
+    MqttModule module(mqtt);
+
+    for (int i = 0; i < 10; i++)
+    {
+        CHECK(!module.update());
+        HostHal::advanceMs(5000);
+    }
+    CHECK_EQUAL(0, mqtt.getConnectCalls());
+    CHECK_EQUAL(MqttModule::WAITING_FOR_WIFI, module.getState());
+}
+
+static void connectsAsSoonAsWiFiIsUp()
+{
+    Adafruit_MQTT_Client mqtt(&client, "broker", 1883, "user", "key");
+    MqttModule module(mqtt);
+    WiFi.setStatus(WL_CONNECTED);
+
+    CHECK(module.update());
+    CHECK_EQUAL(1, mqtt.getConnectCalls());
+    CHECK_EQUAL(1, module.getStats().connects);
+}
+
+static void failedAttemptsBackOff()
+{
+    Adafruit_MQTT_Client mqtt(&client, "broker", 1883, "user", "key");
+    mqtt.setConnectResult(-1);
+    MqttModule module(mqtt);
+    WiFi.setStatus(WL_CONNECTED);
+
+    // Attempts at 0, ~1 s, ~3 s, ~7 s: polling every 100 ms for 10 s gives 4, not 100
+    for (int i = 0; i < 100; i++)
+    {
+        module.update();
+        HostHal::advanceMs(100);
+    }
+    CHECK(mqtt.getConnectCalls() >= 3);
+    CHECK(mqtt.getConnectCalls() <= 5);
+    CHECK_EQUAL(MqttModule::BACKING_OFF, module.getState());
+
+    mqtt.setConnectResult(0);
+    for (int i = 0; i < 200 && !module.isConnected(); i++)
+    {
+        module.update();
+        HostHal::advanceMs(100);
+    }
+    CHECK(module.isConnected());
+}
+
+static void aLostLinkIsReconnected()
+{
+    Adafruit_MQTT_Client mqtt(&client, "broker", 1883, "user", "key");
+    MqttModule module(mqtt);
+    WiFi.setStatus(WL_CONNECTED);
+    CHECK(module.update());
+
+    mqtt.dropConnection();
+    CHECK(!module.update());
+    CHECK_EQUAL(1, module.getStats().disconnects);
+
+    // The first retry waits 0.75..1.25 s
+    HostHal::advanceMs(700);
+    CHECK(!module.update());
+    HostHal::advanceMs(600);
+    CHECK(module.update());
+    CHECK_EQUAL(2, module.getStats().connects);
+}
+
+int main()
+{
+    RUN_TEST(nothingIsTriedWhileWiFiIsDown);
+    RUN_TEST(connectsAsSoonAsWiFiIsUp);
+    RUN_TEST(failedAttemptsBackOff);
+    RUN_TEST(aLostLinkIsReconnected);
+    return HostTest::finish();
+}
@@ -0,0 +1,187 @@
+#include <FS.h>
+#include "HostTest.h"
+#include "OfflineQueue.h"
+
+static const uint32_t EPOCH = 1709294400;
+
+static ZoneSample makeSample(uint32_t index)
+{
+    ZoneSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.setTimestamp(EPOCH + index);
+    sample.temperature = 20 + index % 10;
+    sample.humidity = 50;
+    sample.light = 800;
+    sample.airQuality = 120;
+    sample.soilCount = 2;
+    sample.soilPins[0] = 32;
+    sample.soilMoisture[0] = 2000 + index;
+    sample.soilPins[1] = 33;
+    sample.soilMoisture[1] = 3000;
+    sample.present = ZoneSample::ALL_FIELDS;
+    sample.keyframe = true;
+    return sample;
+}
+
+static void samplesComeBackInOrder()
+{
+    fs::FS flash;
+    OfflineQueue queue(flash);
+    CHECK(queue.begin());
+    CHECK(queue.isEmpty());
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        CHECK(queue.push("zone1", makeSample(i)));
+    }
+    CHECK_EQUAL(5, queue.size());
+
+    ZoneSample out[8];
+    String zoneId;
+    CHECK_EQUAL(5, queue.peek(out, 8, zoneId));
+    CHECK_TEXT("zone1", zoneId.c_str());
+    CHECK_EQUAL(EPOCH + 3, out[3].epoch);
+    CHECK_EQUAL(2003, (int)out[3].soilMoisture[0]);
+    CHECK_EQUAL(23, (int)out[3].temperature);
+
+    queue.pop(2);
+    CHECK_EQUAL(3, queue.size());
+    CHECK_EQUAL(3, queue.peek(out, 8, zoneId));
+    CHECK_EQUAL(EPOCH + 2, out[0].epoch);
+}
+
+static void peekStopsAtAZoneChange()
+{
+    fs::FS flash;
+    OfflineQueue queue(flash);
+    queue.begin();
+    queue.push("zone1", makeSample(0));
+    queue.push("zone1", makeSample(1));
+    queue.push("zone2", makeSample(2));
+
+    ZoneSample out[8];
+    String zoneId;
+    CHECK_EQUAL(2, queue.peek(out, 8, zoneId));
+    CHECK_TEXT("zone1", zoneId.c_str());
+    queue.pop(2);
+    CHECK_EQUAL(1, queue.peek(out, 8, zoneId));
+    CHECK_TEXT("zone2", zoneId.c_str());
+}
+
+static void stateSurvivesARestart()
+{
+    fs::FS flash;
+    {
+        OfflineQueue queue(flash);
+        queue.begin();
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            queue.push("zone1", makeSample(i));
+        }
+        queue.pop(80);
+    }
+
+    OfflineQueue restarted(flash);
+    CHECK(restarted.begin());
+    CHECK_EQUAL(20, restarted.size());
+    ZoneSample out[4];
+    String zoneId;
+    CHECK_EQUAL(4, restarted.peek(out, 4, zoneId));
+    CHECK_EQUAL(EPOCH + 80, out[0].epoch);
+}
+
+static void drainedSegmentsAreDeleted()
+{
+    fs::FS flash;
+    OfflineQueue queue(flash);
+    queue.begin();
+    uint32_t total = OfflineQueue::RECORDS_PER_SEGMENT * 3;
+    for (uint32_t i = 0; i < total; i++)
+    {
+        queue.push("zone1", makeSample(i));
+    }
+    size_t full = flash.usedBytes();
+
+    queue.pop(OfflineQueue::RECORDS_PER_SEGMENT * 2);
+    CHECK_EQUAL(OfflineQueue::RECORDS_PER_SEGMENT, queue.size());
+    CHECK(flash.usedBytes() < full / 2);
+
+    queue.pop(OfflineQueue::RECORDS_PER_SEGMENT);
+    CHECK(queue.isEmpty());
+    CHECK(flash.usedBytes() < sizeof(QueuedSample));
+}
+
+static void oldestSegmentIsEvictedOverTheCap()
+{
+    fs::FS flash;
+    uint32_t cap = OfflineQueue::RECORDS_PER_SEGMENT * 2;
+    OfflineQueue queue(flash, "/queue", cap);
+    queue.begin();
+    for (uint32_t i = 0; i < cap + 5; i++)
+    {
+        CHECK(queue.push("zone1", makeSample(i)));
+    }
+    CHECK_EQUAL(OfflineQueue::RECORDS_PER_SEGMENT, queue.getEvicted());
+    CHECK_EQUAL(cap + 5 - OfflineQueue::RECORDS_PER_SEGMENT, queue.size());
+
+    ZoneSample out[1];
+    String zoneId;
+    CHECK_EQUAL(1, queue.peek(out, 1, zoneId));
+    CHECK_EQUAL(EPOCH + OfflineQueue::RECORDS_PER_SEGMENT, out[0].epoch);
+}
+
+static void damagedRecordsAreSkipped()
+{
+    fs::FS flash;
+    {
+        OfflineQueue queue(flash);
+        queue.begin();
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            queue.push("zone1", makeSample(i));
+        }
+    }
+
+    // Flip a byte inside the first record
+    File segment = flash.open("/queue/0.seg", "r+");
+    CHECK((bool)segment);
+    segment.seek(12);
+    segment.write((uint8_t)0x5A);
+    segment.close();
+
+    OfflineQueue queue(flash);
+    queue.begin();
+    ZoneSample out[4];
+    String zoneId;
+    CHECK_EQUAL(2, queue.peek(out, 4, zoneId));
+    CHECK_EQUAL(EPOCH + 1, out[0].epoch);
+    CHECK_EQUAL(1, queue.getCorrupt());
+}
+
+static void zoneIdsThatDoNotFitAreRejected()
+{
+    fs::FS flash;
+    OfflineQueue queue(flash);
+    queue.begin();
+    CHECK(!queue.push("greenhouse", makeSample(0)));
+    CHECK(queue.isEmpty());
+
+    // The longest id that fits comes back whole
+    CHECK(queue.push("zone-12", makeSample(1)));
+    ZoneSample out[1];
+    String zoneId;
+    CHECK_EQUAL(1, queue.peek(out, 1, zoneId));
+    CHECK_TEXT("zone-12", zoneId.c_str());
+}
+
+int main()
+{
+    RUN_TEST(samplesComeBackInOrder);
+    RUN_TEST(peekStopsAtAZoneChange);
+    RUN_TEST(stateSurvivesARestart);
+    RUN_TEST(drainedSegmentsAreDeleted);
+    RUN_TEST(oldestSegmentIsEvictedOverTheCap);
+    RUN_TEST(damagedRecordsAreSkipped);
+    RUN_TEST(zoneIdsThatDoNotFitAreRejected);
+    return HostTest::finish();
+}
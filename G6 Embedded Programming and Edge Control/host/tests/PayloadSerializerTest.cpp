@@ -0,0 +1,180 @@
+#include "HostTest.h"
+#include "PayloadSerializer.h"
+
+// 2024-03-01 12:00:00 UTC
+static const uint32_t EPOCH = 1709294400;
+
+static ZoneSample makeSample(float temperature, uint32_t epoch)
+{
+    ZoneSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.temperature = temperature;
+    sample.humidity = 55.5f;
+    sample.light = 812;
+    sample.airQuality = 140;
+    sample.soilCount = 2;
+    sample.soilPins[0] = 32;
+    sample.soilMoisture[0] = 2550;      // 50 %
+    sample.soilPins[1] = 33;
+    sample.soilMoisture[1] = 1200;      // 100 %
+    sample.present = ZoneSample::ALL_FIELDS;
+    sample.keyframe = true;
+    if (epoch != 0)
+    {
+        sample.setTimestamp(epoch);
+    }
+    return sample;
+}
+
+static void jsonBatchMatchesTheBackendShape()
+{
+    char buffer[512];
+    BufferPrint out(buffer, sizeof(buffer));
+    ZoneSample samples[2] = {makeSample(24.5f, EPOCH), makeSample(25.0f, 0)};
+
+    CHECK_EQUAL(2, PayloadSerializer::sensorBatch(out, "zone1", samples, 2, "user7"));
+    CHECK_TEXT("[{\"zoneId\":\"zone1\",\"zoneSensors\":{\"humidity\":55.50,\"temp\":24.50,\"light\":812.00,"
+               "\"airQuality\":140.00},\"soilMoistureByPin\":[{\"pin\":32,\"soilMoisture\":50.00},"
+               "{\"pin\":33,\"soilMoisture\":100.00}],\"userId\":\"user7\",\"timestamp\":\"2024-03-01T20:00:00Z\"},"
+               "{\"zoneId\":\"zone1\",\"zoneSensors\":{\"humidity\":55.50,\"temp\":25.00,\"light\":812.00,"
+               "\"airQuality\":140.00},\"soilMoistureByPin\":[{\"pin\":32,\"soilMoisture\":50.00},"
+               "{\"pin\":33,\"soilMoisture\":100.00}],\"userId\":\"user7\"}]",
+               out.c_str());
+    CHECK(!out.overflowed());
+}
+
+static void deltaSampleCarriesOnlyChangedReadings()
+{
+    char buffer[256];
+    BufferPrint out(buffer, sizeof(buffer));
+    ZoneSample sample = makeSample(24.5f, 0);
+    sample.keyframe = false;
+    sample.present = ZoneSample::HAS_TEMPERATURE | (1 << (ZoneSample::SOIL_SHIFT + 1));
+
+    CHECK_EQUAL(1, PayloadSerializer::sensorBatch(out, "z", &sample, 1, ""));
+    CHECK_TEXT("[{\"zoneId\":\"z\",\"zoneSensors\":{\"temp\":24.50},\"soilMoistureByPin\":"
+               "[{\"pin\":33,\"soilMoisture\":100.00}],\"delta\":true}]",
+               out.c_str());
+}
+
+static void jsonBatchKeepsOnlyWholeSamples()
+{
+    char buffer[300];
+    BufferPrint out(buffer, sizeof(buffer));
+    ZoneSample samples[3] = {makeSample(20, EPOCH), makeSample(21, EPOCH), makeSample(22, EPOCH)};
+
+    // One sample is ~250 bytes: the second does not fit and is cut off cleanly
+    CHECK_EQUAL(1, PayloadSerializer::sensorBatch(out, "zone1", samples, 3, "user7"));
+    CHECK(!out.overflowed());
+    CHECK_EQUAL(']', out.c_str()[out.length() - 1]);
+    CHECK(strstr(out.c_str(), "\"temp\":21") == nullptr);
+}
+
+static void jsonStringsAreEscaped()
+{
+    char buffer[128];
+    BufferPrint out(buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject().field("name", "a\"b\\c\n").field("n", 7).field("ok", true).field("x", NAN).endObject();
+    CHECK_TEXT("{\"name\":\"a\\\"b\\\\c\\u000a\",\"n\":7,\"ok\":true,\"x\":null}", out.c_str());
+}
+
+static void cborBatchEncodesIntegerKeys()
+{
+    char buffer[128];
+    BufferPrint out(buffer, sizeof(buffer));
+    ZoneSample sample = makeSample(24.5f, EPOCH);
+    sample.soilCount = 1;
+
+    CHECK_EQUAL(1, PayloadSerializer::sensorBatch(out, "z1", &sample, 1, "", FORMAT_CBOR));
+    const uint8_t expected[] = {
+        0xBF,                                                   // message map
+        0x00, 0x01,                                             // schema: 1
+        0x01, 0x62, 'z', '1',                                   // zone: "z1"
+        0x03, 0x9F,                                             // samples: [
+        0xBF,                                                   // sample map
+        0x04, 0x1B, 0x00, 0x00, 0x01, 0x8D, 0xF9, 0xE2, 0xB2, 0x00,   // timestamp: EPOCH * 1000
+        0x0A, 0xFA, 0x41, 0xC4, 0x00, 0x00,                     // temperature: 24.5
+        0x0B, 0xFA, 0x42, 0x5E, 0x00, 0x00,                     // humidity: 55.5
+        0x0C, 0xFA, 0x44, 0x4B, 0x00, 0x00,                     // light: 812
+        0x0D, 0xFA, 0x43, 0x0C, 0x00, 0x00,                     // air quality: 140
+        0x0E, 0x9F,                                             // soil: [
+        0x9F, 0x18, 0x20, 0xFA, 0x42, 0x48, 0x00, 0x00, 0xFF,   // [32, 50.0]
+        0xFF,                                                   // ]
+        0xFF,                                                   // end of sample
+        0xFF,                                                   // ]
+        0xFF                                                    // end of message
+    };
+    CHECK_EQUAL(sizeof(expected), out.length());
+    CHECK(memcmp(expected, out.data(), min(sizeof(expected), out.length())) == 0);
+}
+
+static void cborIsSmallerThanJson()
+{
+    char jsonBuffer[2048];
+    char cborBuffer[2048];
+    BufferPrint json(jsonBuffer, sizeof(jsonBuffer));
+    BufferPrint cbor(cborBuffer, sizeof(cborBuffer));
+    ZoneSample samples[4] = {makeSample(20, EPOCH), makeSample(21, EPOCH + 60), makeSample(22, EPOCH + 120),
+                             makeSample(23, EPOCH + 180)};
+
+    CHECK_EQUAL(4, PayloadSerializer::sensorBatch(json, "zone1", samples, 4, "user7", FORMAT_JSON));
+    CHECK_EQUAL(4, PayloadSerializer::sensorBatch(cbor, "zone1", samples, 4, "user7", FORMAT_CBOR));
+    CHECK(cbor.length() * 3 < json.length());
+}
+
+static void feedbackBatchListsEveryTransition()
+{
+    char buffer[256];
+    BufferPrint out(buffer, sizeof(buffer));
+    ActuatorTransition transitions[2] = {{"pump ON", true}, {"fan OFF", false}};
+
+    PayloadSerializer::actuatorFeedbackBatch(out, "zone1", EPOCH, transitions, 2);
+    CHECK_TEXT("{\"zone\":\"zone1\",\"ts\":1709294400,\"tr\":[[\"pump ON\",1],[\"fan OFF\",0]]}", out.c_str());
+
+    // No time before the first sync
+    out.reset();
+    PayloadSerializer::actuatorFeedbackBatch(out, "zone1", 0, transitions, 1);
+    CHECK_TEXT("{\"zone\":\"zone1\",\"tr\":[[\"pump ON\",1]]}", out.c_str());
+}
+
+static void bufferPrintNeverWritesPastCapacity()
+{
+    char buffer[8];
+    memset(buffer, 'x', sizeof(buffer));
+    BufferPrint out(buffer, 6);
+    out.print("abcdefgh");
+    CHECK(out.overflowed());
+    CHECK_EQUAL(5, out.length());
+    CHECK_TEXT("abcde", out.c_str());
+    CHECK_EQUAL('x', buffer[6]);
+
+    out.truncate(2);
+    CHECK(!out.overflowed());
+    CHECK_TEXT("ab", out.c_str());
+}
+
+static void timestampsAreUtcPlusEight()
+{
+    char text[ClockService::TIMESTAMP_SIZE];
+    PayloadSerializer::formatTimestamp(EPOCH, text, sizeof(text));
+    CHECK_TEXT("2024-03-01T20:00:00Z", text);
+
+    ZoneSample sample = makeSample(0, 0);
+    sample.setTimestamp(1000);
+    CHECK_TEXT("", sample.timestamp);
+}
+
+int main()
+{
+    RUN_TEST(jsonBatchMatchesTheBackendShape);
+    RUN_TEST(deltaSampleCarriesOnlyChangedReadings);
+    RUN_TEST(jsonBatchKeepsOnlyWholeSamples);
+    RUN_TEST(jsonStringsAreEscaped);
+    RUN_TEST(cborBatchEncodesIntegerKeys);
+    RUN_TEST(cborIsSmallerThanJson);
+    RUN_TEST(feedbackBatchListsEveryTransition);
+    RUN_TEST(bufferPrintNeverWritesPastCapacity);
+    RUN_TEST(timestampsAreUtcPlusEight);
+    return HostTest::finish();
+}
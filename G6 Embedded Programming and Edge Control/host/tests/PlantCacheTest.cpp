@@ -0,0 +1,95 @@
+#include "HostTest.h"
+#include "PlantCache.h"
+
+static PlantData makePlant(const char *id, int pin, float minMoisture)
+{
+    PlantData plant;
+    plant.plantId = id;
+    plant.moisturePin = pin;
+    plant.min_moisture = minMoisture;
+    plant.max_moisture = minMoisture + 30;
+    plant.min_temperature = 18;
+    plant.max_temperature = 28;
+    plant.min_light = 300;
+    plant.max_light = 900;
+    plant.min_airQuality = 0;
+    plant.max_airQuality = 400;
+    return plant;
+}
+
+static void plantsSurviveARestart()
+{
+    std::vector<PlantData> plants = {makePlant("basil", 32, 35), makePlant("mint", 34, 40)};
+    {
+        PlantCache cache;
+        CHECK(cache.save(plants, "\"v1\""));
+    }
+
+    // A new instance reads NVS like the next boot does
+    PlantCache cache;
+    std::vector<PlantData> loaded;
+    CHECK(cache.load(loaded));
+    CHECK_EQUAL(2, loaded.size());
+    CHECK_TEXT("mint", loaded[1].plantId.c_str());
+    CHECK_EQUAL(34, loaded[1].moisturePin);
+    CHECK(loaded[1].min_moisture == 40);
+    CHECK(loaded[1].max_airQuality == 400);
+    CHECK_TEXT("\"v1\"", cache.getETag().c_str());
+}
+
+static void nothingStoredLoadsNothing()
+{
+    PlantCache cache;
+    std::vector<PlantData> loaded;
+    CHECK(!cache.load(loaded));
+    CHECK(loaded.empty());
+    CHECK_TEXT("", cache.getETag().c_str());
+}
+
+static void identicalSetIsNotRewritten()
+{
+    std::vector<PlantData> plants = {makePlant("basil", 32, 35)};
+    PlantCache cache;
+    CHECK(cache.save(plants, "\"v1\""));
+    uint32_t writes = Preferences::getWrites();
+
+    CHECK(cache.save(plants, "\"v1\""));
+    CHECK_EQUAL(writes, Preferences::getWrites());
+
+    // A new ETag alone only rewrites the ETag
+    CHECK(cache.save(plants, "\"v2\""));
+    CHECK_EQUAL(writes + 1, Preferences::getWrites());
+}
+
+static void oversizedSetsAreRefused()
+{
+    PlantCache cache;
+    std::vector<PlantData> longId = {makePlant("a-plant-id-far-longer-than-32-bytes", 32, 35)};
+    CHECK(!cache.save(longId, ""));
+
+    std::vector<PlantData> tooMany(PlantCache::MAX_CACHED_PLANTS + 1, makePlant("basil", 32, 35));
+    CHECK(!cache.save(tooMany, ""));
+    CHECK_EQUAL(0, Preferences::getWrites());
+}
+
+static void clearForgetsPlantsAndETag()
+{
+    PlantCache cache;
+    std::vector<PlantData> plants = {makePlant("basil", 32, 35)};
+    cache.save(plants, "\"v1\"");
+    cache.clear();
+
+    std::vector<PlantData> loaded;
+    CHECK(!cache.load(loaded));
+    CHECK_TEXT("", cache.getETag().c_str());
+}
+
+int main()
+{
+    RUN_TEST(plantsSurviveARestart);
+    RUN_TEST(nothingStoredLoadsNothing);
+    RUN_TEST(identicalSetIsNotRewritten);
+    RUN_TEST(oversizedSetsAreRefused);
+    RUN_TEST(clearForgetsPlantsAndETag);
+    return HostTest::finish();
+}
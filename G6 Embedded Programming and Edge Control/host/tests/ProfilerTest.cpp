@@ -0,0 +1,49 @@
+#include "HostTest.h"
+#include "PayloadSerializer.h"
+#include "Profiler.h"
+
+static void resetEmptiesTheWindowWithoutTouchingTheHistogram()
+{
+    Profiler::reset();
+    Profiler::record(PHASE_RULES, 100);
+    Profiler::record(PHASE_RULES, 300);
+    Profiler::record(PHASE_MQTT_POLL, 50);
+    CHECK_EQUAL(2, Profiler::histogram(PHASE_RULES).getCount());
+    CHECK_EQUAL(300, Profiler::histogram(PHASE_RULES).getMax());
+
+    // The metrics task starts a new window; the control task has not recorded yet
+    Profiler::reset();
+    CHECK_EQUAL(0, Profiler::histogram(PHASE_RULES).getCount());
+    CHECK_EQUAL(0, Profiler::histogram(PHASE_MQTT_POLL).getCount());
+
+    char text[128];
+    BufferPrint out(text, sizeof(text));
+    CHECK_EQUAL(PHASE_COUNT, Profiler::writeSummary(out, 0));
+    CHECK_TEXT("{}", out.c_str());
+
+    // The writer's next record clears the old window first
+    Profiler::record(PHASE_RULES, 20);
+    CHECK_EQUAL(1, Profiler::histogram(PHASE_RULES).getCount());
+    CHECK_EQUAL(20, Profiler::histogram(PHASE_RULES).getMax());
+    CHECK_EQUAL(0, Profiler::histogram(PHASE_MQTT_POLL).getCount());
+}
+
+static void summaryCoversTheCurrentWindowOnly()
+{
+    Profiler::reset();
+    Profiler::record(PHASE_ADC, 40);
+    Profiler::reset();
+    Profiler::record(PHASE_SENSORS, 1000);
+
+    char text[128];
+    BufferPrint out(text, sizeof(text));
+    Profiler::writeSummary(out, 0);
+    CHECK_TEXT("{\"sensors\":[1,1000,1000,1000]}", out.c_str());
+}
+
+int main()
+{
+    RUN_TEST(resetEmptiesTheWindowWithoutTouchingTheHistogram);
+    RUN_TEST(summaryCoversTheCurrentWindowOnly);
+    return HostTest::finish();
+}
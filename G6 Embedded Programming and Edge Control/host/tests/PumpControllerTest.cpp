@@ -0,0 +1,193 @@
+#include <vector>
+#include "HostTest.h"
+#include "PumpController.h"
+
+// main.ino's settings
+static const PumpController::Config NODE_CONFIG = {1000, 8000, 20000, 6, 2.0f, 0.3f, 25};
+static const uint32_t PUMP_CONTROL_INTERVAL_MS = 250;
+
+// A tray whose moisture rises by responsePerSecond % for every second the
+// pump runs, driven by the controller as the pump task drives it
+struct SimulatedZone
+{
+    struct Pulse
+    {
+        uint32_t onAt;
+        uint32_t offAt;
+    };
+
+    float moisture;
+    float responsePerSecond;
+    bool pumpOn;
+    std::vector<Pulse> pulses;
+    PumpController pump;
+
+    SimulatedZone(float moisture, float responsePerSecond)
+        : moisture(moisture),
+          responsePerSecond(responsePerSecond),
+          pumpOn(false),
+          pump([this](bool on) { switchPump(on); })
+    {
+        pump.configure(NODE_CONFIG);
+    }
+
+    void switchPump(bool on)
+    {
+        if (on && !pumpOn)
+        {
+            pulses.push_back({(uint32_t)Hal::millis(), 0});
+        }
+        else if (!on && pumpOn)
+        {
+            pulses.back().offAt = Hal::millis();
+        }
+        pumpOn = on;
+    }
+
+    // Runs the cycle to its end; false if it was still going after limitMs
+    bool water(float target, uint32_t limitMs = 600000)
+    {
+        pulses.clear();
+        if (!pump.start(moisture, target))
+        {
+            return false;
+        }
+        for (uint32_t elapsed = 0; elapsed < limitMs; elapsed += PUMP_CONTROL_INTERVAL_MS)
+        {
+            HostHal::advanceMs(PUMP_CONTROL_INTERVAL_MS);
+            if (pumpOn)
+            {
+                moisture += responsePerSecond * PUMP_CONTROL_INTERVAL_MS / 1000.0f;
+            }
+            pump.update(moisture);
+            if (pump.takeFinished())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+static void pulsesAlternateWithSoaks()
+{
+    SimulatedZone zone(40, 0.5f);
+    CHECK(zone.water(60));
+    CHECK(!zone.pumpOn);
+    CHECK(zone.pulses.size() >= 2);
+
+    for (size_t i = 0; i < zone.pulses.size(); i++)
+    {
+        uint32_t length = zone.pulses[i].offAt - zone.pulses[i].onAt;
+        CHECK(length >= NODE_CONFIG.minPulseMs);
+        // Switched off on the first pump tick past the pulse
+        CHECK(length <= NODE_CONFIG.maxPulseMs + PUMP_CONTROL_INTERVAL_MS);
+        if (i > 0)
+        {
+            CHECK(zone.pulses[i].onAt - zone.pulses[i - 1].offAt >= NODE_CONFIG.soakMs);
+        }
+    }
+    CHECK_EQUAL(zone.pulses.size(), zone.pump.lastCycle().pulses);
+    CHECK(zone.pump.lastCycle().endMoisture == zone.moisture);
+    // Still on the initial gain, four times the zone's: the capped pulses and
+    // the shrinking top-ups run out of pulses just short of the target
+    CHECK(!zone.pump.lastCycle().reachedTarget);
+    CHECK(zone.moisture > 58 && zone.moisture < 60);
+}
+
+static void learnedGainConvergesOnTheZoneResponse()
+{
+    SimulatedZone zone(40, 0.5f);
+    for (int cycle = 0; cycle < 4; cycle++)
+    {
+        zone.moisture = 40;
+        CHECK(zone.water(60));
+    }
+    CHECK(fabs(zone.pump.getGain() - 0.5f) < 0.05f);
+
+    // Once learned, a pulse closes its deficit: one pulse (plus at most a
+    // minimum-length top-up) and no more than that top-up past the target
+    zone.moisture = 57;
+    CHECK(zone.water(60));
+    CHECK(zone.pulses.size() <= 2);
+    CHECK(zone.pump.lastCycle().reachedTarget);
+    CHECK(zone.moisture - 60 <= 0.5f * NODE_CONFIG.minPulseMs / 1000.0f);
+}
+
+static void fastZoneStopsOvershootingOnceLearned()
+{
+    // Six times wetter per second than the initial guess of 2 %/s
+    SimulatedZone zone(40, 12.0f);
+    CHECK(zone.water(60));
+    float firstOvershoot = zone.moisture - 60;
+    CHECK(firstOvershoot > 10);
+
+    for (int cycle = 0; cycle < 8; cycle++)
+    {
+        zone.moisture = 40;
+        CHECK(zone.water(60));
+    }
+    CHECK(fabs(zone.pump.getGain() - 12.0f) < 1.0f);
+
+    // At the learned rate the pulse lands on the target, at most one pump
+    // tick of water past it
+    zone.moisture = 40;
+    CHECK(zone.water(60));
+    CHECK(zone.pump.lastCycle().reachedTarget);
+    CHECK(zone.moisture - 60 <= 12.0f * PUMP_CONTROL_INTERVAL_MS / 1000.0f + 0.01f);
+    CHECK(zone.moisture - 60 < firstOvershoot / 4);
+}
+
+static void dryProbeIsCappedByPulseLengthAndCount()
+{
+    // The probe never sees the water: a blocked line, or the wrong pin
+    SimulatedZone zone(20, 0);
+    CHECK(zone.water(60));
+    const PumpController::CycleReport &report = zone.pump.lastCycle();
+    CHECK(!report.reachedTarget);
+    CHECK_EQUAL(NODE_CONFIG.maxPulses, report.pulses);
+    CHECK_EQUAL(NODE_CONFIG.maxPulses, zone.pulses.size());
+    for (const SimulatedZone::Pulse &pulse : zone.pulses)
+    {
+        CHECK(pulse.offAt - pulse.onAt <= NODE_CONFIG.maxPulseMs + PUMP_CONTROL_INTERVAL_MS);
+    }
+    CHECK(report.pumpOnMs <= NODE_CONFIG.maxPulses * (NODE_CONFIG.maxPulseMs + PUMP_CONTROL_INTERVAL_MS));
+    CHECK(report.waterMl > 0);
+    // Each unanswered pulse lowers the expected response
+    CHECK(zone.pump.getGain() < NODE_CONFIG.initialGain);
+}
+
+static void stopEndsThePulseWithThePumpOff()
+{
+    SimulatedZone zone(40, 0.5f);
+    CHECK(zone.pump.start(40, 60));
+    CHECK(zone.pumpOn);
+    HostHal::advanceMs(3000);
+    zone.pump.stop();
+    CHECK(!zone.pumpOn);
+    CHECK(!zone.pump.isActive());
+    CHECK(zone.pump.takeFinished());
+    CHECK_EQUAL(3000, zone.pump.lastCycle().pumpOnMs);
+    CHECK(!zone.pump.lastCycle().reachedTarget);
+}
+
+static void startIsRefusedWhenItHasNothingToDo()
+{
+    SimulatedZone zone(60, 0.5f);
+    CHECK(!zone.pump.start(60, 60));
+    CHECK(!zone.pump.start(NAN, 60));
+    CHECK(zone.pump.start(40, 60));
+    CHECK(!zone.pump.start(40, 60));
+    CHECK_EQUAL(1, zone.pulses.size());
+}
+
+int main()
+{
+    RUN_TEST(pulsesAlternateWithSoaks);
+    RUN_TEST(learnedGainConvergesOnTheZoneResponse);
+    RUN_TEST(fastZoneStopsOvershootingOnceLearned);
+    RUN_TEST(dryProbeIsCappedByPulseLengthAndCount);
+    RUN_TEST(stopEndsThePulseWithThePumpOff);
+    RUN_TEST(startIsRefusedWhenItHasNothingToDo);
+    return HostTest::finish();
+}
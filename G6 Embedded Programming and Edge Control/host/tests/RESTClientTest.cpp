@@ -0,0 +1,176 @@
+#include "HostTest.h"
+#include "RESTClient.h"
+
+static const char *SERVER = "https://backend.example";
+
+// A plant as the backend lists it, with the fields the node does not keep
+static std::string plantJson(int index)
+{
+    char text[512];
+    snprintf(text, sizeof(text),
+             "{\"plantId\":\"plant-%03d\",\"name\":\"Genovese basil, tray %d\",\"moisturePin\":%d,"
+             "\"notes\":\"sown 2024-02-12, transplanted 2024-03-01, pinch weekly\","
+             "\"thresholds\":{\"moisture\":{\"min\":%d,\"max\":70},\"temperature\":{\"min\":18,\"max\":28},"
+             "\"light\":{\"min\":300,\"max\":900},\"airQuality\":{\"min\":0,\"max\":400}},"
+             "\"history\":[1,2,3,4,5,6,7,8]}",
+             index, index, 32 + index % 8, 30 + index % 10);
+    return text;
+}
+
+static std::string plantList(int count)
+{
+    std::string body = "{\"zoneId\":\"zone1\",\"plants\":[";
+    for (int i = 0; i < count; i++)
+    {
+        body += (i > 0 ? "," : "") + plantJson(i);
+    }
+    return body + "],\"updatedAt\":\"2024-03-01T20:00:00Z\"}";
+}
+
+static void responseLargerThanThePayloadBufferIsParsed()
+{
+    WiFi.setStatus(WL_CONNECTED);
+    std::string body = plantList(60);
+    CHECK(body.size() > 2 * RESTClient::PAYLOAD_CAPACITY);
+    HTTPClient::respond(200, body, {{"ETag", "\"v7\""}}, 1024);
+
+    RESTClient rest(SERVER);
+    std::vector<PlantData> plants;
+    String etag;
+    CHECK_EQUAL(PLANTS_UPDATED, rest.fetchPlantsIfChanged("zone1", "", plants, etag));
+    CHECK_EQUAL(60, plants.size());
+    CHECK_TEXT("plant-059", plants[59].plantId.c_str());
+    CHECK_EQUAL(32 + 59 % 8, plants[59].moisturePin);
+    CHECK(plants[59].min_moisture == 30 + 59 % 10);
+    CHECK(plants[59].max_airQuality == 400);
+    CHECK_TEXT("\"v7\"", etag.c_str());
+}
+
+static void chunkBoundariesMayFallAnywhere()
+{
+    WiFi.setStatus(WL_CONNECTED);
+    RESTClient rest(SERVER);
+    // Chunks of 1..7 bytes split keys, numbers and the framing itself
+    for (size_t chunk = 1; chunk <= 7; chunk++)
+    {
+        HTTPClient::respond(200, plantList(3), {}, chunk);
+        std::vector<PlantData> plants = rest.getPlantsByZone("zone1");
+        CHECK_EQUAL(3, plants.size());
+        CHECK_TEXT("plant-002", plants.size() == 3 ? plants[2].plantId.c_str() : "");
+    }
+}
+
+static void connectionIsReusedAfterTheList()
+{
+    WiFi.setStatus(WL_CONNECTED);
+    RESTClient rest(SERVER);
+    HTTPClient::respond(200, plantList(5), {}, 64);
+    HTTPClient::respond(200, plantList(2));
+    HTTPClient::respond(304);
+
+    CHECK_EQUAL(5, rest.getPlantsByZone("zone1").size());
+    CHECK_EQUAL(2, rest.getPlantsByZone("zone1").size());
+
+    std::vector<PlantData> plants(1);
+    String etag;
+    CHECK_EQUAL(PLANTS_NOT_MODIFIED, rest.fetchPlantsIfChanged("zone1", "\"v7\"", plants, etag));
+    CHECK_EQUAL(1, plants.size());
+
+    const ConnectionStats &stats = rest.getConnectionStats();
+    CHECK_EQUAL(3, stats.requests);
+    CHECK_EQUAL(1, stats.handshakes);
+    CHECK_EQUAL(2, stats.reusedRequests);
+    CHECK_EQUAL(3, HTTPClient::requests().size());
+    CHECK_TEXT("https://backend.example/api/v1/zones/zone1/plants", HTTPClient::requests()[0].url.c_str());
+}
+
+static void emptyListIsAnUpdate()
+{
+    WiFi.setStatus(WL_CONNECTED);
+    RESTClient rest(SERVER);
+    HTTPClient::respond(200, "{\"plants\":[]}", {}, 4);
+
+    std::vector<PlantData> plants(2);
+    String etag;
+    CHECK_EQUAL(PLANTS_UPDATED, rest.fetchPlantsIfChanged("zone1", "", plants, etag));
+    CHECK(plants.empty());
+}
+
+static void truncatedListKeepsTheCurrentSet()
+{
+    WiFi.setStatus(WL_CONNECTED);
+    RESTClient rest(SERVER);
+    std::string body = plantList(4);
+    HTTPClient::respond(200, body.substr(0, body.size() / 2));
+
+    std::vector<PlantData> plants(1);
+    String etag;
+    CHECK_EQUAL(PLANTS_FETCH_FAILED, rest.fetchPlantsIfChanged("zone1", "", plants, etag));
+    CHECK_EQUAL(1, plants.size());
+
+    HTTPClient::respond(500, "{}");
+    CHECK_EQUAL(PLANTS_FETCH_FAILED, rest.fetchPlantsIfChanged("zone1", "", plants, etag));
+    HTTPClient::respond(200, "{\"error\":\"no zone\"}");
+    CHECK_EQUAL(PLANTS_FETCH_FAILED, rest.fetchPlantsIfChanged("zone1", "", plants, etag));
+    CHECK_EQUAL(1, plants.size());
+}
+
+static ZoneSample makeSample(uint32_t epoch)
+{
+    ZoneSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.setTimestamp(epoch);
+    sample.temperature = 22;
+    sample.present = ZoneSample::ALL_FIELDS;
+    sample.keyframe = true;
+    return sample;
+}
+
+static void missingBatchEndpointFallsBackToSingleSamples()
+{
+    WiFi.setStatus(WL_CONNECTED);
+    RESTClient rest(SERVER);
+    rest.setBatchUploads(true);
+    ZoneSample samples[3] = {makeSample(1709294400), makeSample(1709294415), makeSample(1709294430)};
+
+    HTTPClient::respond(404, "{\"error\":\"not found\"}");
+    for (int i = 0; i < 3; i++)
+    {
+        HTTPClient::respond(201);
+    }
+    BatchResult result = rest.sendZoneSensorBatch("zone1", samples, 3, "user1");
+    CHECK_EQUAL(3, result.sent);
+    CHECK_EQUAL(0, result.rejected);
+    CHECK(!rest.usesBatchUploads());
+
+    const std::vector<HTTPClient::Request> &requests = HTTPClient::requests();
+    CHECK_EQUAL(4, requests.size());
+    CHECK_TEXT("https://backend.example/api/v1/sensor-data/batch", requests[0].url.c_str());
+    CHECK_TEXT("https://backend.example/api/v1/sensor-data", requests[3].url.c_str());
+}
+
+static void otherBatchErrorsKeepBatching()
+{
+    WiFi.setStatus(WL_CONNECTED);
+    RESTClient rest(SERVER);
+    rest.setBatchUploads(true);
+    ZoneSample samples[2] = {makeSample(1709294400), makeSample(1709294415)};
+
+    HTTPClient::respond(503);
+    BatchResult result = rest.sendZoneSensorBatch("zone1", samples, 2, "user1");
+    CHECK_EQUAL(0, result.sent + result.rejected);
+    CHECK(rest.usesBatchUploads());
+    CHECK_EQUAL(1, HTTPClient::requests().size());
+}
+
+int main()
+{
+    RUN_TEST(responseLargerThanThePayloadBufferIsParsed);
+    RUN_TEST(chunkBoundariesMayFallAnywhere);
+    RUN_TEST(connectionIsReusedAfterTheList);
+    RUN_TEST(emptyListIsAnUpdate);
+    RUN_TEST(truncatedListKeepsTheCurrentSet);
+    RUN_TEST(missingBatchEndpointFallsBackToSingleSamples);
+    RUN_TEST(otherBatchErrorsKeepBatching);
+    return HostTest::finish();
+}
@@ -0,0 +1,156 @@
+#include "HostTest.h"
+#include "RuleEvaluator.h"
+
+// The rule set setupRules() gives a zone in main.ino, with the thresholds
+// of a plant at 1000 light, 400 air quality and 30 °C
+static const float MAX_LIGHT = 1000;
+static const float MAX_AIR_QUALITY = 400;
+static const float MAX_TEMPERATURE = 30;
+static const uint32_t LIGHT_MIN_DWELL_MS = 300000;
+static const uint32_t FAN_MIN_DWELL_MS = 60000;
+
+static void addZoneRules(RuleEvaluator &rules)
+{
+    rules.addRule("light", RuleEvaluator::LIGHT, RuleEvaluator::LIGHT_LEVEL, RuleEvaluator::ON_AT_OR_BELOW,
+                  MAX_LIGHT, 100);
+    rules.addRule("air quality", RuleEvaluator::FAN, RuleEvaluator::AIR_QUALITY, RuleEvaluator::ON_AT_OR_BELOW,
+                  MAX_AIR_QUALITY, 100);
+    rules.addRule("temperature", RuleEvaluator::FAN, RuleEvaluator::TEMPERATURE, RuleEvaluator::ON_ABOVE,
+                  MAX_TEMPERATURE, 1.0f);
+    rules.setDwell(RuleEvaluator::LIGHT, LIGHT_MIN_DWELL_MS, LIGHT_MIN_DWELL_MS);
+    rules.setDwell(RuleEvaluator::FAN, FAN_MIN_DWELL_MS, FAN_MIN_DWELL_MS);
+}
+
+// One rule pass: the readings at atMs and the states expected after it
+struct TraceStep
+{
+    uint32_t atMs;
+    float temperature;
+    float light;
+    float airQuality;
+    bool lightOn;
+    bool fanOn;
+};
+
+// Runs the trace; each failing step is reported with its time
+static void runTrace(RuleEvaluator &rules, const TraceStep *steps, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const TraceStep &step = steps[i];
+        HostHal::setUs((uint64_t)step.atMs * 1000);
+
+        SensorSnapshot snapshot = {};
+        snapshot.takenAtMs = step.atMs;
+        snapshot.temperature = step.temperature;
+        snapshot.humidity = 50;
+        snapshot.light = step.light;
+        snapshot.airQuality = step.airQuality;
+        rules.evaluate(snapshot);
+
+        if (rules.desiredState(RuleEvaluator::LIGHT) != step.lightOn ||
+            rules.desiredState(RuleEvaluator::FAN) != step.fanOn)
+        {
+            printf("  step %d at %lu ms: light %d fan %d, expected light %d fan %d\n", i, (unsigned long)step.atMs,
+                   rules.desiredState(RuleEvaluator::LIGHT), rules.desiredState(RuleEvaluator::FAN), step.lightOn,
+                   step.fanOn);
+            CHECK(false);
+        }
+    }
+}
+
+static void lightHysteresisHoldsNearTheThreshold()
+{
+    RuleEvaluator rules;
+    addZoneRules(rules);
+    // Readings hovering around 1000 only switch at the threshold and past
+    // threshold + 100; the light dwell is 5 minutes
+    const TraceStep trace[] = {
+        {0, 22, 1500, 600, false, false},
+        {30000, 22, 1000, 600, true, false},      // at the threshold: on
+        {60000, 22, 1050, 600, true, false},      // back above, inside the band
+        {90000, 22, 1099, 600, true, false},
+        {300000, 22, 980, 600, true, false},
+        {330000, 22, 1101, 600, false, false},    // past the band, dwell over
+        {360000, 22, 1001, 600, false, false},    // just above the threshold again
+        {390000, 22, 1060, 600, false, false},
+    };
+    runTrace(rules, trace, sizeof(trace) / sizeof(trace[0]));
+    CHECK_EQUAL(2, rules.stats(RuleEvaluator::LIGHT).transitions);
+    CHECK_EQUAL(0, rules.stats(RuleEvaluator::LIGHT).heldByDwell);
+}
+
+static void dwellHoldsAChangeUntilItHasPassed()
+{
+    RuleEvaluator rules;
+    addZoneRules(rules);
+    const TraceStep trace[] = {
+        {0, 22, 500, 600, true, false},      // first change is never held
+        {30000, 22, 1500, 600, true, false},  // dark -> bright after 30 s: held
+        {270000, 22, 1500, 600, true, false},
+        {300000, 22, 1500, 600, false, false}, // 5 minutes after switching on
+        {330000, 22, 500, 600, false, false},  // dark again: held for 5 more minutes
+        {599000, 22, 500, 600, false, false},
+        {600000, 22, 500, 600, true, false},
+    };
+    runTrace(rules, trace, sizeof(trace) / sizeof(trace[0]));
+    CHECK_EQUAL(3, rules.stats(RuleEvaluator::LIGHT).transitions);
+    CHECK_EQUAL(4, rules.stats(RuleEvaluator::LIGHT).heldByDwell);
+}
+
+static void airQualityFanIsNotClearedByTheTemperatureRule()
+{
+    RuleEvaluator rules;
+    addZoneRules(rules);
+    // The fan has two rules; either keeps it on, it only goes off once both
+    // let go. Passes are 30 s apart, as the rules task runs.
+    const TraceStep trace[] = {
+        {0, 24, 1500, 600, false, false},
+        {30000, 24, 1500, 350, false, true},    // bad air, temperature fine: on
+        {60000, 24, 1500, 350, false, true},    // the cool temperature must not clear it
+        {90000, 24, 1500, 450, false, true},    // air inside its band
+        {120000, 31, 1500, 450, false, true},   // now also too warm
+        {150000, 31, 1500, 600, false, true},   // air fine, the temperature holds it
+        {180000, 29.5f, 1500, 600, false, true}, // inside the temperature band
+        {210000, 28.9f, 1500, 600, false, false}, // both released
+        {270000, 28.9f, 1500, 350, false, true},  // a minute later, bad air again
+    };
+    runTrace(rules, trace, sizeof(trace) / sizeof(trace[0]));
+    CHECK_EQUAL(3, rules.stats(RuleEvaluator::FAN).transitions);
+}
+
+static void failedReadingKeepsTheRuleWhereItWas()
+{
+    RuleEvaluator rules;
+    addZoneRules(rules);
+    const TraceStep trace[] = {
+        {0, 32, 1500, 600, false, true},
+        {90000, NAN, NAN, 600, false, true},   // DHT and LDR failed: temperature stays on
+        {180000, NAN, 500, 600, true, true},
+        {270000, 25, NAN, 600, true, false},
+    };
+    runTrace(rules, trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+static void thresholdUpdateAppliesOnTheNextPass()
+{
+    RuleEvaluator rules;
+    addZoneRules(rules);
+    const TraceStep before[] = {{0, 22, 1200, 600, false, false}};
+    runTrace(rules, before, 1);
+
+    // A new plant set with more light: 1200 is now dark enough
+    rules.setThreshold(0, 1500);
+    const TraceStep after[] = {{30000, 22, 1200, 600, true, false}};
+    runTrace(rules, after, 1);
+}
+
+int main()
+{
+    RUN_TEST(lightHysteresisHoldsNearTheThreshold);
+    RUN_TEST(dwellHoldsAChangeUntilItHasPassed);
+    RUN_TEST(airQualityFanIsNotClearedByTheTemperatureRule);
+    RUN_TEST(failedReadingKeepsTheRuleWhereItWas);
+    RUN_TEST(thresholdUpdateAppliesOnTheNextPass);
+    return HostTest::finish();
+}
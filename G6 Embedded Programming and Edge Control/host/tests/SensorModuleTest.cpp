@@ -0,0 +1,111 @@
+#include "HostTest.h"
+#include "SensorModule.h"
+
+static const uint8_t SOIL_DRY_PIN = 34;
+static const uint8_t SOIL_WET_PIN = 35;
+
+static PlantData makePlant(const char *id, int pin, float minMoisture)
+{
+    PlantData plant = {};
+    plant.plantId = id;
+    plant.moisturePin = pin;
+    plant.min_moisture = minMoisture;
+    plant.max_moisture = 90;
+    return plant;
+}
+
+static void dhtIsPolledAtMostOncePerSecond()
+{
+    DHT::setReading(DHT_PIN, 22.5f, 55);
+    SensorModule sensor(DHT_PIN, DHT_TYPE);
+    sensor.begin();
+
+    CHECK(sensor.acquire().temperature == 22.5f);
+    HostHal::advanceMs(SensorModule::DHT_MIN_INTERVAL_MS / 2);
+    sensor.acquire();
+    CHECK_EQUAL(1, DHT::getReads(DHT_PIN));
+
+    HostHal::advanceMs(SensorModule::DHT_MIN_INTERVAL_MS / 2);
+    sensor.acquire();
+    CHECK_EQUAL(2, DHT::getReads(DHT_PIN));
+}
+
+static void failedDhtReadKeepsTheLastGoodValues()
+{
+    DHT::setReading(DHT_PIN, 21, 60);
+    SensorModule sensor(DHT_PIN, DHT_TYPE);
+    sensor.acquire();
+
+    // The sensor stops answering
+    DHT::clearReadings();
+    HostHal::advanceMs(SensorModule::DHT_MIN_INTERVAL_MS);
+    const SensorSnapshot &snapshot = sensor.acquire();
+    CHECK(snapshot.temperature == 21);
+    CHECK(snapshot.humidity == 60);
+    CHECK_EQUAL(1000, snapshot.climateAtMs);
+}
+
+static void snapshotCarriesEverySoilProbe()
+{
+    HostHal::setAnalog(SOIL_DRY_PIN, PlantTable::DEFAULT_DRY_RAW);
+    HostHal::setAnalog(SOIL_WET_PIN, PlantTable::DEFAULT_WET_RAW);
+    HostHal::setAnalog(MQ2_PIN, 300);
+    HostHal::setAnalog(LDR_PIN, 1800);
+    SensorModule sensor(DHT_PIN, DHT_TYPE);
+    sensor.setPlants({makePlant("basil", SOIL_DRY_PIN, 40), makePlant("mint", SOIL_WET_PIN, 40)});
+
+    const SensorSnapshot &snapshot = sensor.acquire();
+    CHECK_EQUAL(2, snapshot.soilCount);
+    CHECK_EQUAL(PlantTable::DEFAULT_WET_RAW, (int)snapshot.soilMoistureOf(SOIL_WET_PIN));
+    CHECK_EQUAL(300, (int)snapshot.airQuality);
+    CHECK_EQUAL(1800, (int)snapshot.light);
+    CHECK(isnan(snapshot.temperature));
+}
+
+static void driestPlantIsFurthestBelowItsMinimum()
+{
+    HostHal::setAnalog(SOIL_DRY_PIN, PlantTable::DEFAULT_DRY_RAW);
+    HostHal::setAnalog(SOIL_WET_PIN, PlantTable::DEFAULT_WET_RAW);
+    std::vector<PlantData> plants = {makePlant("mint", SOIL_WET_PIN, 40), makePlant("basil", SOIL_DRY_PIN, 40)};
+    SensorModule sensor(DHT_PIN, DHT_TYPE);
+    sensor.setPlants(plants);
+
+    const SensorSnapshot &snapshot = sensor.acquire();
+    float percent = -1;
+    CHECK_EQUAL(1, sensor.driestPlant(plants, snapshot, percent));
+    CHECK(percent < 1);
+    CHECK(sensor.shouldWater(plants, snapshot) == false);   // mint is above its maximum
+
+    plants.resize(1);
+    CHECK_EQUAL(-1, sensor.driestPlant(plants, snapshot, percent));
+}
+
+static void thresholdsComeFromTheBackend()
+{
+    WiFi.setStatus(WL_CONNECTED);
+    HTTPClient::respond(200, "{\"plantId\":\"p1\",\"thresholds\":{"
+                             "\"light\":{\"min\":300,\"max\":900},\"airQuality\":{\"min\":0,\"max\":400},"
+                             "\"temperature\":{\"min\":18.5,\"max\":28},\"moisture\":{\"min\":35,\"max\":70}}}");
+    SensorModule sensor(DHT_PIN, DHT_TYPE);
+
+    CHECK(sensor.fetchThresholdsFromAPI());
+    CHECK(sensor.lightMax == 900);
+    CHECK(sensor.tempMin == 18.5f);
+    CHECK(sensor.soilMax == 70);
+    CHECK_EQUAL(1, HTTPClient::requests().size());
+
+    // A broken body leaves them alone
+    HTTPClient::respond(200, "{\"thresholds\":");
+    CHECK(!sensor.fetchThresholdsFromAPI());
+    CHECK(sensor.lightMax == 900);
+}
+
+int main()
+{
+    RUN_TEST(dhtIsPolledAtMostOncePerSecond);
+    RUN_TEST(failedDhtReadKeepsTheLastGoodValues);
+    RUN_TEST(snapshotCarriesEverySoilProbe);
+    RUN_TEST(driestPlantIsFurthestBelowItsMinimum);
+    RUN_TEST(thresholdsComeFromTheBackend);
+    return HostTest::finish();
+}
@@ -0,0 +1,131 @@
+#include <thread>
+#include "HostTest.h"
+#include "SpscQueue.h"
+
+static void itemsComeOutInOrder()
+{
+    SpscQueue<int, 4> queue;
+    CHECK(queue.isEmpty());
+    int item = 0;
+    CHECK(!queue.pop(item));
+
+    for (int i = 1; i <= 3; i++)
+    {
+        CHECK(queue.push(i));
+    }
+    CHECK_EQUAL(3, queue.size());
+    CHECK(queue.pop(item));
+    CHECK_EQUAL(1, item);
+    CHECK(queue.pop(item));
+    CHECK_EQUAL(2, item);
+    CHECK_EQUAL(1, queue.size());
+}
+
+static void fullQueueRejectsAndCounts()
+{
+    SpscQueue<int, 4> queue;
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(queue.push(i));
+    }
+    CHECK(!queue.push(99));
+    CHECK(!queue.push(99));
+    CHECK_EQUAL(2, queue.getDropped());
+    CHECK_EQUAL(4, queue.size());
+
+    int item = -1;
+    CHECK(queue.pop(item));
+    CHECK_EQUAL(0, item);
+    CHECK(queue.push(4));
+    for (int expected = 1; expected <= 4; expected++)
+    {
+        CHECK(queue.pop(item));
+        CHECK_EQUAL(expected, item);
+    }
+    CHECK(queue.isEmpty());
+}
+
+static void indicesWrapAroundTheRing()
+{
+    SpscQueue<uint32_t, 8> queue;
+    uint32_t item = 0;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        CHECK(queue.push(i));
+        CHECK(queue.push(i + 1));
+        CHECK(queue.pop(item));
+        CHECK_EQUAL(i, item);
+        CHECK(queue.pop(item));
+        CHECK_EQUAL(i + 1, item);
+    }
+    CHECK(queue.isEmpty());
+    CHECK_EQUAL(0, queue.getDropped());
+}
+
+struct Reading
+{
+    uint32_t sequence;
+    uint32_t check;
+};
+
+// Producer and consumer on two threads, as across the two ESP32 cores:
+// every item arrives once, in order and intact, or is counted as dropped
+static void producerAndConsumerThreads()
+{
+    static SpscQueue<Reading, 64> queue;
+    const uint32_t ITEMS = 200000;
+    uint32_t accepted = 0;
+
+    std::thread producer([&accepted, ITEMS]()
+                         {
+                             for (uint32_t i = 0; i < ITEMS; i++)
+                             {
+                                 Reading reading = {i, i * 2654435761u};
+                                 if (queue.push(reading))
+                                 {
+                                     accepted++;
+                                 }
+                             }
+                         });
+
+    uint32_t received = 0;
+    uint32_t corrupt = 0;
+    uint32_t outOfOrder = 0;
+    uint32_t last = 0;
+    bool first = true;
+    // Every item is either popped here or counted as dropped by the producer
+    while (received + queue.getDropped() < ITEMS)
+    {
+        Reading reading;
+        if (!queue.pop(reading))
+        {
+            continue;
+        }
+        if (reading.check != reading.sequence * 2654435761u)
+        {
+            corrupt++;
+        }
+        if (!first && reading.sequence <= last)
+        {
+            outOfOrder++;
+        }
+        first = false;
+        last = reading.sequence;
+        received++;
+    }
+    producer.join();
+
+    CHECK_EQUAL(0, corrupt);
+    CHECK_EQUAL(0, outOfOrder);
+    CHECK_EQUAL(accepted, received);
+    CHECK_EQUAL(ITEMS, received + queue.getDropped());
+}
+
+int main()
+{
+    RUN_TEST(itemsComeOutInOrder);
+    RUN_TEST(fullQueueRejectsAndCounts);
+    RUN_TEST(indicesWrapAroundTheRing);
+    RUN_TEST(producerAndConsumerThreads);
+    return HostTest::finish();
+}
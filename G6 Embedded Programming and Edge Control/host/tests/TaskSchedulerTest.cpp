@@ -0,0 +1,141 @@
+#include "HostTest.h"
+#include "TaskScheduler.h"
+
+static int fastRuns;
+static int slowRuns;
+static int oneShotRuns;
+static uint32_t workMs;
+
+static void fastTask()
+{
+    fastRuns++;
+}
+
+static void slowTask()
+{
+    slowRuns++;
+    HostHal::advanceMs(workMs);
+}
+
+static void oneShotTask()
+{
+    oneShotRuns++;
+}
+
+static void resetCounters()
+{
+    fastRuns = 0;
+    slowRuns = 0;
+    oneShotRuns = 0;
+    workMs = 0;
+}
+
+// Steps the virtual clock 1 ms at a time, ticking after each step
+static void runFor(TaskScheduler &scheduler, uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++)
+    {
+        HostHal::advanceMs(1);
+        scheduler.tick();
+    }
+}
+
+static void periodicTasksRunAtTheirInterval()
+{
+    resetCounters();
+    TaskScheduler scheduler;
+    int fast = scheduler.addPeriodic("fast", 10, fastTask);
+    scheduler.addPeriodic("slow", 100, slowTask, 0, 50);
+
+    scheduler.tick();
+    CHECK_EQUAL(1, fastRuns);
+    CHECK_EQUAL(0, slowRuns);
+
+    runFor(scheduler, 1000);
+    CHECK_EQUAL(101, fastRuns);
+    CHECK_EQUAL(10, slowRuns);
+    CHECK_EQUAL(0, scheduler.stats(fast)->missed);
+    CHECK_EQUAL(0, scheduler.stats(fast)->maxLateMs);
+}
+
+static void oneShotRunsOnceWhenScheduled()
+{
+    resetCounters();
+    TaskScheduler scheduler;
+    int shot = scheduler.addOneShot("shot", oneShotTask);
+
+    runFor(scheduler, 50);
+    CHECK_EQUAL(0, oneShotRuns);
+    CHECK(!scheduler.isPending(shot));
+
+    CHECK(scheduler.schedule(shot, 20));
+    CHECK(scheduler.isPending(shot));
+    CHECK_EQUAL(20, scheduler.idleTime());
+    runFor(scheduler, 19);
+    CHECK_EQUAL(0, oneShotRuns);
+    runFor(scheduler, 100);
+    CHECK_EQUAL(1, oneShotRuns);
+    CHECK(!scheduler.isPending(shot));
+
+    scheduler.schedule(shot, 10);
+    scheduler.cancel(shot);
+    runFor(scheduler, 100);
+    CHECK_EQUAL(1, oneShotRuns);
+}
+
+static void overrunsAndMissedDeadlinesAreCounted()
+{
+    resetCounters();
+    TaskScheduler scheduler;
+    int slow = scheduler.addPeriodic("slow", 100, slowTask, 20);
+
+    workMs = 30;
+    scheduler.tick();
+    CHECK_EQUAL(1, scheduler.stats(slow)->overruns);
+    CHECK_EQUAL(30, scheduler.stats(slow)->maxRunMs);
+
+    // Stalled for three periods: one late run, no burst to catch up
+    workMs = 0;
+    HostHal::advanceMs(350);
+    scheduler.tick();
+    scheduler.tick();
+    CHECK_EQUAL(2, slowRuns);
+    CHECK_EQUAL(1, scheduler.stats(slow)->missed);
+    CHECK_EQUAL(280, scheduler.stats(slow)->maxLateMs);
+    CHECK_EQUAL(100, scheduler.idleTime());
+}
+
+static void dueTimesSurviveMillisRollover()
+{
+    resetCounters();
+    HostHal::setUs((uint64_t)(UINT32_MAX - 45) * 1000);
+    TaskScheduler scheduler;
+    scheduler.addPeriodic("fast", 10, fastTask);
+
+    runFor(scheduler, 100);
+    CHECK_EQUAL(11, fastRuns);
+    CHECK(scheduler.now() < 100);
+}
+
+static void fullTableRejectsTasks()
+{
+    resetCounters();
+    TaskScheduler scheduler;
+    for (int i = 0; i < TaskScheduler::MAX_TASKS; i++)
+    {
+        CHECK_EQUAL(i, scheduler.addPeriodic("task", 10, fastTask));
+    }
+    CHECK_EQUAL(TaskScheduler::INVALID_TASK, scheduler.addPeriodic("extra", 10, fastTask));
+    CHECK_EQUAL(TaskScheduler::INVALID_TASK, scheduler.addOneShot("extra", oneShotTask));
+    CHECK_EQUAL(TaskScheduler::MAX_TASKS, scheduler.taskCount());
+}
+
+int main()
+{
+    RUN_TEST(periodicTasksRunAtTheirInterval);
+    RUN_TEST(oneShotRunsOnceWhenScheduled);
+    RUN_TEST(overrunsAndMissedDeadlinesAreCounted);
+    RUN_TEST(dueTimesSurviveMillisRollover);
+    RUN_TEST(fullTableRejectsTasks);
+    return HostTest::finish();
+}
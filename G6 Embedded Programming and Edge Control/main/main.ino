@@ -1,4 +1,6 @@
 #include <WiFi.h>
+#include <LittleFS.h>
+#include <Preferences.h>
 #include "SensorModule.h"
 #include "ActuatorModule.h"
 #include <PubSubClient.h>
@@ -7,11 +9,21 @@
 #include <Adafruit_MQTT_Client.h>
 #include "MqttModule.h"
 #include "RESTClient.h"
+#include "TaskScheduler.h"
+#include "TelemetryBuffer.h"
+#include "OfflineQueue.h"
+#include "PlantCache.h"
+#include "RuleEvaluator.h"
+#include "PumpController.h"
+#include "SpscQueue.h"
+#include "ClockService.h"
+#include "MqttTelemetry.h"
+#include "DeltaReporter.h"
+#include "Profiler.h"
+#include "Log.h"
+#include "Zone.h"
 #include "secrets.h"
 
-// Zone ID
-const String zoneId = "zone1";
-
 // WIFI Configuration
 const char* SSID = "Cynex@2.4GHz";
 const char* PASSWORD = "cyber@cynex";
@@ -24,239 +36,744 @@ const String USER_ID = "5ZyZcYb6wpdlObgeJiaGZ0ydMbW2";
 #define MQTT_USERNAME "SmartGrow"
 #define MQTT_KEYS ""
 
-// Actuator PIN
-const int PUMP_PIN = 25;
-const int FAN_PIN_1 = 27;
-const int FAN_PIN_2 = 18;
-const int LIGHT_PIN = 26;
+// Status LED; the actuator pins are part of the node role (ActuatorRoles.h)
 const int LED_PIN = 23;
 
-float min_moisture;
-float min_temperature;
-float min_light;
-float min_airQuality;
-float max_moisture;
-float max_temperature;
-float max_light;
-float max_airQuality;
+// Nominal flow of the zone pump, used for the water-per-cycle estimate
+const float PUMP_FLOW_ML_PER_S = 25.0f;
+
+// Sensing and control run in loop() on the Arduino core (1); REST and MQTT
+// run in their own task on the core of the WiFi stack (0)
+const BaseType_t NETWORK_CORE = 0;
+const uint32_t NETWORK_TASK_STACK = 16384;
+const UBaseType_t NETWORK_TASK_PRIORITY = 1;
+const uint32_t NETWORK_MAX_SLEEP_MS = 100;
+
+// Boot waits this long for WiFi, then carries on offline; the WiFi stack keeps
+// reconnecting in the background and MQTT/REST resume once it is back
+const uint32_t WIFI_CONNECT_TIMEOUT_MS = 20000;
+
+// Task periods (ms)
+const uint32_t SAMPLE_INTERVAL_MS = 15000;
+// Without the batch endpoint every sample is a POST of its own: sample at the
+// original 30 s so the request rate does not double
+const uint32_t UNBATCHED_SAMPLE_INTERVAL_MS = 30000;
+const uint32_t UPLOAD_INTERVAL_MS = 1000;
+const uint32_t BACKLOG_INTERVAL_MS = 5000;
+const uint32_t RULES_INTERVAL_MS = 30000;
+const uint32_t MQTT_POLL_INTERVAL_MS = 50;
+const uint32_t ACTUATOR_INTERVAL_MS = 100;
+const uint32_t HEARTBEAT_INTERVAL_MS = 500;
+const uint32_t ANALOG_SAMPLE_INTERVAL_MS = 100;
+const uint32_t STATS_INTERVAL_MS = 300000;
+const uint32_t PUMP_CONTROL_INTERVAL_MS = 250;
+const uint32_t CLOCK_UPDATE_INTERVAL_MS = 1000;
+const uint32_t METRICS_INTERVAL_MS = 300000;
+const uint32_t LOG_DRAIN_INTERVAL_MS = 50;
+
+// Analog filter per channel: average of 8 reads, median of the last 5,
+// then an EMA with alpha 1/8 (about 1 s time constant at 100 ms sampling)
+const AnalogFilter::Config ADC_FILTER = {8, 5, 3};
+
+// Watering in pulses of 1-8 s with 20 s soaks, at most 6 pulses per cycle,
+// up to the middle of the driest plant's moisture range. The zone response
+// starts at 2 %/s and is learned from there (kept in NVS).
+const PumpController::Config PUMP_CONFIG = {1000, 8000, 20000, 6, 2.0f, 0.3f, PUMP_FLOW_ML_PER_S};
+
+// Telemetry is uploaded as one batch of TELEMETRY_BATCH_SIZE samples,
+// or earlier once the oldest waiting sample is TELEMETRY_FLUSH_INTERVAL_MS old
+const int TELEMETRY_BATCH_SIZE = 20;
+const uint32_t TELEMETRY_FLUSH_INTERVAL_MS = 300000;
+// Post a flushed batch as one array to /api/v1/sensor-data/batch. If the
+// backend answers 404 the node falls back to /api/v1/sensor-data, one request
+// per sample over the same kept-alive connection, at UNBATCHED_SAMPLE_INTERVAL_MS.
+const bool TELEMETRY_BATCH_ENDPOINT = true;
+
+// Samples that failed to upload are kept on flash (oldest evicted past the cap)
+// and replayed BACKLOG_BATCH_SIZE at a time once the backend is reachable
+const uint32_t OFFLINE_QUEUE_MAX_SAMPLES = 4096;
+const int BACKLOG_BATCH_SIZE = 10;
+
+// Plant thresholds are served from NVS at boot and refreshed in the background
+// with a conditional GET; CONFIG_FIRST_REFRESH_MS after a cached boot, then every
+// CONFIG_REFRESH_INTERVAL_MS
+const uint32_t CONFIG_REFRESH_INTERVAL_MS = 600000;
+const uint32_t CONFIG_FIRST_REFRESH_MS = 10000;
+
+// Edge rules: a rule releases its actuator only once the reading is back past
+// the threshold by the band, and a relay holds each state for at least the dwell
+const float LIGHT_HYSTERESIS = 100;        // ADC counts
+const float AIR_QUALITY_HYSTERESIS = 100;  // ADC counts
+const float TEMPERATURE_HYSTERESIS = 1.0;  // °C
+const uint32_t LIGHT_MIN_DWELL_MS = 300000;
+const uint32_t FAN_MIN_DWELL_MS = 60000;
+
+// Uplink encoding of telemetry and actuator feedback. FORMAT_CBOR cuts the
+// payloads to a fraction of the JSON size; the backend needs the decoder in
+// tools/decode_payload.py (or an equivalent) before switching.
+const PayloadFormat UPLINK_FORMAT = FORMAT_JSON;
+
+// Samples are published one by one on the zone's MQTT topic (TELEMETRY_TOPIC
+// followed by the zone id) while the broker
+// link is up, and go through the REST batch upload only when it is not.
+// MQTT telemetry is always CBOR: a JSON sample does not fit the client's packet
+// buffer. The backend has to subscribe to the topic before this is enabled.
+const bool TELEMETRY_OVER_MQTT = false;
+
+// Send only readings that moved past their deadband, with a full keyframe
+// every 15 min (DeltaReporter::DEFAULT_CONFIG). The backend carries missing
+// readings forward from the last keyframe; see tools/decode_payload.py.
+const bool TELEMETRY_DELTAS = false;
 
 // WiFi & MQTT Clients
 WiFiClient wifiClient;
 Adafruit_MQTT_Client mqtt(&wifiClient, MQTT_SERVER, MQTT_PORT, MQTT_USERNAME, MQTT_KEYS);
+MqttModule mqttConnection(mqtt);
+#define TELEMETRY_TOPIC MQTT_USERNAME "/feeds/group-1.telemetry-"
 
-// MQTT Publish and Subscribe feeds
-Adafruit_MQTT_Publish publishFeed = Adafruit_MQTT_Publish(&mqtt, MQTT_USERNAME "/feeds/group-1.actuator-status");
-Adafruit_MQTT_Publish feedbackFeed = Adafruit_MQTT_Publish(&mqtt, MQTT_USERNAME "/feeds/group-1.actuator-feedback");
+// Commands for every zone arrive on one feed (the client has few subscription
+// slots); feedback goes out on each zone's own feed
 Adafruit_MQTT_Subscribe subscribeFeed = Adafruit_MQTT_Subscribe(&mqtt, MQTT_USERNAME "/feeds/group-1.actuator-status");
+#if PROFILING
+#define METRICS_TOPIC MQTT_USERNAME "/feeds/group-1.metrics"
+Adafruit_MQTT_Publish metricsFeed = Adafruit_MQTT_Publish(&mqtt, METRICS_TOPIC);
+#endif
 
 // Initialize RESTClient
 RESTClient restClient(SERVER_URL, true);
 
-// Declare pointer to SensorModule
-SensorModule* sensor;  
+// The grow trays wired to this node. The first keeps the topic and NVS names
+// of the single-zone firmware. A second tray needs its own sensor pins and
+// channel set, e.g.
+//   ActuatorBank<Zone2Actuators> zone2Actuators;
+//   {"zone2", 4, 34, 35, &zone2Actuators, MQTT_USERNAME "/feeds/group-1.actuator-feedback-zone2", "plants-zone2", nullptr}
+//
+// Trays with more probes than free ADC pins read them through a 16-channel
+// mux; such plants use moisturePin 100-115 (AnalogMux::PIN_BASE + channel).
+// Select lines on GPIO 13/14/17/15, which no role or the LED uses. Only the
+// first SensorSnapshot::MAX_SOIL plants go into the uplink:
+//   const AnalogMux::Config SOIL_MUX = {36, {13, 14, 17, 15}, 4, AnalogMux::NO_ENABLE, 20};
+//   {"zone1", ..., "plants", &SOIL_MUX}
+ActuatorBank<Zone1Actuators> zone1Actuators;
+
+const ZoneConfig ZONES[] = {
+  {"zone1", DHT_PIN, MQ2_PIN, LDR_PIN, &zone1Actuators, MQTT_USERNAME "/feeds/group-1.actuator-feedback", "plants", nullptr},
+};
+const int ZONE_COUNT = sizeof(ZONES) / sizeof(ZONES[0]);
+Zone *zones[ZONE_COUNT];
+
+TaskScheduler scheduler;         // control, in loop()
+TaskScheduler networkScheduler;  // network task
+int sampleTaskId = -1;
+bool ledOn = false;
+
+// Everything crossing between the two tasks goes through these queues
+struct MqttCommand
+{
+  char payload[SUBSCRIPTIONDATALEN];
+  unsigned long receivedAtUs;
+};
+
+struct FeedbackMessage
+{
+  uint8_t zone;
+  uint8_t payload[ActuatorModule::FEEDBACK_CAPACITY];
+  uint16_t length;
+};
+
+struct SampleMessage
+{
+  uint8_t zone;
+  ZoneSample sample;
+};
+
+struct PlantUpdate
+{
+  uint8_t zone;
+  std::vector<PlantData> *plants;
+};
+
+SpscQueue<SampleMessage, 16> sampleQueue;             // control -> network
+SpscQueue<FeedbackMessage, 4> feedbackQueue;          // control -> network
+// Feedback given up on: too large for one MQTT packet or failed FEEDBACK_MAX_ATTEMPTS times
+std::atomic<uint32_t> feedbackDropped(0);
+const uint8_t FEEDBACK_MAX_ATTEMPTS = 5;
+SpscQueue<MqttCommand, 8> commandQueue;               // network -> control
+SpscQueue<PlantUpdate, 8> plantUpdates;               // network -> control
 
-// Actuator Setup ActuatorModule(PUMP_PIN,FAN_PIN,LIGHT_PIN)
-ActuatorModule actuator(PUMP_PIN, FAN_PIN_1, FAN_PIN_2, LIGHT_PIN, &publishFeed, &feedbackFeed, &subscribeFeed);
-std::vector<PlantData> plants;
+// Samples that could not be uploaded, of every zone
+OfflineQueue offlineQueue(LittleFS, "/queue", OFFLINE_QUEUE_MAX_SAMPLES);
 
 void connectToWiFi() 
 {
   Serial.print("Connecting to WiFi");
+  WiFi.setAutoReconnect(true);
   WiFi.begin(SSID, PASSWORD);
-  while (WiFi.status() != WL_CONNECTED) {
+  unsigned long start = millis();
+  while (WiFi.status() != WL_CONNECTED && millis() - start < WIFI_CONNECT_TIMEOUT_MS) {
     Serial.print(".");
     delay(500);
   }
-  Serial.println("\nWiFi connected!");
+  if (WiFi.status() == WL_CONNECTED) {
+    Serial.println("\nWiFi connected!");
+  } else {
+    Serial.println("\nWiFi not available, starting offline");
+  }
 }
 
-// edge control
-void evaluateSensorsAndTrigger() 
+void setupRules(Zone &zone)
 {
-  int lightValue = sensor->readLightLevel();
-  int airQualityValue = sensor->readAirQuality();
-  int tempValue = sensor->readTemperature();
+  RuleEvaluator &rules = zone.rules;
+  // Same comparisons as before: light and air quality act at or below their max,
+  // the fan also runs while the temperature is above its max
+  zone.lightRule = rules.addRule("light", RuleEvaluator::LIGHT, RuleEvaluator::LIGHT_LEVEL,
+                                 RuleEvaluator::ON_AT_OR_BELOW, 0, LIGHT_HYSTERESIS);
+  zone.airQualityRule = rules.addRule("air quality", RuleEvaluator::FAN, RuleEvaluator::AIR_QUALITY,
+                                      RuleEvaluator::ON_AT_OR_BELOW, 0, AIR_QUALITY_HYSTERESIS);
+  zone.temperatureRule = rules.addRule("temperature", RuleEvaluator::FAN, RuleEvaluator::TEMPERATURE,
+                                       RuleEvaluator::ON_ABOVE, 0, TEMPERATURE_HYSTERESIS);
+  rules.setDwell(RuleEvaluator::LIGHT, LIGHT_MIN_DWELL_MS, LIGHT_MIN_DWELL_MS);
+  rules.setDwell(RuleEvaluator::FAN, FAN_MIN_DWELL_MS, FAN_MIN_DWELL_MS);
+}
 
-  bool lightBelow = sensor->checkAndTrigger("Light", lightValue, max_light);
-  bool airQualityBelow = sensor->checkAndTrigger("Air Quality", airQualityValue, max_airQuality);
-  bool tempBelow = sensor->checkAndTrigger("Temperature", tempValue, max_temperature);
+void setup() 
+{
+  pinMode(LED_PIN, OUTPUT);
+  Serial.begin(115200);
+  // Also prints whatever a crash left in the log ring
+  Logger::begin(Serial);
+  connectToWiFi();
+  ClockService::begin("pool.ntp.org", "time.nist.gov");
+  mqtt.subscribe(&subscribeFeed);
 
-  if (lightBelow) 
+  if (LittleFS.begin(true))
+  {
+    offlineQueue.begin();
+  } else
   {
-    Serial.println("Light out of range! Activate actuator.");
-    actuator.setLight(true, true);
-  } else 
+    Serial.println("LittleFS mount failed, offline queue disabled");
+  }
+
+  bool cached = true;
+  for (int i = 0; i < ZONE_COUNT; i++)
   {
-    Serial.println("Light normal. Turning off grow light.");
-    actuator.setLight(false, true);
+    Zone *zone = new Zone(i, ZONES[i], mqtt, TELEMETRY_TOPIC, TELEMETRY_BATCH_SIZE, TELEMETRY_FLUSH_INTERVAL_MS);
+    zones[i] = zone;
+    zone->actuator.begin();
+
+    // Boot from the last known plant set; only a blank zone waits for the backend
+    if (zone->plantCache.load(zone->plants))
+    {
+      Serial.printf("%s: loaded %u plants from cache\n", zone->id.c_str(), (unsigned)zone->plants.size());
+    } else
+    {
+      Serial.printf("%s: no cached plants, fetching from server\n", zone->id.c_str());
+      refreshPlants(*zone, zone->plants);
+      cached = false;
+    }
+
+    zone->createSensor(DHT_TYPE);
+    zone->sensor->begin();
+    zone->sensor->configureFilters(ADC_FILTER);
+    setupRules(*zone);
+    zone->pump.configure(PUMP_CONFIG);
+    loadPumpGain(*zone);
+    zone->applyPlants();
+    zone->actuator.setFeedbackPublisher([i](const uint8_t *payload, size_t length) {
+      return publishFeedback(i, payload, length);
+    });
+    zone->actuator.setFeedbackFormat(UPLINK_FORMAT);
   }
+  restClient.setPayloadFormat(UPLINK_FORMAT);
+  restClient.setBatchUploads(TELEMETRY_BATCH_ENDPOINT);
+
+  // Control: short, time-critical tasks only
+  scheduler.addPeriodic("heartbeat", HEARTBEAT_INTERVAL_MS, heartbeatTask);
+  scheduler.addPeriodic("actuators", ACTUATOR_INTERVAL_MS, actuatorTask);
+  scheduler.addPeriodic("adc", ANALOG_SAMPLE_INTERVAL_MS, analogTask, 20);
+  sampleTaskId = scheduler.addPeriodic("sample", TELEMETRY_BATCH_ENDPOINT ? SAMPLE_INTERVAL_MS : UNBATCHED_SAMPLE_INTERVAL_MS,
+                                       sampleTask, 2000);
+  scheduler.addPeriodic("rules", RULES_INTERVAL_MS, rulesTask, 2000, 2000);
+  scheduler.addPeriodic("pump", PUMP_CONTROL_INTERVAL_MS, pumpTask, 1000);
+  scheduler.addPeriodic("stats", STATS_INTERVAL_MS, statsTask, 0, STATS_INTERVAL_MS);
+
+  // Network: anything that may block on a socket
+  networkScheduler.addPeriodic("clock", CLOCK_UPDATE_INTERVAL_MS, clockTask, 1000);
+  networkScheduler.addPeriodic("mqtt", MQTT_POLL_INTERVAL_MS, mqttTask, 1000);
+  networkScheduler.addPeriodic("upload", UPLOAD_INTERVAL_MS, uploadTask, 10000, 1000);
+  networkScheduler.addPeriodic("backlog", BACKLOG_INTERVAL_MS, backlogTask, 10000, BACKLOG_INTERVAL_MS);
+  networkScheduler.addPeriodic("config", CONFIG_REFRESH_INTERVAL_MS, configTask, 15000,
+                               cached ? CONFIG_FIRST_REFRESH_MS : CONFIG_REFRESH_INTERVAL_MS);
+#if PROFILING
+  networkScheduler.addPeriodic("metrics", METRICS_INTERVAL_MS, metricsTask, 0, METRICS_INTERVAL_MS);
+  Serial.printf("Profiler: %lu ns per scope\n", (unsigned long)Profiler::calibrate());
+#endif
+  networkScheduler.addPeriodic("net-stats", STATS_INTERVAL_MS, networkStatsTask, 0, STATS_INTERVAL_MS);
+  networkScheduler.addPeriodic("log", LOG_DRAIN_INTERVAL_MS, logTask, 500);
+
+  xTaskCreatePinnedToCore(networkLoop, "network", NETWORK_TASK_STACK, nullptr,
+                          NETWORK_TASK_PRIORITY, nullptr, NETWORK_CORE);
+}
 
-  if (airQualityBelow) 
+void networkLoop(void *)
+{
+  for (;;)
   {
-    Serial.println("Air quality bad! Activate actuator.");
-    actuator.setFan(true, true);
-  } else 
+    networkScheduler.tick();
+
+    // Sleep until the next task is due so the idle task can run on this core
+    uint32_t idle = networkScheduler.idleTime();
+    if (idle > NETWORK_MAX_SLEEP_MS)
+    {
+      idle = NETWORK_MAX_SLEEP_MS;
+    }
+    vTaskDelay(pdMS_TO_TICKS(idle > 0 ? idle : 1));
+  }
+}
+
+// Fetches the plant set unless the server reports the cached one as current.
+// Returns true when target was replaced.
+bool refreshPlants(Zone &zone, std::vector<PlantData> &target)
+{
+  if (WiFi.status() != WL_CONNECTED)
   {
-    Serial.println("Air quality normal! Turning off actuator.");
-    actuator.setFan(false, true);
+    return false;
   }
 
-  if (!tempBelow) 
+  String etag;
+  PlantFetchResult result = restClient.fetchPlantsIfChanged(zone.id, zone.plantCache.getETag(), target, etag);
+  if (result == PLANTS_NOT_MODIFIED)
   {
-    Serial.println("Temperature too high! Activate fan.");
-    actuator.setFan(true, true);
-  } else 
+    Serial.printf("%s: plant config unchanged\n", zone.id.c_str());
+    return false;
+  }
+  if (result != PLANTS_UPDATED)
   {
-    actuator.setFan(false, true);
-    Serial.println("Temperature normal. Turning off fan.");
+    Serial.printf("%s: plant config refresh failed, keeping current set\n", zone.id.c_str());
+    return false;
   }
+
+  zone.plantCache.save(target, etag);
+  return true;
 }
 
-void setup() 
+void heartbeatTask()
 {
-  pinMode(LED_PIN, OUTPUT);
-  Serial.begin(115200);
-  connectToWiFi();
-  mqtt.subscribe(&subscribeFeed);
-  actuator.begin();
-
-  plants = restClient.getPlantsByZone(zoneId);
-
-  std::vector<uint8_t> soilPins;
-  for (const auto& plant : plants) 
-  {
-    soilPins.push_back(plant.moisturePin);
-  }
-
-  // Create sensor module with the dynamically built pins
-  sensor = new SensorModule(DHT_PIN, DHT_TYPE, soilPins.data(), soilPins.size());
-  sensor->begin();
-  for (size_t i = 0; i < plants.size(); ++i) 
-  {
-    sensor->addPlant(i, plants[i].moisturePin, plants[i].plantId);
-  }
-
-  if(plants.size() > 0)
-  {
-    max_moisture = plants[0].max_moisture;
-    max_temperature = plants[0].max_temperature;
-    max_light = plants[0].max_light;
-    max_airQuality = plants[0].max_airQuality;
-    for (const auto& p : plants) {
-      Serial.println("Plant ID: " + p.plantId);
-      Serial.print("Moisture pin: ");
-      Serial.println(p.moisturePin);
-      Serial.print("Moisture Threshold: ");
-      Serial.print(p.min_moisture);
-      Serial.print(" - ");
-      Serial.println(p.max_moisture);
-      Serial.print("Temperature Threshold: ");
-      Serial.print(p.min_temperature);
-      Serial.print(" - ");
-      Serial.println(p.max_temperature);
-      Serial.print("Light Threshold: ");
-      Serial.print(p.min_light);
-      Serial.print(" - ");
-      Serial.println(p.max_light);
-      Serial.print("Air Quality Threshold: ");
-      Serial.print(p.min_airQuality);
-      Serial.print(" - ");
-      Serial.println(p.max_airQuality);
-      Serial.println();
+  ledOn = !ledOn;
+  digitalWrite(LED_PIN, ledOn ? HIGH : LOW);
+}
+
+void clockTask()
+{
+  ClockService::update();
+}
+
+// Log records are turned into text here, away from the control loop
+void logTask()
+{
+  Logger::drain(Serial);
+}
+
+void mqttTask()
+{
+  // Reconnects are paced by the manager; while the link is down commands
+  // cannot arrive and feedback stays queued
+  if (!mqttConnection.update())
+  {
+    return;
+  }
+
+  pollCommands();
+  publishPendingFeedback();
+}
+
+// Drains whatever arrived since the last tick without waiting for more
+void pollCommands()
+{
+  PROFILE_SCOPE(PHASE_MQTT_POLL);
+  Adafruit_MQTT_Subscribe* subscription;
+  while ((subscription = mqtt.readSubscription(0))) 
+  {
+    if (subscription == &subscribeFeed) {
+      LOG_INFO("Received JSON: %s", (const char*)subscribeFeed.lastread);
+
+      // Handed to the control task, which owns the actuators
+      MqttCommand command;
+      memcpy(command.payload, subscribeFeed.lastread, sizeof(command.payload));
+      command.payload[sizeof(command.payload) - 1] = '\0';
+      command.receivedAtUs = micros();
+      if (!commandQueue.push(command))
+      {
+        LOG_WARN("Command queue full, command dropped");
+      }
     }
   }
+}
 
-  for(int i = 0; i < 3 ; i++)
+// Feedback from the control task. A failed publish is retried on the next
+// ticks, FEEDBACK_MAX_ATTEMPTS times in all; a message the MQTT packet cannot
+// hold is never tried. Either way it is dropped so the queue keeps moving.
+void publishPendingFeedback()
+{
+  PROFILE_SCOPE(PHASE_MQTT_PUBLISH);
+  static FeedbackMessage feedback;
+  static bool feedbackPending = false;
+  static uint8_t attempts = 0;
+  while (feedbackPending || feedbackQueue.pop(feedback))
   {
-    digitalWrite(LED_PIN, HIGH);
-    delay(500);
-    digitalWrite(LED_PIN, LOW);
-    delay(500);
+    Adafruit_MQTT_Publish &feed = zones[feedback.zone]->feedbackFeed;
+    // Fixed header, topic length and topic share the client's packet buffer
+    if (feedback.length + strlen(feed.topic) + 5 > MAXBUFFERSIZE)
+    {
+      feedbackDropped++;
+      LOG_WARN("Feedback of %u bytes does not fit the MQTT packet, dropped", (unsigned)feedback.length);
+      feedbackPending = false;
+      continue;
+    }
+
+    if (feed.publish(feedback.payload, feedback.length))
+    {
+      feedbackPending = false;
+      attempts = 0;
+      continue;
+    }
+    if (++attempts < FEEDBACK_MAX_ATTEMPTS)
+    {
+      feedbackPending = true;
+      break;
+    }
+    feedbackDropped++;
+    LOG_WARN("Feedback dropped after %u failed publishes", (unsigned)attempts);
+    feedbackPending = false;
+    attempts = 0;
+    break;
   }
 }
 
-void loop() {
-  for(int i = 0; i < 3 ; i++)
+#if PROFILING
+// Publishes the phase histograms of the last window to the metrics feed, split
+// over as many messages as the MQTT packet buffer needs
+void metricsTask()
+{
+  // Until the broker is reachable the window keeps growing
+  if (!mqttConnection.isConnected())
   {
-    digitalWrite(LED_PIN, HIGH);
-    delay(500);
-    digitalWrite(LED_PIN, LOW);
-    delay(500);
+    return;
   }
-  if (!mqtt.connected()) 
+
+  char message[MAXBUFFERSIZE - sizeof(METRICS_TOPIC) - 4];
+  int phase = 0;
+  while (phase < PHASE_COUNT)
   {
-    MqttModule::connectToMqtt(mqtt);
+    BufferPrint out(message, sizeof(message));
+    int next = Profiler::writeSummary(out, phase);
+    if (next == phase)
+    {
+      // One entry larger than a message; cannot happen with the phase names in use
+      break;
+    }
+    if (out.length() > 2 && !metricsFeed.publish((uint8_t *)message, out.length()))
+    {
+      return;
+    }
+    phase = next;
   }
+  Profiler::reset();
+}
+#endif
 
-  // Check for any incoming messages
-  Adafruit_MQTT_Subscribe* subscription;
-  while ((subscription = mqtt.readSubscription(5000))) 
+// Runs on the control task: queues the feedback message for the network task
+bool publishFeedback(uint8_t zone, const uint8_t *payload, size_t length)
+{
+  FeedbackMessage message;
+  if (length > sizeof(message.payload))
   {
-    if (subscription == &subscribeFeed) {
-      String jsonStr = (char*)subscribeFeed.lastread;
-      Serial.println("Received JSON: " + jsonStr);
-      actuator.callback(subscription);  // Handle MQTT message
+    // Never sent cut off; true so the actuator module does not keep it
+    feedbackDropped++;
+    return true;
+  }
+  message.zone = zone;
+  message.length = length;
+  memcpy(message.payload, payload, length);
+  return feedbackQueue.push(message);
+}
+
+Zone *findZone(const char *id)
+{
+  for (Zone *zone : zones)
+  {
+    if (zone->id == id)
+    {
+      return zone;
     }
   }
+  return nullptr;
+}
+
+// Commands name their tray with "zone"; without one they go to the first zone
+void routeCommand(const char *payload, unsigned long receivedAtUs)
+{
+  StaticJsonDocument<200> doc;
+  DeserializationError error = deserializeJson(doc, payload);
+  if (error)
+  {
+    LOG_WARN("JSON parse failed: %s", error.c_str());
+    return;
+  }
 
-  // === 🌱 Build soilMoistureByPin vector ===
-  std::vector<std::pair<int, float>> soilMoistureByPin;
-  for (int i = 0; i < plants.size(); ++i) 
+  const char *target = doc["zone"];
+  Zone *zone = target == nullptr ? zones[0] : findZone(target);
+  if (zone == nullptr)
   {
-    float moisture = sensor->readSoilMoisture(sensor->plants[i].soilPin);
-    soilMoistureByPin.push_back(std::make_pair(sensor->plants[i].soilPin, moisture));
+    LOG_WARN("Command for unknown zone %s dropped", target);
+    return;
+  }
+  zone->actuator.handleCommand(doc, receivedAtUs);
+}
+
+void actuatorTask()
+{
+  MqttCommand command;
+  while (commandQueue.pop(command))
+  {
+    routeCommand(command.payload, command.receivedAtUs);
+  }
+  for (Zone *zone : zones)
+  {
+    zone->actuator.update();
+  }
+}
+
+void analogTask()
+{
+  PROFILE_SCOPE(PHASE_ADC);
+  for (Zone *zone : zones)
+  {
+    zone->sensor->sampleAnalog();
+  }
+}
+
+void sampleTask()
+{
+  // The network task turned batching off: one POST per sample from now on
+  if (!restClient.usesBatchUploads())
+  {
+    scheduler.setInterval(sampleTaskId, UNBATCHED_SAMPLE_INTERVAL_MS);
   }
 
   // === 🕒 Get timestamp ===
-  String timestamp = sensor->getISO8601Time();
+  uint32_t now = ClockService::epochSeconds();
+
+  for (Zone *zone : zones)
+  {
+    SampleMessage message;
+    message.zone = zone->index;
+    message.sample.setReadings(zone->sensor->acquire());
+    message.sample.setTimestamp(now);
+
+    if (!sampleQueue.push(message))
+    {
+      LOG_WARN("Sample queue full, %s sample dropped", zone->id);
+    }
+  }
+}
 
-  // === ☁️ Send all sensor data to cloud ===
-  restClient.sendZoneSensorData(
-    zoneId,
-    sensor->readTemperature(),
-    sensor->readHumidity(),
-    sensor->readLightLevel(),
-    sensor->readAirQuality(),
-    soilMoistureByPin,
-    USER_ID,
-    timestamp);
+void uploadTask()
+{
+  SampleMessage message;
+  while (sampleQueue.pop(message))
+  {
+    Zone *zone = zones[message.zone];
+    ZoneSample &sample = message.sample;
+    if (TELEMETRY_DELTAS && !zone->deltaReporter.filter(sample))
+    {
+      continue;
+    }
+    if (TELEMETRY_OVER_MQTT && mqttConnection.isConnected() && zone->mqttTelemetry.publish(sample, USER_ID))
+    {
+      continue;
+    }
+    zone->telemetry.push(sample);
+  }
 
-  evaluateSensorsAndTrigger();
+  for (Zone *zone : zones)
+  {
+    uploadZone(*zone);
+  }
+}
 
-  if (digitalRead(PUMP_PIN) == HIGH) 
+void uploadZone(Zone &zone)
+{
+  TelemetryBuffer &telemetry = zone.telemetry;
+  if (!telemetry.shouldFlush(millis()))
   {
-    Serial.println("[CHECK] Pump is currently ON MANUALLY. Waiting 5 seconds...");
+    return;
+  }
 
-    // Now check soil condition again
-    if (sensor->shouldWater(plants)) 
+  // === ☁️ Send the waiting samples to cloud in one request ===
+  int batch = min(telemetry.size(), telemetry.getBatchSize());
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    BatchResult result = restClient.sendZoneSensorBatch(zone.id, telemetry, batch, USER_ID);
+    int handled = result.sent + result.rejected;
+    if (handled > 0)
     {
-      Serial.println("[CHECK] Still needs water. Keeping pump ON.");
-    } else 
+      // Rejected samples are dropped, the server will never take them
+      telemetry.discard(handled);
+      return;
+    }
+  }
+
+  // Offline: keep the batch on flash until the backend is reachable again
+  Serial.printf("%s: upload failed, queueing %d samples offline\n", zone.id.c_str(), batch);
+  for (int i = 0; i < batch; i++)
+  {
+    offlineQueue.push(zone.id, telemetry.at(i));
+  }
+  telemetry.discard(batch);
+}
+
+void backlogTask()
+{
+  if (offlineQueue.isEmpty() || WiFi.status() != WL_CONNECTED)
+  {
+    return;
+  }
+
+  // One bounded batch per run so the control tasks keep their cadence
+  ZoneSample samples[BACKLOG_BATCH_SIZE];
+  String queuedZone;
+  int n = offlineQueue.peek(samples, BACKLOG_BATCH_SIZE, queuedZone);
+  if (n == 0)
+  {
+    return;
+  }
+
+  BatchResult result = restClient.sendZoneSensorBatch(queuedZone, samples, n, USER_ID);
+  int handled = result.sent + result.rejected;
+  if (handled > 0)
+  {
+    offlineQueue.pop(handled);
+    Serial.printf("Replayed %d queued samples (%d rejected), %lu left\n", result.sent, result.rejected,
+                  (unsigned long)offlineQueue.size());
+  }
+}
+
+// Adopts the plant sets fetched by the network task
+void takePlantUpdates()
+{
+  PlantUpdate update;
+  while (plantUpdates.pop(update))
+  {
+    Zone *zone = zones[update.zone];
+    zone->plants.swap(*update.plants);
+    delete update.plants;
+    zone->applyPlants();
+  }
+}
+
+void rulesTask()
+{
+  takePlantUpdates();
+  for (Zone *zone : zones)
+  {
+    zone->control();
+  }
+}
+
+void pumpTask()
+{
+  for (Zone *zone : zones)
+  {
+    if (zone->updatePump())
     {
-      Serial.println("[CHECK] Moisture OK now. Turning pump OFF.");
-      actuator.setPump(false, true);
+      zone->pump.printReport();
+      savePumpGain(*zone);
     }
-  } else if (sensor->shouldWater(plants)) 
+  }
+}
+
+// The learned zone response survives reboots
+void loadPumpGain(Zone &zone)
+{
+  Preferences prefs;
+  if (prefs.begin("pump", true))
   {
-    Serial.println("[PUMP] Watering needed → ON");
-    actuator.setPump(true, true);
-    // Keep checking every 5 seconds (adjust if needed)
-    int i = 0;
-    while (sensor->shouldWater(plants) && i < 3) 
+    zone.pump.setGain(prefs.getFloat(zone.id.c_str(), PUMP_CONFIG.initialGain));
+    prefs.end();
+  }
+}
+
+void savePumpGain(Zone &zone)
+{
+  Preferences prefs;
+  if (prefs.begin("pump", false))
+  {
+    prefs.putFloat(zone.id.c_str(), zone.pump.getGain());
+    prefs.end();
+  }
+}
+
+void configTask()
+{
+  for (Zone *zone : zones)
+  {
+    // The control task takes ownership of the new set and frees it
+    PlantUpdate update = {zone->index, new std::vector<PlantData>()};
+    if (!refreshPlants(*zone, *update.plants) || !plantUpdates.push(update))
     {
-      Serial.println("[PUMP] Still dry... continuing watering");
-      delay(5000);  // Wait 5s before rechecking moisture
-      i = i + 1;
+      delete update.plants;
     }
+  }
+}
 
-    // Moisture OK now — stop pump
-    Serial.println("[PUMP] Moisture OK → STOP WATERING");
-    actuator.setPump(false, true);
-  } else 
+void statsTask()
+{
+  // max late ms of these tasks is the control loop jitter
+  scheduler.printStats();
+  for (Zone *zone : zones)
   {
-    Serial.println("[PUMP] Moisture OK → OFF");
-    actuator.setPump(false, true);
+    Serial.printf("[ZONE] %s\n", zone->id.c_str());
+    zone->sensor->printFilterStats();
+    zone->actuator.printCommandStats();
+    zone->rules.printStats();
   }
+  Serial.printf("[QUEUE] dropped samples: %lu, feedback: %lu (queue full), %lu (unsendable)\n",
+                (unsigned long)sampleQueue.getDropped(), (unsigned long)feedbackQueue.getDropped(),
+                (unsigned long)feedbackDropped);
+}
 
-  delay(30000);  // Wait 30s before next loop
-}
\ No newline at end of file
+void networkStatsTask()
+{
+  networkScheduler.printStats();
+  restClient.printConnectionStats();
+  mqttConnection.printStats();
+  ClockService::printStats();
+  for (Zone *zone : zones)
+  {
+    if (TELEMETRY_OVER_MQTT || TELEMETRY_DELTAS)
+    {
+      Serial.printf("[ZONE] %s\n", zone->id.c_str());
+    }
+    if (TELEMETRY_OVER_MQTT)
+    {
+      zone->mqttTelemetry.printStats();
+    }
+    if (TELEMETRY_DELTAS)
+    {
+      zone->deltaReporter.printStats();
+    }
+  }
+#if PROFILING
+  Profiler::printStats();
+#endif
+  Serial.printf("[QUEUE] dropped commands: %lu, plant updates: %lu\n",
+                (unsigned long)commandQueue.getDropped(), (unsigned long)plantUpdates.getDropped());
+  Serial.printf("[LOG] dropped records: %lu, pending bytes: %u\n",
+                (unsigned long)Logger::getDropped(), (unsigned)Logger::getPending());
+}
+
+void loop() 
+{
+  scheduler.tick();
+}
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Offline decoder for the binary log ring of the G6 node (Log.h).
+
+Logger::dumpRaw() prints the undrained records as one "LOGDUMP <hex>"
+line. Each record holds the address of its format string instead of the
+text, so the firmware ELF the node was running is needed to turn the
+records back into messages:
+
+    python3 decode_log.py firmware.elf serial_capture.txt
+    python3 decode_log.py firmware.elf --hex 2b03ef0300...
+
+Standard library only. The record layout must match Log.cpp (ESP32,
+32-bit little-endian addresses).
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+RECORD_HEADER = 10
+LEVELS = "?EWID"
+SPEC = re.compile(r"%([-+ #0-9.]*)[hlzjtL]*([a-zA-Z%])")
+
+
+class Firmware:
+    """Read-only view of the loaded sections of an ELF32 image."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1:
+            raise ValueError(f"{path}: not an ELF32 file")
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_, kind, flags, addr, offset, size) = struct.unpack_from("<IIIIII", data, shoff + i * shentsize)
+            SHT_PROGBITS, SHF_ALLOC = 1, 2
+            if kind == SHT_PROGBITS and flags & SHF_ALLOC and addr:
+                self.sections.append((addr, data[offset:offset + size]))
+
+    def string(self, address):
+        for base, content in self.sections:
+            if base <= address < base + len(content):
+                start = address - base
+                end = content.find(b"\0", start)
+                return content[start:end if end >= 0 else len(content)].decode("utf-8", "replace")
+        return None
+
+
+def parse_args(body):
+    args = []
+    i = 0
+    while i < len(body):
+        tag = chr(body[i])
+        if tag == "s":
+            size = body[i + 1]
+            args.append(body[i + 2:i + 2 + size].decode("utf-8", "replace"))
+            i += 2 + size
+        elif tag in "iuf":
+            code = {"i": "<i", "u": "<I", "f": "<f"}[tag]
+            args.append(struct.unpack_from(code, body, i + 1)[0])
+            i += 5
+        else:
+            raise ValueError(f"unknown argument tag {body[i]:#x}")
+    return args
+
+
+def render(fmt, args):
+    """printf with the same rules as Logger::format: length modifiers dropped, missing args as '?'."""
+    args = list(args)
+
+    def substitute(match):
+        flags, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        if not args:
+            return "?"
+        value = args.pop(0)
+        if conversion == "s":
+            return ("%" + flags + "s") % (value,)
+        if conversion in "fFeEgG":
+            return ("%" + flags + conversion) % float(value)
+        if conversion == "c":
+            return chr(int(value))
+        if conversion in "di":
+            return ("%" + flags + "d") % int(value)
+        return ("%" + flags + (conversion if conversion in "uxXo" else "u")) % (int(value) & 0xFFFFFFFF)
+
+    return SPEC.sub(substitute, fmt)
+
+
+def decode(raw, firmware):
+    i = 0
+    while i < len(raw):
+        length = raw[i]
+        if length < RECORD_HEADER or i + length > len(raw):
+            print(f"damaged record at byte {i}, stopping", file=sys.stderr)
+            return
+        level = raw[i + 1]
+        at, address = struct.unpack_from("<II", raw, i + 2)
+        args = parse_args(raw[i + RECORD_HEADER:i + length])
+        fmt = firmware.string(address)
+        if fmt is None:
+            text = f"<format {address:#010x} not in firmware> {args}"
+        else:
+            text = render(fmt, args)
+        print(f"[{LEVELS[level] if level < len(LEVELS) else '?'} {at}] {text}")
+        i += length
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="firmware ELF the node was running")
+    parser.add_argument("capture", nargs="?", help="serial capture containing LOGDUMP lines (default: stdin)")
+    parser.add_argument("--hex", help="ring bytes as hex instead of a capture")
+    options = parser.parse_args()
+
+    firmware = Firmware(options.elf)
+    if options.hex:
+        dumps = [options.hex]
+    else:
+        source = open(options.capture, encoding="utf-8", errors="replace") if options.capture else sys.stdin
+        dumps = [line.split(None, 1)[1] for line in source if line.startswith("LOGDUMP ") and len(line.split()) > 1]
+    for dump in dumps:
+        decode(bytes.fromhex(dump.strip()), firmware)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+"""Reference decoder for the CBOR uplink payloads of the G6 node.
+
+Turns a sensor batch or an actuator feedback message encoded with
+PayloadSerializer (schema 1) back into the JSON the node sends when
+UPLINK_FORMAT is FORMAT_JSON, so the backend can accept both.
+
+With TELEMETRY_DELTAS the node leaves unchanged readings out of a sample
+and marks it as a delta. --reconstruct plays a series of uploads (CBOR or
+the JSON form) through DeltaState and prints every sample in full.
+
+    python3 decode_payload.py payload.cbor
+    python3 decode_payload.py --hex bf0001016...
+    python3 decode_payload.py --reconstruct upload1.cbor upload2.json ...
+
+Standard library only. Field ids must match PayloadField in PayloadSerializer.h.
+"""
+
+import argparse
+import datetime
+import json
+import struct
+import sys
+
+SCHEMA_VERSION = 1
+
+FIELD_SCHEMA = 0
+FIELD_ZONE = 1
+FIELD_USER = 2
+FIELD_SAMPLES = 3
+FIELD_TIMESTAMP = 4
+FIELD_TRANSITIONS = 5
+FIELD_DELTA = 6
+FIELD_TEMPERATURE = 10
+FIELD_HUMIDITY = 11
+FIELD_LIGHT = 12
+FIELD_AIR_QUALITY = 13
+FIELD_SOIL = 14
+
+BREAK = object()
+
+
+class CborDecoder:
+    """Decodes the subset of CBOR the node emits: integers, text, floats,
+    simple values and (indefinite or definite) arrays and maps."""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, n):
+        if self.pos + n > len(self.data):
+            raise ValueError("truncated payload")
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+    def argument(self, info):
+        if info < 24:
+            return info
+        if info == 24:
+            return self.take(1)[0]
+        if info == 25:
+            return struct.unpack(">H", self.take(2))[0]
+        if info == 26:
+            return struct.unpack(">I", self.take(4))[0]
+        if info == 27:
+            return struct.unpack(">Q", self.take(8))[0]
+        if info == 31:
+            return None
+        raise ValueError("reserved additional info %d" % info)
+
+    def items(self, count):
+        if count is not None:
+            return [self.decode() for _ in range(count)]
+        values = []
+        while True:
+            item = self.decode()
+            if item is BREAK:
+                return values
+            values.append(item)
+
+    def decode(self):
+        head = self.take(1)[0]
+        major, info = head >> 5, head & 0x1F
+
+        if major == 7:
+            if info == 20:
+                return False
+            if info == 21:
+                return True
+            if info in (22, 23):
+                return None
+            if info == 25:
+                return struct.unpack(">e", self.take(2))[0]
+            if info == 26:
+                return struct.unpack(">f", self.take(4))[0]
+            if info == 27:
+                return struct.unpack(">d", self.take(8))[0]
+            if info == 31:
+                return BREAK
+            raise ValueError("unsupported simple value %d" % info)
+
+        value = self.argument(info)
+        if major == 0:
+            return value
+        if major == 1:
+            return -1 - value
+        if major in (2, 3):
+            if value is None:
+                raise ValueError("indefinite strings are not used")
+            raw = self.take(value)
+            return raw.decode("utf-8") if major == 3 else raw
+        if major == 4:
+            return self.items(value)
+        if major == 5:
+            flat = self.items(None if value is None else value * 2)
+            return dict(zip(flat[0::2], flat[1::2]))
+        raise ValueError("unsupported major type %d" % major)
+
+
+def iso_timestamp(epoch_ms):
+    # Same text as PayloadSerializer::formatTimestamp: UTC+8, marked "Z"
+    moment = datetime.datetime.fromtimestamp(epoch_ms / 1000 + 8 * 3600, datetime.timezone.utc)
+    return moment.strftime("%Y-%m-%dT%H:%M:%SZ")
+
+
+def number(value):
+    # Missing readings travel as null; the JSON form sends 0
+    return 0.0 if value is None else round(value, 2)
+
+
+ZONE_SENSORS = (
+    ("humidity", FIELD_HUMIDITY),
+    ("temp", FIELD_TEMPERATURE),
+    ("light", FIELD_LIGHT),
+    ("airQuality", FIELD_AIR_QUALITY),
+)
+
+
+def sensor_batch(message):
+    zone = message.get(FIELD_ZONE, "")
+    user = message.get(FIELD_USER)
+    samples = []
+    for sample in message[FIELD_SAMPLES]:
+        record = {
+            "zoneId": zone,
+            # A delta only carries the readings that changed
+            "zoneSensors": {
+                name: number(sample[field]) for name, field in ZONE_SENSORS if field in sample
+            },
+            "soilMoistureByPin": [
+                {"pin": pin, "soilMoisture": number(moisture)}
+                for pin, moisture in sample.get(FIELD_SOIL, [])
+            ],
+        }
+        if user:
+            record["userId"] = user
+        if FIELD_TIMESTAMP in sample:
+            record["timestamp"] = iso_timestamp(sample[FIELD_TIMESTAMP])
+        if sample.get(FIELD_DELTA):
+            record["delta"] = True
+        samples.append(record)
+    return samples
+
+
+class DeltaState:
+    """Backend side of delta reporting: carries every reading forward from
+    the last keyframe so each sample can be stored in full. Feed the samples
+    of one zone in timestamp order (replayed backlog included)."""
+
+    def __init__(self):
+        self.sensors = None
+        self.soil = None
+
+    def apply(self, sample):
+        """Returns sample with every reading filled in, or None while no
+        keyframe has been seen yet."""
+        if not sample.get("delta"):
+            self.sensors = dict(sample["zoneSensors"])
+            self.soil = {entry["pin"]: entry["soilMoisture"] for entry in sample["soilMoistureByPin"]}
+        elif self.sensors is None:
+            return None
+        else:
+            self.sensors.update(sample["zoneSensors"])
+            for entry in sample["soilMoistureByPin"]:
+                self.soil[entry["pin"]] = entry["soilMoisture"]
+
+        full = dict(sample)
+        full.pop("delta", None)
+        full["zoneSensors"] = dict(self.sensors)
+        full["soilMoistureByPin"] = [{"pin": pin, "soilMoisture": value} for pin, value in self.soil.items()]
+        return full
+
+
+def reconstruct(uploads):
+    """Full series from a sequence of decoded sensor uploads, per zone."""
+    states = {}
+    series = []
+    for upload in uploads:
+        for sample in upload if isinstance(upload, list) else [upload]:
+            state = states.setdefault(sample.get("zoneId", ""), DeltaState())
+            full = state.apply(sample)
+            if full is not None:
+                series.append(full)
+    return series
+
+
+def actuator_feedback(message):
+    feedback = {"zone": message.get(FIELD_ZONE, "")}
+    timestamp = message.get(FIELD_TIMESTAMP)
+    if timestamp:
+        feedback["ts"] = timestamp // 1000
+    feedback["tr"] = [[action, 1 if system else 0] for action, system in message[FIELD_TRANSITIONS]]
+    return feedback
+
+
+def decode_payload(data):
+    """Returns the JSON-equivalent structure of one CBOR uplink message."""
+    message = CborDecoder(data).decode()
+    if not isinstance(message, dict):
+        raise ValueError("payload is not a map")
+    version = message.get(FIELD_SCHEMA)
+    if version != SCHEMA_VERSION:
+        raise ValueError("unsupported schema version %r" % version)
+    if FIELD_SAMPLES in message:
+        return sensor_batch(message)
+    if FIELD_TRANSITIONS in message:
+        return actuator_feedback(message)
+    raise ValueError("neither a sensor batch nor actuator feedback")
+
+
+def load_upload(path):
+    """One upload from a file: the JSON form as is, anything else as CBOR."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if path.endswith(".json"):
+        return json.loads(data)
+    return decode_payload(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("payload", nargs="+", help="file with the raw payload, or hex with --hex ('-' reads stdin)")
+    parser.add_argument("--hex", action="store_true", help="payload argument is a hex string")
+    parser.add_argument("--reconstruct", action="store_true",
+                        help="fill delta samples in from the uploads before them, in the order given")
+    args = parser.parse_args()
+
+    if args.reconstruct:
+        print(json.dumps(reconstruct(load_upload(path) for path in args.payload), indent=2))
+        return
+
+    if args.hex:
+        data = bytes.fromhex(args.payload[0])
+    elif args.payload[0] == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.payload[0], "rb") as f:
+            data = f.read()
+
+    print(json.dumps(decode_payload(data), indent=2))
+
+
+if __name__ == "__main__":
+    main()
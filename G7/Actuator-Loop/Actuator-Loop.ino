@@ -31,6 +31,13 @@ Adafruit_MQTT_Subscribe subscribeFeed = Adafruit_MQTT_Subscribe(&mqtt, MQTT_USER
 // Actuator module with LED and Fan pins, and MQTT feed references
 ActuatorModule actuator(LED_PIN, FAN_PIN, &publishFeed, &feedbackFeed, &subscribeFeed);
 
+// Broker connection, reconnected with backoff from loop()
+MqttModule mqttConnection(mqtt);
+
+// How often the actuator outputs are refreshed
+const unsigned long CONTROL_INTERVAL_MS = 10000;
+unsigned long lastControlAt = 0;
+
 // Connect to WiFi with retry logic
 void connectToWifi() {
   Serial.print("Connecting to WiFi");
@@ -57,18 +64,22 @@ void setup() {
 }
 
 void loop() {
-  
-  MqttModule::connectToMqtt(mqtt); // Connect to Adafruit IO MQTT
-
-  // Listen for MQTT messages
-  Adafruit_MQTT_Subscribe *subscription;
-  while ((subscription = mqtt.readSubscription(500))) {
-    actuator.callback(subscription); // Handle MQTT message
+  // At most one connect attempt per pass, then back to the actuators
+  if (mqttConnection.update()) {
+    // Listen for MQTT messages
+    Adafruit_MQTT_Subscribe *subscription;
+    while ((subscription = mqtt.readSubscription(100))) {
+      actuator.callback(subscription); // Handle MQTT message
+    }
+  } else {
+    delay(100); // Idle while offline; the backoff paces the reconnects
   }
 
   // Regularly update actuator states (if they are automatic or sensor-based)
-  actuator.setFan();
-  actuator.setLight();
-
-  delay(10000); // Delay between each loop iteration
+  unsigned long now = millis();
+  if (now - lastControlAt >= CONTROL_INTERVAL_MS) {
+    lastControlAt = now;
+    actuator.setFan();
+    actuator.setLight();
+  }
 }
\ No newline at end of file